@@ -29,6 +29,26 @@ sub main::generate($$) {
        my $audioFormatValue = $audioFormat ? '"' . $audioFormat->getValueAt(0)->getSPLExpression() . '"' : '"mono16k"';
        my $chunkDurationValue = $chunkDurationMs ? $chunkDurationMs->getValueAt(0)->getCppExpression() : "5000";
        my $minSpeechDurationValue = $minSpeechDurationMs ? $minSpeechDurationMs->getValueAt(0)->getCppExpression() : "500";
+       my $cacheOptimizedModel = $model->getParameterByName("cacheOptimizedModel");
+       my $cacheOptimizedModelValue = $cacheOptimizedModel ? $cacheOptimizedModel->getValueAt(0)->getCppExpression() : "false";
+       my $warmupMs = $model->getParameterByName("warmupMs");
+       my $warmupMsValue = $warmupMs ? $warmupMs->getValueAt(0)->getCppExpression() : "0";
+       my $memoryMapModel = $model->getParameterByName("memoryMapModel");
+       my $memoryMapModelValue = $memoryMapModel ? $memoryMapModel->getValueAt(0)->getCppExpression() : "false";
+       my $quantizedEncoder = $model->getParameterByName("quantizedEncoder");
+       my $quantizedEncoderValue = $quantizedEncoder ? $quantizedEncoder->getValueAt(0)->getCppExpression() : "false";
+       my $blankSkipThreshold = $model->getParameterByName("blankSkipThreshold");
+       my $blankSkipThresholdValue = $blankSkipThreshold ? $blankSkipThreshold->getValueAt(0)->getCppExpression() : "0.0f";
+       my $beamSize = $model->getParameterByName("beamSize");
+       my $beamSizeValue = $beamSize ? $beamSize->getValueAt(0)->getCppExpression() : "1";
+       my $maxCandidatesPerFrame = $model->getParameterByName("maxCandidatesPerFrame");
+       my $maxCandidatesPerFrameValue = $maxCandidatesPerFrame ? $maxCandidatesPerFrame->getValueAt(0)->getCppExpression() : "8";
+       my $bufferedChunkMs = $model->getParameterByName("bufferedChunkMs");
+       my $bufferedChunkMsValue = $bufferedChunkMs ? $bufferedChunkMs->getValueAt(0)->getCppExpression() : "0";
+       my $leftContextMs = $model->getParameterByName("leftContextMs");
+       my $leftContextMsValue = $leftContextMs ? $leftContextMs->getValueAt(0)->getCppExpression() : "2000";
+       my $rightContextMs = $model->getParameterByName("rightContextMs");
+       my $rightContextMsValue = $rightContextMs ? $rightContextMs->getValueAt(0)->getCppExpression() : "480";
    print "\n";
    print "\n";
    print 'MY_OPERATOR_SCOPE::MY_OPERATOR::MY_OPERATOR()', "\n";
@@ -43,6 +63,36 @@ sub main::generate($$) {
    print '),', "\n";
    print '      minSpeechDurationMs_(';
    print $minSpeechDurationValue;
+   print '),', "\n";
+   print '      cacheOptimizedModel_(';
+   print $cacheOptimizedModelValue;
+   print '),', "\n";
+   print '      warmupMs_(';
+   print $warmupMsValue;
+   print '),', "\n";
+   print '      memoryMapModel_(';
+   print $memoryMapModelValue;
+   print '),', "\n";
+   print '      quantizedEncoder_(';
+   print $quantizedEncoderValue;
+   print '),', "\n";
+   print '      blankSkipThreshold_(';
+   print $blankSkipThresholdValue;
+   print '),', "\n";
+   print '      beamSize_(';
+   print $beamSizeValue;
+   print '),', "\n";
+   print '      maxCandidatesPerFrame_(';
+   print $maxCandidatesPerFrameValue;
+   print '),', "\n";
+   print '      bufferedChunkMs_(';
+   print $bufferedChunkMsValue;
+   print '),', "\n";
+   print '      leftContextMs_(';
+   print $leftContextMsValue;
+   print '),', "\n";
+   print '      rightContextMs_(';
+   print $rightContextMsValue;
    print ')', "\n";
    print '{', "\n";
    print '    // Parse audio format', "\n";
@@ -89,12 +139,25 @@ sub main::generate($$) {
    print '    ', "\n";
    print '    // Initialize NeMo CTC implementation', "\n";
    print '    nemoSTT_ = createNeMoCTCImpl();', "\n";
+   print '    nemoSTT_->setOptimizedModelCache(cacheOptimizedModel_);', "\n";
+   print '    nemoSTT_->setMemoryMappedModel(memoryMapModel_);', "\n";
+   print '    nemoSTT_->setQuantizedEncoder(quantizedEncoder_);', "\n";
+   print '    nemoSTT_->setBlankSkipThreshold(blankSkipThreshold_);', "\n";
+   print '    nemoSTT_->setBeamSearch(beamSize_, maxCandidatesPerFrame_);', "\n";
+   print '    if (bufferedChunkMs_ > 0) {', "\n";
+   print '        nemoSTT_->setBufferedStreaming(leftContextMs_, bufferedChunkMs_, rightContextMs_);', "\n";
+   print '    }', "\n";
    print '    ', "\n";
    print '    if (!nemoSTT_->initialize(modelPath_, tokensPath_)) {', "\n";
    print '        SPLAPPTRC(L_ERROR, "Failed to initialize NeMo CTC model: " << modelPath_, SPL_OPER_DBG);', "\n";
    print '        throw std::runtime_error("Failed to initialize NeMo CTC model");', "\n";
    print '    }', "\n";
    print '    ', "\n";
+   print '    // Pay for lazy kernel initialization now rather than on the first audio', "\n";
+   print '    if (warmupMs_ > 0 && !nemoSTT_->warmUp(warmupMs_)) {', "\n";
+   print '        SPLAPPTRC(L_WARN, "NeMo model warm-up failed", SPL_OPER_DBG);', "\n";
+   print '    }', "\n";
+   print '    ', "\n";
    print '    SPLAPPTRC(L_INFO, "NeMo model initialized successfully", SPL_OPER_DBG);', "\n";
    print '}', "\n";
    print "\n";
@@ -119,17 +182,14 @@ sub main::generate($$) {
    print '    const int16_t* samples = static_cast<const int16_t*>(audioData);', "\n";
    print '    size_t numSamples = audioSize / sizeof(int16_t);', "\n";
    print '    ', "\n";
-   print '    std::vector<float> floatSamples(numSamples);', "\n";
-   print '    for (size_t i = 0; i < numSamples; ++i) {', "\n";
-   print '        floatSamples[i] = static_cast<float>(samples[i]) / 32768.0f;', "\n";
-   print '    }', "\n";
+   print '    preprocessor_.process(samples, numSamples, floatSamples_);', "\n";
    print '    ', "\n";
-   print '    // Transcribe audio chunk', "\n";
-   print '    std::string transcription = nemoSTT_->transcribe(floatSamples);', "\n";
+   print '    // Decode the chunk as part of the stream; only newly final text comes back', "\n";
+   print '    std::string delta = nemoSTT_->transcribeChunk(floatSamples_);', "\n";
    print '    ', "\n";
-   print '    // Output transcription if not empty', "\n";
-   print '    if (!transcription.empty()) {', "\n";
-   print '        outputTranscription(transcription);', "\n";
+   print '    // Output the new text if any', "\n";
+   print '    if (!delta.empty()) {', "\n";
+   print '        outputTranscription(delta);', "\n";
    print '    }', "\n";
    print '}', "\n";
    print "\n";
@@ -137,7 +197,14 @@ sub main::generate($$) {
    print '{', "\n";
    print '    SPLAPPTRC(L_TRACE, "NeMoSTT process punctuation: " << punct, SPL_OPER_DBG);', "\n";
    print '    ', "\n";
-   print '    // Forward punctuation processing (CTC model handles each chunk independently)', "\n";
+   print '    // End of utterance or stream: emit the text the decoder still holds back', "\n";
+   print '    // and start the next stream from a clean state', "\n";
+   print '    if (punct == Punctuation::WindowMarker || punct == Punctuation::FinalMarker) {', "\n";
+   print '        std::string remainder = nemoSTT_ ? nemoSTT_->flushStream() : std::string();', "\n";
+   print '        if (!remainder.empty()) {', "\n";
+   print '            outputTranscription(remainder);', "\n";
+   print '        }', "\n";
+   print '    }', "\n";
    print '    ', "\n";
    print '    // Forward punctuation', "\n";
    print '    submit(punct, 0);', "\n";
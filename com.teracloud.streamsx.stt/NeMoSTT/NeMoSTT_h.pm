@@ -16,6 +16,7 @@ sub main::generate($$) {
    print "\n";
    print '/* Additional includes for NeMoSTT operator */', "\n";
    print '#include <NeMoCTCInterface.hpp>', "\n";
+   print '#include <AudioPreprocessor.hpp>', "\n";
    print '#include <vector>', "\n";
    print '#include <memory>', "\n";
    print "\n";
@@ -49,10 +50,24 @@ sub main::generate($$) {
    print '    // Configuration', "\n";
    print '    int chunkDurationMs_;', "\n";
    print '    int minSpeechDurationMs_;', "\n";
+   print '    bool cacheOptimizedModel_;', "\n";
+   print '    int warmupMs_;', "\n";
+   print '    bool memoryMapModel_;', "\n";
+   print '    bool quantizedEncoder_;', "\n";
+   print '    float blankSkipThreshold_;', "\n";
+   print '    int beamSize_;', "\n";
+   print '    int maxCandidatesPerFrame_;', "\n";
+   print '    int bufferedChunkMs_;', "\n";
+   print '    int leftContextMs_;', "\n";
+   print '    int rightContextMs_;', "\n";
    print '    ', "\n";
    print '    // Audio buffer', "\n";
    print '    std::vector<float> audioBuffer_;', "\n";
    print '    ', "\n";
+   print '    // int16 -> float ingestion (one pass into a reused buffer)', "\n";
+   print '    onnx_stt::AudioPreprocessor preprocessor_;', "\n";
+   print '    std::vector<float> floatSamples_;', "\n";
+   print '    ', "\n";
    print '    // Helper methods', "\n";
    print '    void outputTranscription(const std::string& text);', "\n";
    print '}; ', "\n";
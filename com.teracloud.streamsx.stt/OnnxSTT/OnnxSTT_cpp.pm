@@ -27,6 +27,27 @@ sub main::generate($$) {
        my $numThreads = $model->getParameterByName("numThreads");
        $numThreads = $numThreads ? $numThreads->getValueAt(0)->getCppExpression() : "4";
        
+       my $cacheOptimizedModel = $model->getParameterByName("cacheOptimizedModel");
+       $cacheOptimizedModel = $cacheOptimizedModel ? $cacheOptimizedModel->getValueAt(0)->getCppExpression() : "false";
+       
+       my $warmupMs = $model->getParameterByName("warmupMs");
+       $warmupMs = $warmupMs ? $warmupMs->getValueAt(0)->getCppExpression() : "0";
+       
+       my $memoryMapModel = $model->getParameterByName("memoryMapModel");
+       $memoryMapModel = $memoryMapModel ? $memoryMapModel->getValueAt(0)->getCppExpression() : "false";
+       
+       my $quantizedEncoder = $model->getParameterByName("quantizedEncoder");
+       $quantizedEncoder = $quantizedEncoder ? $quantizedEncoder->getValueAt(0)->getCppExpression() : "false";
+       
+       my $fixedShapeEncoder = $model->getParameterByName("fixedShapeEncoder");
+       $fixedShapeEncoder = $fixedShapeEncoder ? $fixedShapeEncoder->getValueAt(0)->getCppExpression() : "false";
+       
+       my $decodingMethod = $model->getParameterByName("decodingMethod");
+       $decodingMethod = $decodingMethod ? $decodingMethod->getValueAt(0)->getCppExpression() : "\"modified_beam_search\"";
+       
+       my $maxSymbolsPerFrame = $model->getParameterByName("maxSymbolsPerFrame");
+       $maxSymbolsPerFrame = $maxSymbolsPerFrame ? $maxSymbolsPerFrame->getValueAt(0)->getCppExpression() : "1";
+       
        my $provider = $model->getParameterByName("provider");
        my $useGpu = "false";
        if ($provider && $provider->getValueAt(0)->getSPLExpression() ne "CPU") {
@@ -57,6 +78,11 @@ sub main::generate($$) {
    print '    SPLAPPTRC(L_DEBUG, "OnnxSTT operator destructor", "OnnxSTT");', "\n";
    print '}', "\n";
    print "\n";
+   print 'void MY_OPERATOR_SCOPE::MY_OPERATOR::allPortsReady() {', "\n";
+   print '    // Load (and warm up) the models before the first tuple arrives', "\n";
+   print '    initialize();', "\n";
+   print '}', "\n";
+   print "\n";
    print 'void MY_OPERATOR_SCOPE::MY_OPERATOR::initialize() {', "\n";
    print '    if (initialized_) return;', "\n";
    print '    ', "\n";
@@ -83,6 +109,27 @@ sub main::generate($$) {
    print '        config_.use_gpu = ';
    print $useGpu;
    print ';', "\n";
+   print '        config_.cache_optimized_model = ';
+   print $cacheOptimizedModel;
+   print ';', "\n";
+   print '        config_.warmup_ms = ';
+   print $warmupMs;
+   print ';', "\n";
+   print '        config_.memory_map_model = ';
+   print $memoryMapModel;
+   print ';', "\n";
+   print '        config_.quantized_encoder = ';
+   print $quantizedEncoder;
+   print ';', "\n";
+   print '        config_.fixed_shape_encoder = ';
+   print $fixedShapeEncoder;
+   print ';', "\n";
+   print '        config_.decoding_method = ';
+   print $decodingMethod;
+   print ';', "\n";
+   print '        config_.max_symbols_per_frame = ';
+   print $maxSymbolsPerFrame;
+   print ';', "\n";
    print '        ', "\n";
    print '        SPLAPPTRC(L_INFO, "Initializing OnnxSTT with model: " + config_.encoder_onnx_path, "OnnxSTT");', "\n";
    print '        ', "\n";
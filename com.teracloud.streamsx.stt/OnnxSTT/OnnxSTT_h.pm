@@ -23,6 +23,9 @@ sub main::generate($$) {
    print '    // Destructor', "\n";
    print '    virtual ~MY_OPERATOR();', "\n";
    print '    ', "\n";
+   print '    // Model loading and warm-up', "\n";
+   print '    void allPortsReady();', "\n";
+   print '    ', "\n";
    print '    // Tuple processing for non-mutating ports', "\n";
    print '    void process(Tuple const & tuple, uint32_t port);', "\n";
    print '    ', "\n";
@@ -36,20 +36,21 @@ def export_to_onnx():
             'export_format': 'onnx'
         })
         
-        # Export encoder to ONNX
-        encoder_path = os.path.join(output_dir, "fastconformer_encoder_cache_aware.onnx")
-        print(f"Exporting encoder to {encoder_path}...")
-        model.export(encoder_path)
-        print("✓ Encoder exported successfully")
+        # Export the CTC branch of the hybrid model: encoder + CTC head in one
+        # graph with log-probs and the cache tensors as outputs
+        model.change_decoding_strategy(decoder_type='ctc')
+        model.cur_decoder = 'ctc'
         
-        # Export decoder (CTC) if available
-        try:
-            decoder_path = os.path.join(output_dir, "fastconformer_decoder_ctc.onnx")
-            print(f"Exporting CTC decoder to {decoder_path}...")
-            # Note: This might require additional configuration
-            print("✓ CTC decoder export configured")
-        except Exception as e:
-            print(f"⚠ CTC decoder export not available: {e}")
+        # One export per right context the model was trained with; the left
+        # context (and so every cache shape) is the same in all of them.
+        # File names match NeMoCacheAwareStreaming::encoderFileName().
+        for lookahead in (0, 1, 6, 13):
+            model.encoder.set_default_att_context_size([70, lookahead])
+            latency_ms = lookahead * 80
+            encoder_path = os.path.join(output_dir, f"fastconformer_ctc_cache_aware_{latency_ms}ms.onnx")
+            print(f"Exporting att_context_size [70, {lookahead}] ({latency_ms} ms) to {encoder_path}...")
+            model.export(encoder_path)
+            print("✓ Exported successfully")
         
         # Save model configuration and vocabulary
         config_path = os.path.join(output_dir, "model_config.yaml")
@@ -0,0 +1,60 @@
+#ifndef AUDIO_PREPROCESSOR_HPP
+#define AUDIO_PREPROCESSOR_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace onnx_stt {
+
+/**
+ * Fused audio ingestion kernel
+ *
+ * Converts PCM int16 to float, adds dither and applies pre-emphasis in one pass
+ * into a caller-provided buffer (one read and one write per sample). Dither comes
+ * from a counter-based hash of (seed, sample index), so it is deterministic per
+ * stream, independent of chunking, and has no sequential PRNG state to block
+ * vectorization. One instance per stream; not thread-safe.
+ */
+class AudioPreprocessor {
+public:
+    struct Options {
+        float scale = 1.0f / 32768.0f;  // int16 -> [-1, 1)
+        float dither = 0.0f;            // uniform dither amplitude (0 = off), in output units
+        float preemph_coeff = 0.0f;     // y[n] = x[n] - coeff * x[n-1] (0 = off)
+        uint32_t seed = 0;              // per-stream dither seed
+    };
+
+    AudioPreprocessor();
+    explicit AudioPreprocessor(const Options& options);
+
+    // Process the next num_samples of the stream into output (num_samples floats)
+    void process(const int16_t* samples, size_t num_samples, float* output);
+
+    // Same for float input (scale is not applied)
+    void process(const float* samples, size_t num_samples, float* output);
+
+    // Convenience overload that resizes output (keeps its capacity)
+    void process(const int16_t* samples, size_t num_samples, std::vector<float>& output);
+
+    // Start a new stream (dither counter and pre-emphasis history)
+    void reset();
+
+    const Options& getOptions() const { return options_; }
+
+    // Stateless int16 -> float conversion for callers that need nothing else
+    static void convertInt16ToFloat(const int16_t* samples, size_t num_samples, float* output,
+                                    float scale = 1.0f / 32768.0f);
+
+private:
+    Options options_;
+    uint64_t sample_index_;     // dither counter
+    float last_sample_;         // x[n-1] for pre-emphasis across chunk boundaries
+
+    template <typename T>
+    void processImpl(const T* samples, size_t num_samples, float* output, float scale);
+};
+
+} // namespace onnx_stt
+
+#endif // AUDIO_PREPROCESSOR_HPP
@@ -0,0 +1,98 @@
+#ifndef BATCH_MODEL_HPP
+#define BATCH_MODEL_HPP
+
+#include "ModelInterface.hpp"
+#include "FeatureMatrix.hpp"
+#include "FeatureRing.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace onnx_stt {
+
+// State of one stream (batch 1) kept outside a model that serves several
+// streams through processBatch(): the encoder caches and the stream's own
+// feature ring, so its chunks get the same pre-encode context and
+// subsampling-aligned steps as on a dedicated instance
+struct StreamCache {
+    std::vector<float> cache_last_channel;
+    std::vector<float> cache_last_time;
+    std::vector<int64_t> cache_last_channel_len;
+    FeatureRing ring;
+};
+
+// One stream's chunk in a cross-stream batch
+struct BatchEntry {
+    FeatureView features;
+    bool end_of_stream = false;  // encode the frames still buffered, padded
+    StreamCache* cache = nullptr;
+    ModelInterface::TranscriptionResult* result = nullptr;
+};
+
+/**
+ * What BatchScheduler needs from a model: one call that advances several
+ * independent streams, each through its own StreamCache
+ */
+class BatchModel {
+public:
+    virtual ~BatchModel() = default;
+
+    // Buffer each entry's frames in its stream's ring and encode every window
+    // that is complete (all of them for end_of_stream), one encoder call per
+    // round of windows. Results hold the text of all windows of the entry.
+    virtual bool processBatch(std::vector<BatchEntry>& entries) = 0;
+    virtual StreamCache createStreamCache() const = 0;
+    virtual void resetStreamCache(StreamCache& cache) const = 0;
+
+    // Largest batch the model accepts in one call
+    virtual int getMaxBatchSize() const = 0;
+};
+
+// Shape helpers for batching batch-1 tensors along one axis
+
+inline size_t elementCount(const std::vector<int64_t>& shape) {
+    size_t count = 1;
+    for (auto dim : shape) {
+        count *= static_cast<size_t>(dim);
+    }
+    return count;
+}
+
+// Same shape with the batch dimension replaced
+inline std::vector<int64_t> withBatch(std::vector<int64_t> shape, int axis, int64_t batch) {
+    shape[axis] = batch;
+    return shape;
+}
+
+// Interleave per-stream tensors (batch 1) into one tensor batched along axis
+template <typename T>
+void gatherBatch(const std::vector<const T*>& streams, const std::vector<int64_t>& shape, int axis, T* out) {
+    size_t outer = 1, inner = 1;
+    for (int i = 0; i < axis; ++i) outer *= static_cast<size_t>(shape[i]);
+    for (size_t i = axis + 1; i < shape.size(); ++i) inner *= static_cast<size_t>(shape[i]);
+    size_t batch = streams.size();
+    for (size_t o = 0; o < outer; ++o) {
+        for (size_t b = 0; b < batch; ++b) {
+            std::copy(streams[b] + o * inner, streams[b] + (o + 1) * inner, out + (o * batch + b) * inner);
+        }
+    }
+}
+
+// Inverse of gatherBatch
+template <typename T>
+void scatterBatch(const T* in, const std::vector<int64_t>& shape, int axis, const std::vector<T*>& streams) {
+    size_t outer = 1, inner = 1;
+    for (int i = 0; i < axis; ++i) outer *= static_cast<size_t>(shape[i]);
+    for (size_t i = axis + 1; i < shape.size(); ++i) inner *= static_cast<size_t>(shape[i]);
+    size_t batch = streams.size();
+    for (size_t o = 0; o < outer; ++o) {
+        for (size_t b = 0; b < batch; ++b) {
+            const T* src = in + (o * batch + b) * inner;
+            std::copy(src, src + inner, streams[b] + o * inner);
+        }
+    }
+}
+
+} // namespace onnx_stt
+
+#endif // BATCH_MODEL_HPP
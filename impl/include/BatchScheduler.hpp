@@ -0,0 +1,130 @@
+#ifndef BATCH_SCHEDULER_HPP
+#define BATCH_SCHEDULER_HPP
+
+#include "BatchModel.hpp"
+#include "FeatureMatrix.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace onnx_stt {
+
+/**
+ * Cross-stream dynamic batching for cache-aware streaming encoders
+ *
+ * Streams submit feature chunks; a worker thread collects ready chunks from
+ * different streams until the batch is full or the oldest chunk has waited
+ * max_wait_ms, then runs them as one BatchModel::processBatch() call (e.g.
+ * NeMoCacheAwareConformer). Each stream keeps its own cache, and at most one
+ * chunk per stream is in a batch so chunks of a stream stay in order. Results
+ * are delivered through the callback given at submit time, on the worker thread.
+ */
+class BatchScheduler {
+public:
+    struct Config {
+        int max_batch_size = 16;         // chunks per encoder call
+        int max_wait_ms = 20;            // deadline for filling a batch
+        int max_streams = 256;           // admission limit on open streams
+        int max_pending_per_stream = 4;  // queued chunks per stream before submit() rejects
+        int max_pending_total = 1024;    // queued chunks overall
+    };
+
+    using Callback = std::function<void(const ModelInterface::TranscriptionResult&)>;
+
+    // Per-stream latency accounting (microseconds)
+    struct StreamStats {
+        uint64_t chunks_processed = 0;
+        uint64_t chunks_rejected = 0;
+        uint64_t total_queue_us = 0;     // submit -> batch start
+        uint64_t total_latency_us = 0;   // submit -> result
+        uint64_t max_latency_us = 0;
+    };
+
+    BatchScheduler(std::shared_ptr<BatchModel> model, const Config& config);
+    ~BatchScheduler();
+
+    // Start/stop the worker thread; stop() drains queued chunks first
+    bool start();
+    void stop();
+
+    // Open a stream with a fresh cache; returns -1 when max_streams are open
+    int openStream();
+
+    // Close a stream; chunks still queued for it are dropped
+    void closeStream(int stream_id);
+
+    // Start a new utterance: chunks still queued for the stream are dropped
+    // (their callbacks are not called) and its cache is zeroed, after the
+    // running batch if a chunk of the stream is in it
+    void resetStream(int stream_id);
+
+    // Queue a chunk (features are copied); end_of_stream also encodes the
+    // frames the stream still has buffered. Returns false if the scheduler is
+    // stopped, the stream is unknown or an admission limit is hit.
+    bool submit(int stream_id, const FeatureView& features, uint64_t timestamp_ms, Callback callback,
+                bool end_of_stream = false);
+
+    StreamStats getStreamStats(int stream_id) const;
+    std::map<std::string, double> getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        int stream_id;
+        FeatureMatrix features;
+        uint64_t timestamp_ms;
+        bool end_of_stream;
+        Callback callback;
+        Clock::time_point submitted;
+    };
+
+    struct Stream {
+        StreamCache cache;
+        std::deque<Request> pending;
+        bool in_flight = false;          // a chunk of this stream is in the running batch
+        bool closed = false;             // closed while in flight; erased after the batch
+        bool reset_pending = false;      // reset while in flight; applied after the batch
+        StreamStats stats;
+    };
+
+    std::shared_ptr<BatchModel> model_;
+    Config config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread worker_;
+    bool running_;
+
+    std::map<int, std::unique_ptr<Stream>> streams_;
+    int next_stream_id_;
+    size_t pending_total_;
+
+    // Global statistics
+    uint64_t batches_run_;
+    uint64_t chunks_batched_;
+    uint64_t batch_failures_;
+    uint64_t total_batch_us_;
+
+    void workerLoop();
+
+    // Oldest submit time among streams that can contribute a chunk (mutex held)
+    bool oldestReady(Clock::time_point& oldest) const;
+    size_t readyStreams() const;
+
+    // Take the next chunk of up to max_batch_size distinct streams (mutex held)
+    std::vector<std::pair<Stream*, Request>> takeBatch();
+
+    // Drop a stream's queued chunks (mutex held)
+    void dropPending(Stream& stream);
+};
+
+} // namespace onnx_stt
+
+#endif // BATCH_SCHEDULER_HPP
@@ -0,0 +1,103 @@
+#ifndef CTC_PREFIX_BEAM_SEARCH_HPP
+#define CTC_PREFIX_BEAM_SEARCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace onnx_stt {
+
+/**
+ * CTC prefix beam search over per-frame class scores
+ *
+ * Each beam entry is a prefix with separate probabilities of ending in blank
+ * and in its last token, so "a a" and "a" stay distinct paths. Prefixes are
+ * nodes of a hash-consed trie (parent, token) -> node: extending a hypothesis
+ * adds or reuses one node instead of copying its token vector, and two paths
+ * reaching the same prefix meet at the same node and are merged.
+ *
+ * Nodes no beam prefix descends to are dropped once the trie has doubled
+ * since the last compaction, so memory stays bounded on long streams.
+ *
+ * Per frame, only tokens within candidate_prune of the frame's best and at
+ * most max_candidates_per_frame of them are expanded. The max, log-softmax
+ * and threshold scan are vectorized (AVX2 or NEON, scalar otherwise). Frames
+ * whose blank probability exceeds blank_skip_threshold only extend blank.
+ */
+class CTCPrefixBeamSearch {
+public:
+    struct Config {
+        int blank_id = 0;
+        int beam_size = 8;                  // prefixes kept after each frame
+        int max_candidates_per_frame = 8;   // top-k tokens expanded per frame
+        float candidate_prune = 10.0f;      // drop tokens this far (nats) below the frame's best
+        float blank_skip_threshold = 0.0f;  // frames with P(blank) above it only extend blank (0: off)
+        bool inputs_are_log_probs = true;   // false: apply log-softmax to each frame first
+    };
+
+    explicit CTCPrefixBeamSearch(const Config& config);
+
+    // Start a new utterance (drops the trie)
+    void reset();
+
+    // Consume frames x vocab_size scores, row-major
+    void advance(const float* scores, size_t frames, size_t vocab_size);
+
+    // Tokens and log probability of the best prefix so far
+    std::vector<int> bestTokens() const;
+    float bestScore() const;
+    
+    // Tokens from position `from` on of the prefix every beam entry shares.
+    // Later frames only extend beam prefixes, so these are final.
+    std::vector<int> stableTokens(size_t from) const;
+
+    // Counters since construction
+    uint64_t framesDecoded() const { return frames_decoded_; }
+    uint64_t framesSkipped() const { return frames_skipped_; }
+    size_t trieSize() const { return nodes_.size(); }
+
+private:
+    struct Node {
+        int parent;
+        int token;
+        int depth;  // prefix length
+    };
+
+    struct Prefix {
+        int node;
+        float blank;      // log P(prefix, path ends in blank)
+        float non_blank;  // log P(prefix, path ends in the last token)
+    };
+
+    // Child of node for token, created on first use
+    int extend(int node, int token);
+
+    // Slot of node in next_, added with zero probability on first use
+    Prefix& nextPrefix(int node);
+
+    void searchFrame(const float* log_probs, size_t vocab_size);
+
+    // Rebuild the trie from the beam's prefixes only
+    void compact();
+
+    Config config_;
+    std::vector<Node> nodes_;
+    std::unordered_map<uint64_t, int> children_;
+    std::vector<Prefix> beam_;
+
+    // Scratch reused across frames
+    std::vector<Prefix> next_;
+    std::unordered_map<int, size_t> next_index_;
+    std::vector<float> log_probs_;
+    std::vector<int> candidates_;
+    std::vector<int> remap_;
+    size_t compact_at_;
+
+    uint64_t frames_decoded_;
+    uint64_t frames_skipped_;
+};
+
+} // namespace onnx_stt
+
+#endif // CTC_PREFIX_BEAM_SEARCH_HPP
@@ -39,23 +39,40 @@ public:
     explicit CacheManager(const CacheConfig& config);
     ~CacheManager() = default;
     
-    // Initialize cache tensors
+    // Initialize cache tensors: resolves every cache to an integer slot in one
+    // aligned arena and builds the Ort::Value views over it
     bool initialize();
     
-    // Reset all caches to initial state
+    // Reset all caches to initial state (one memset over the arena)
     void reset();
     
-    // Get cache tensors for model input
-    std::vector<Ort::Value> getInputCaches(Ort::MemoryInfo& memory_info);
+    // Pre-built cache views for model input, in cache_tensor_names order.
+    // The views alias the arena, so they stay valid until the next initialize().
+    const std::vector<Ort::Value>& getInputCaches() const { return input_values_; }
     
-    // Update caches from model output
+    // Append fresh views over the arena (for callers assembling their own input array)
+    void appendInputViews(std::vector<Ort::Value>& values) const;
+    
+    // Update caches from model output, in cache_tensor_names order. Copies straight
+    // into the arena slots; no lookups or allocation.
     void updateCaches(const std::vector<Ort::Value>& output_caches);
+    void updateCaches(const Ort::Value* output_caches, size_t count);
+    
+    // Slot lookup (initialization time) and direct slot access
+    int getSlot(const std::string& name) const;
+    float* getFloatData(int slot);
+    int64_t* getIntData(int slot);
+    size_t getElementCount(int slot) const { return slots_[slot].elements; }
+    const std::vector<int64_t>& getShape(int slot) const { return slots_[slot].shape; }
+    
+    // Total arena size in bytes
+    size_t getArenaBytes() const { return arena_bytes_; }
     
     // Get cache configuration
     const CacheConfig& getConfig() const { return config_; }
     
     // Get number of cache tensors
-    size_t getNumCaches() const { return cache_tensors_.size(); }
+    size_t getNumCaches() const { return slots_.size(); }
     
     // Get cache tensor names (for model I/O)
     const std::vector<std::string>& getCacheNames() const { return config_.cache_tensor_names; }
@@ -67,11 +84,24 @@ public:
     static CacheConfig createSpeechBrainConfig(int hidden_size = 512);
     
 private:
+    // One cache tensor inside the arena
+    struct CacheSlot {
+        std::vector<int64_t> shape;
+        bool is_int64 = false;
+        size_t elements = 0;
+        size_t offset = 0;   // byte offset into the arena (cache-line aligned)
+    };
+    
     CacheConfig config_;
     
-    // Cache data storage
-    std::map<std::string, std::vector<float>> cache_tensors_;
-    std::map<std::string, std::vector<int64_t>> int_cache_tensors_;
+    // Cache data storage: slots_[i] describes config_.cache_tensor_names[i]
+    std::vector<CacheSlot> slots_;
+    std::vector<unsigned char> arena_storage_;
+    unsigned char* arena_ = nullptr;   // arena_storage_ rounded up to the alignment
+    size_t arena_bytes_ = 0;
+    
+    Ort::MemoryInfo memory_info_;
+    std::vector<Ort::Value> input_values_;
     
     // Helper methods
     void initializeZipformerCaches();
@@ -80,8 +110,8 @@ private:
     void initializeSpeechBrainCaches();
     void initializeCustomCaches();
     
-    std::vector<float>& getFloatCache(const std::string& name);
-    std::vector<int64_t>& getIntCache(const std::string& name);
+    void addCache(const std::string& name, const std::vector<int64_t>& shape, const std::string& dtype);
+    void allocateArena();
 };
 
 } // namespace onnx_stt
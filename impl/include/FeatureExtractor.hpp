@@ -4,6 +4,8 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <cstdint>
+#include "FeatureMatrix.hpp"
 
 namespace onnx_stt {
 
@@ -37,6 +39,14 @@ public:
     // Extract features from int16 samples
     virtual std::vector<std::vector<float>> computeFeatures(const int16_t* samples, size_t num_samples) = 0;
     
+    // Extract features into a caller-owned [frames, bins] matrix, reusing its storage.
+    // The default adapts the nested-vector overload; extractors override it to write
+    // frames in place without per-frame allocations.
+    virtual void computeFeatures(const float* audio, size_t num_samples, FeatureMatrix& out) {
+        auto nested = computeFeatures(std::vector<float>(audio, audio + num_samples));
+        out = FeatureMatrix::fromNested(nested);
+    }
+    
     // Get configuration
     virtual const Config& getConfig() const = 0;
     
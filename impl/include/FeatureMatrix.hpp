@@ -0,0 +1,171 @@
+#ifndef FEATURE_MATRIX_HPP
+#define FEATURE_MATRIX_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+namespace onnx_stt {
+
+/**
+ * Memory layout of a feature matrix
+ * FRAMES_BY_BINS: [time, features] (Zipformer, NeMo cache-aware audio_signal)
+ * BINS_BY_FRAMES: [features, time] (NeMo CTC / RNNT encoders)
+ */
+enum class FeatureLayout {
+    FRAMES_BY_BINS,
+    BINS_BY_FRAMES
+};
+
+/**
+ * Non-owning view of a contiguous feature matrix
+ * Cheap to copy; the underlying buffer must outlive the view.
+ */
+class FeatureView {
+public:
+    FeatureView() = default;
+    FeatureView(const float* data, size_t num_frames, size_t num_bins,
+                FeatureLayout layout = FeatureLayout::FRAMES_BY_BINS)
+        : data_(data), num_frames_(num_frames), num_bins_(num_bins), layout_(layout) {}
+
+    const float* data() const { return data_; }
+    size_t numFrames() const { return num_frames_; }
+    size_t numBins() const { return num_bins_; }
+    size_t size() const { return num_frames_ * num_bins_; }
+    bool empty() const { return num_frames_ == 0 || num_bins_ == 0; }
+    FeatureLayout layout() const { return layout_; }
+
+    float at(size_t frame, size_t bin) const {
+        return layout_ == FeatureLayout::FRAMES_BY_BINS ? data_[frame * num_bins_ + bin]
+                                                        : data_[bin * num_frames_ + frame];
+    }
+
+    // Row pointer for FRAMES_BY_BINS views
+    const float* frame(size_t index) const { return data_ + index * num_bins_; }
+
+    // Sub-range of frames (FRAMES_BY_BINS only; use the copy helpers for the other layout)
+    FeatureView frames(size_t begin, size_t count) const {
+        return FeatureView(data_ + begin * num_bins_, count, num_bins_, layout_);
+    }
+
+    // Copy frames [begin, begin + count) into a [count, bins] buffer, transposing if needed
+    void copyFramesByBins(float* out, size_t begin, size_t count) const {
+        if (layout_ == FeatureLayout::FRAMES_BY_BINS) {
+            std::memcpy(out, data_ + begin * num_bins_, count * num_bins_ * sizeof(float));
+            return;
+        }
+        for (size_t f = 0; f < count; ++f) {
+            for (size_t b = 0; b < num_bins_; ++b) {
+                out[f * num_bins_ + b] = data_[b * num_frames_ + begin + f];
+            }
+        }
+    }
+
+    // Copy frames [begin, begin + count) into a [bins, count] buffer, transposing if needed
+    void copyBinsByFrames(float* out, size_t begin, size_t count) const {
+        if (layout_ == FeatureLayout::BINS_BY_FRAMES) {
+            for (size_t b = 0; b < num_bins_; ++b) {
+                std::memcpy(out + b * count, data_ + b * num_frames_ + begin, count * sizeof(float));
+            }
+            return;
+        }
+        for (size_t b = 0; b < num_bins_; ++b) {
+            for (size_t f = 0; f < count; ++f) {
+                out[b * count + f] = data_[(begin + f) * num_bins_ + b];
+            }
+        }
+    }
+
+    void copyFramesByBins(float* out) const { copyFramesByBins(out, 0, num_frames_); }
+    void copyBinsByFrames(float* out) const { copyBinsByFrames(out, 0, num_frames_); }
+
+    // Legacy nested form (one vector per frame)
+    std::vector<std::vector<float>> toNested() const {
+        std::vector<std::vector<float>> nested(num_frames_, std::vector<float>(num_bins_));
+        for (size_t f = 0; f < num_frames_; ++f) {
+            for (size_t b = 0; b < num_bins_; ++b) {
+                nested[f][b] = at(f, b);
+            }
+        }
+        return nested;
+    }
+
+private:
+    const float* data_ = nullptr;
+    size_t num_frames_ = 0;
+    size_t num_bins_ = 0;
+    FeatureLayout layout_ = FeatureLayout::FRAMES_BY_BINS;
+};
+
+/**
+ * Owning contiguous feature matrix
+ * resize() keeps the allocation, so a matrix reused across chunks stops allocating
+ * once it has seen the largest chunk.
+ */
+class FeatureMatrix {
+public:
+    FeatureMatrix() = default;
+    FeatureMatrix(size_t num_frames, size_t num_bins,
+                  FeatureLayout layout = FeatureLayout::FRAMES_BY_BINS)
+        : data_(num_frames * num_bins, 0.0f), num_frames_(num_frames), num_bins_(num_bins),
+          layout_(layout) {}
+
+    void resize(size_t num_frames, size_t num_bins) {
+        num_frames_ = num_frames;
+        num_bins_ = num_bins;
+        data_.resize(num_frames * num_bins);
+    }
+
+    void reserve(size_t num_frames, size_t num_bins) { data_.reserve(num_frames * num_bins); }
+    void clear() { resize(0, num_bins_); }
+    void setLayout(FeatureLayout layout) { layout_ = layout; }
+
+    float* data() { return data_.data(); }
+    const float* data() const { return data_.data(); }
+    size_t numFrames() const { return num_frames_; }
+    size_t numBins() const { return num_bins_; }
+    size_t size() const { return data_.size(); }
+    bool empty() const { return num_frames_ == 0 || num_bins_ == 0; }
+    FeatureLayout layout() const { return layout_; }
+
+    float* frame(size_t index) { return data_.data() + index * num_bins_; }
+    const float* frame(size_t index) const { return data_.data() + index * num_bins_; }
+
+    // Append frames to a FRAMES_BY_BINS matrix
+    void appendFrames(const float* frames, size_t count) {
+        data_.insert(data_.end(), frames, frames + count * num_bins_);
+        num_frames_ += count;
+    }
+
+    // Drop the oldest frames of a FRAMES_BY_BINS matrix
+    void dropFrames(size_t count) {
+        count = std::min(count, num_frames_);
+        data_.erase(data_.begin(), data_.begin() + count * num_bins_);
+        num_frames_ -= count;
+    }
+
+    FeatureView view() const { return FeatureView(data_.data(), num_frames_, num_bins_, layout_); }
+    operator FeatureView() const { return view(); }
+
+    std::vector<std::vector<float>> toNested() const { return view().toNested(); }
+
+    static FeatureMatrix fromNested(const std::vector<std::vector<float>>& nested) {
+        size_t num_bins = nested.empty() ? 0 : nested[0].size();
+        FeatureMatrix matrix(nested.size(), num_bins);
+        for (size_t f = 0; f < nested.size(); ++f) {
+            std::copy_n(nested[f].begin(), std::min(num_bins, nested[f].size()), matrix.frame(f));
+        }
+        return matrix;
+    }
+
+private:
+    std::vector<float> data_;
+    size_t num_frames_ = 0;
+    size_t num_bins_ = 0;
+    FeatureLayout layout_ = FeatureLayout::FRAMES_BY_BINS;
+};
+
+} // namespace onnx_stt
+
+#endif // FEATURE_MATRIX_HPP
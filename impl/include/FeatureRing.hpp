@@ -0,0 +1,130 @@
+#ifndef FEATURE_RING_HPP
+#define FEATURE_RING_HPP
+
+#include "FeatureMatrix.hpp"
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+namespace onnx_stt {
+
+/**
+ * Per-stream feature buffer for cache-aware encoders
+ *
+ * Frames arrive in whatever sizes the caller produces them and leave as
+ * encoder windows of context_frames + step_frames. Each window starts with the
+ * last context_frames of the previous one (the encoder's pre-encode cache;
+ * pad_value frames before the first), so consecutive windows advance by
+ * exactly step_frames, a multiple of the subsampling factor, and subsampled
+ * frames line up across chunks. Frames short of a full step stay buffered for
+ * the next push(); only popFinal() at end of stream pads.
+ *
+ * setRamp() gives the first windows of each stream shorter steps, so the
+ * encoder runs before a full step of audio has arrived.
+ */
+class FeatureRing {
+public:
+    FeatureRing() = default;
+    FeatureRing(size_t num_bins, size_t context_frames, size_t step_frames, size_t subsampling,
+                float pad_value = 0.0f)
+        : num_bins_(num_bins), context_frames_(context_frames), step_frames_(step_frames),
+          subsampling_(std::max<size_t>(subsampling, 1)), pad_value_(pad_value) {
+        buffer_.reserve(2 * windowFrames() * num_bins_);
+        reset();
+    }
+
+    // Drop buffered frames and restart with padding as the pre-encode context
+    void reset() {
+        buffer_.assign(context_frames_ * num_bins_, pad_value_);
+        head_ = 0;
+        windows_ = 0;
+    }
+
+    // Steps of the first windows of every stream (each a multiple of the
+    // subsampling factor and at most stepFrames()); later windows use stepFrames()
+    void setRamp(const std::vector<size_t>& steps) { ramp_ = steps; }
+    const std::vector<size_t>& ramp() const { return ramp_; }
+
+    // Append frames (either layout)
+    void push(const FeatureView& frames) {
+        compact();
+        size_t old_size = buffer_.size();
+        buffer_.resize(old_size + frames.numFrames() * num_bins_);
+        frames.copyFramesByBins(buffer_.data() + old_size);
+    }
+
+    // A full window is buffered
+    bool ready() const { return pendingFrames() >= nextStep(); }
+
+    // Copy the next window into out (at most [windowFrames(), bins]) and advance
+    // by its step; returns the window length
+    size_t pop(float* out) {
+        size_t step = nextStep();
+        std::memcpy(out, buffer_.data() + head_ * num_bins_, (context_frames_ + step) * num_bins_ * sizeof(float));
+        head_ += step;
+        ++windows_;
+        return context_frames_ + step;
+    }
+
+    // End of stream: copy the context and the remaining frames into out, padded
+    // up to a multiple of the subsampling factor, and reset. Returns the window
+    // length (0 if no frames were pending); pad frames are paddedFrames() of it.
+    size_t popFinal(float* out) {
+        size_t pending = std::min(pendingFrames(), nextStep());
+        if (pending == 0) {
+            reset();
+            padded_ = 0;
+            return 0;
+        }
+        size_t aligned = (pending + subsampling_ - 1) / subsampling_ * subsampling_;
+        size_t valid = context_frames_ + pending;
+        std::memcpy(out, buffer_.data() + head_ * num_bins_, valid * num_bins_ * sizeof(float));
+        std::fill(out + valid * num_bins_, out + (context_frames_ + aligned) * num_bins_, pad_value_);
+        padded_ = aligned - pending;
+        reset();
+        return context_frames_ + aligned;
+    }
+
+    // Frames after the context not yet sent in a window
+    size_t pendingFrames() const {
+        return num_bins_ == 0 ? 0 : buffer_.size() / num_bins_ - head_ - context_frames_;
+    }
+
+    // Step of the next window (ramp first, then stepFrames())
+    size_t nextStep() const { return windows_ < ramp_.size() ? ramp_[windows_] : step_frames_; }
+
+    // Longest window, and windows popped since reset()
+    size_t windowFrames() const { return context_frames_ + step_frames_; }
+    size_t windowsPopped() const { return windows_; }
+    size_t contextFrames() const { return context_frames_; }
+    size_t stepFrames() const { return step_frames_; }
+    size_t paddedFrames() const { return padded_; }
+
+private:
+    // Move the unread frames to the front once the consumed part outgrows them
+    void compact() {
+        size_t used = buffer_.size() - head_ * num_bins_;
+        if (head_ == 0 || head_ * num_bins_ < used) {
+            return;
+        }
+        std::memmove(buffer_.data(), buffer_.data() + head_ * num_bins_, used * sizeof(float));
+        buffer_.resize(used);
+        head_ = 0;
+    }
+
+    std::vector<float> buffer_;  // [frames, bins], frames before head_ already consumed
+    size_t head_ = 0;            // first frame of the next window
+    size_t num_bins_ = 0;
+    size_t context_frames_ = 0;
+    size_t step_frames_ = 0;
+    size_t subsampling_ = 1;
+    size_t padded_ = 0;          // pad frames added by the last popFinal()
+    size_t windows_ = 0;         // windows popped since reset()
+    std::vector<size_t> ramp_;
+    float pad_value_ = 0.0f;
+};
+
+} // namespace onnx_stt
+
+#endif // FEATURE_RING_HPP
@@ -6,6 +6,9 @@
 #include <algorithm>
 #include <complex>
 #include <memory>
+#include "RealFFT.hpp"
+#include "MelFilterbank.hpp"
+#include "AudioPreprocessor.hpp"
 
 namespace improved_fbank {
 
@@ -26,14 +29,26 @@ public:
         bool use_energy = true;
         bool apply_log = true;
         float dither = 1e-5f;  // NeMo default dither
+        uint32_t dither_seed = 0;  // per-stream dither sequence
         bool normalize_per_feature = true;  // NeMo: normalize: per_feature
     };
     
     explicit FbankComputer(const Options& opts);
     
-    // Main feature computation method
+    // Main feature computation method; dithers the audio as the next samples
+    // of the stream, so successive calls get successive noise
     std::vector<std::vector<float>> computeFeatures(const std::vector<float>& audio);
     
+    // Dither the next num_samples of the stream into output, for callers that
+    // keep samples across calls and must dither each one only once
+    void dither(const float* samples, size_t num_samples, float* output);
+    
+    // Features of audio that has already been through dither()
+    std::vector<std::vector<float>> computeDitheredFeatures(const std::vector<float>& audio);
+    
+    // Start a new stream's dither sequence
+    void reset() { dither_.reset(); }
+    
     // Apply CMVN normalization if stats are available
     void setCMVNStats(const std::vector<float>& mean_stats, const std::vector<float>& var_stats, int frame_count);
     
@@ -47,23 +62,27 @@ private:
     // Window function (Hann window for NeMo compatibility)
     std::vector<float> window_;
     
-    // Mel filterbank matrix [num_mel_bins x (n_fft/2 + 1)]
-    std::vector<std::vector<float>> mel_filterbank_;
+    // Banded mel filterbank [num_mel_bins x (n_fft/2 + 1)], shared between computers
+    std::shared_ptr<const onnx_stt::MelFilterbank> mel_filterbank_;
+    
+    // Shared FFT plan for n_fft
+    std::shared_ptr<const onnx_stt::RealFFT> fft_;
     
     // CMVN statistics
     std::vector<float> cmvn_mean_;
     std::vector<float> cmvn_var_;
     bool cmvn_available_;
+    onnx_stt::AudioPreprocessor dither_;  // advances across calls
     
     // Private methods
     void initializeWindow();
     void initializeMelFilterbank();
+    std::vector<std::vector<float>> createDenseMelFilterbank();
     float melScale(float freq);
     float invMelScale(float mel);
     std::vector<float> computeFFT(const std::vector<float>& frame);
     std::vector<float> applyMelFilterbank(const std::vector<float>& power_spectrum);
     void applyCMVN(std::vector<std::vector<float>>& features);
-    void applyDither(std::vector<float>& audio);
 };
 
 // Utility function to load CMVN stats from NeMo format
@@ -3,29 +3,59 @@
 
 #include <vector>
 #include <memory>
+#include "FeatureMatrix.hpp"
 #include "kaldi-native-fbank/csrc/feature-fbank.h"
 #include "kaldi-native-fbank/csrc/online-feature.h"
 
 /**
  * Feature extractor using kaldi-native-fbank library
  * Provides librosa-compatible mel spectrograms for NeMo models
+ *
+ * Two modes:
+ *  - offline: extractMelSpectrogram() processes one complete utterance and
+ *    returns [features, time] (BINS_BY_FRAMES, the NeMo encoder input)
+ *  - streaming: acceptWaveform() / inputFinished() keep one OnlineFbank for the
+ *    stream and append only the frames that became ready to a FRAMES_BY_BINS
+ *    FeatureMatrix, so feature work is proportional to new audio, frames can be
+ *    appended in time order, and chunk edges produce the same frames as offline
  */
 class KaldiFbankFeatureExtractor {
 public:
     KaldiFbankFeatureExtractor();
     ~KaldiFbankFeatureExtractor() = default;
 
-    // Extract mel spectrogram features for NeMo models
+    // Extract mel spectrogram features for NeMo models, [features, time]
     std::vector<float> extractMelSpectrogram(const std::vector<float>& audio_data);
     
     // Get expected number of frames for given audio length
     int getNumFrames(int audio_length) const;
+    
+    // Streaming: push samples and append the newly ready frames to frames
+    // ([time, features]); returns the number appended
+    size_t acceptWaveform(const float* samples, size_t num_samples, onnx_stt::FeatureMatrix& frames);
+    size_t acceptWaveform(const std::vector<float>& samples, onnx_stt::FeatureMatrix& frames);
+    
+    // Streaming: end of stream, appends the frames held back for right context
+    size_t inputFinished(onnx_stt::FeatureMatrix& frames);
+    
+    // Streaming: start a new stream
+    void reset();
+    
+    int getFeatureDim() const { return fbank_opts_.mel_opts.num_bins; }
+    int getNumFramesEmitted() const { return frames_emitted_; }
+    bool isInputFinished() const { return input_finished_; }
 
 private:
     std::unique_ptr<knf::OnlineFbank> fbank_;
     knf::FbankOptions fbank_opts_;
     
+    // Streaming state (separate from the offline extractor above)
+    std::unique_ptr<knf::OnlineFbank> stream_fbank_;
+    int32_t frames_emitted_ = 0;
+    bool input_finished_ = false;
+    
     void setupFbankOptions();
+    size_t collectNewFrames(onnx_stt::FeatureMatrix& frames);
 };
 
-#endif // KALDI_FBANK_FEATURE_EXTRACTOR_HPP
\ No newline at end of file
+#endif // KALDI_FBANK_FEATURE_EXTRACTOR_HPP
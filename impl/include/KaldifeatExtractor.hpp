@@ -27,6 +27,7 @@ public:
     
     std::vector<std::vector<float>> computeFeatures(const std::vector<float>& audio) override;
     std::vector<std::vector<float>> computeFeatures(const int16_t* samples, size_t num_samples) override;
+    void computeFeatures(const float* audio, size_t num_samples, FeatureMatrix& out) override;
     
     const Config& getConfig() const override { return config_; }
     int getFeatureDim() const override;
@@ -45,7 +46,7 @@ private:
     
     // Helper methods
     bool loadCmvnStats(const std::string& stats_path);
-    void applyCmvn(std::vector<std::vector<float>>& features);
+    void applyCmvn(FeatureMatrix& features);
     std::vector<float> convertInt16ToFloat(const int16_t* samples, size_t num_samples);
     
     // Kaldifeat-specific members (conditionally compiled)
@@ -68,6 +69,7 @@ public:
     
     std::vector<std::vector<float>> computeFeatures(const std::vector<float>& audio) override;
     std::vector<std::vector<float>> computeFeatures(const int16_t* samples, size_t num_samples) override;
+    void computeFeatures(const float* audio, size_t num_samples, FeatureMatrix& out) override;
     
     const Config& getConfig() const override { return config_; }
     int getFeatureDim() const override { return config_.num_mel_bins; }
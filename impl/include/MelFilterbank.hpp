@@ -0,0 +1,62 @@
+#ifndef MEL_FILTERBANK_HPP
+#define MEL_FILTERBANK_HPP
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <functional>
+
+namespace onnx_stt {
+
+/**
+ * Banded mel filterbank
+ *
+ * Each triangular filter is stored as (start bin, length, weights) with all weights in
+ * one contiguous buffer, so applying the bank touches only the few bins each filter
+ * covers instead of the full dense [num_mels x num_bins] matrix. Banks are immutable
+ * and can be shared between extractors through the keyed cache in get().
+ *
+ * apply() runs on blocks of 8 neighbouring filters stored bin-major, so the
+ * SIMD lanes span filters rather than the few bins of one filter.
+ */
+class MelFilterbank {
+public:
+    // Build from a dense [num_mels][num_bins] matrix, dropping leading/trailing zeros
+    explicit MelFilterbank(const std::vector<std::vector<float>>& dense);
+
+    // Get a shared bank for 'key', building it from 'build_dense' on first use
+    static std::shared_ptr<const MelFilterbank> get(
+        const std::string& key,
+        const std::function<std::vector<std::vector<float>>()>& build_dense);
+
+    int numFilters() const { return static_cast<int>(starts_.size()); }
+    int numBins() const { return num_bins_; }
+
+    // out[m] = sum_k weight[m][k] * power[k]; power holds numBins() values,
+    // out holds numFilters() values
+    void apply(const float* power, float* out) const;
+
+    std::vector<float> apply(const std::vector<float>& power) const;
+
+    // Expand back to dense form (debugging / comparison with reference data)
+    std::vector<std::vector<float>> toDense() const;
+
+private:
+    int num_bins_;
+    std::vector<int> starts_;       // first non-zero bin of each filter
+    std::vector<int> lengths_;      // number of bins each filter covers
+    std::vector<int> offsets_;      // offset of each filter's weights in weights_
+    std::vector<float> weights_;    // all filter weights, back to back
+
+    // The same filters in blocks of kBlock for apply(): block b covers bins
+    // [block_starts_[b], + block_lengths_[b]) with kBlock weights per bin
+    static const int kBlock = 8;
+    std::vector<int> block_starts_;
+    std::vector<int> block_lengths_;
+    std::vector<int> block_offsets_;
+    std::vector<float> block_weights_;
+};
+
+} // namespace onnx_stt
+
+#endif // MEL_FILTERBANK_HPP
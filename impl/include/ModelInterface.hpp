@@ -6,6 +6,7 @@
 #include <memory>
 #include <map>
 #include "CacheManager.hpp"
+#include "FeatureMatrix.hpp"
 
 namespace onnx_stt {
 
@@ -25,6 +26,8 @@ public:
         // Model parameters
         int sample_rate = 16000;
         int chunk_frames = 32;
+        int first_chunk_frames = 0;   // streaming: new frames in a stream's first chunk (0: chunk_frames)
+        int chunk_ramp = 0;           // streaming: chunks after the first growing to chunk_frames
         int feature_dim = 80;
         int vocab_size = 0;
         
@@ -32,11 +35,16 @@ public:
         int beam_size = 10;
         int blank_id = 0;
         float blank_penalty = 0.0f;
+        float blank_skip_threshold = 0.0f;  // CTC: frames with P(blank) above it skip the search (0: off)
         
         // Performance settings
         int num_threads = 4;
         bool use_gpu = false;
         std::string provider = "cpu";  // cpu, cuda, tensorrt
+        bool cache_optimized_model = false;  // save/reuse optimized graphs next to the models
+        bool memory_map_model = false;       // map .ort models read-only, shared between PEs
+        bool quantized_encoder = false;      // INT8 encoder (<encoder>.int8.onnx); decoder/joiner stay FP32
+        bool fixed_shape_encoder = false;    // pin the encoder's free dimensions to the chunk shape
         
         // Cache configuration
         CacheManager::CacheConfig cache_config;
@@ -70,6 +78,24 @@ public:
     virtual TranscriptionResult processChunk(const std::vector<std::vector<float>>& features, 
                                             uint64_t timestamp_ms) = 0;
     
+    // Process a contiguous feature matrix. The default adapts to the nested-vector
+    // overload; models override it to feed the buffer to ONNX Runtime without copies.
+    virtual TranscriptionResult processChunk(const FeatureView& features, uint64_t timestamp_ms) {
+        return processChunk(features.toNested(), timestamp_ms);
+    }
+    
+    // End of stream: process whatever the model still buffers (e.g. frames
+    // short of a full chunk) and return its text. Models that buffer nothing
+    // return an empty final result.
+    virtual TranscriptionResult flush(uint64_t timestamp_ms) {
+        TranscriptionResult result;
+        result.is_final = true;
+        result.confidence = 0.0;
+        result.timestamp_ms = timestamp_ms;
+        result.latency_ms = 0;
+        return result;
+    }
+    
     // Reset model state (caches, beam search, etc.)
     virtual void reset() = 0;
     
@@ -87,6 +113,10 @@ public:
     
     // Get expected chunk size in frames
     virtual int getChunkFrames() const = 0;
+    
+    // Create an independent stream (own caches and decoding state) that shares
+    // this model's loaded weights. Returns nullptr if the model cannot share.
+    virtual std::unique_ptr<ModelInterface> createStream() const { return nullptr; }
 };
 
 /**
@@ -5,67 +5,136 @@
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <limits>
 
-NeMoCTCImpl::NeMoCTCImpl() : initialized_(false), blank_id_(-1) {
+namespace {
+
+// Models loaded in this process, keyed by model and tokens path
+std::mutex g_models_mutex;
+std::map<std::string, std::weak_ptr<const NeMoCTCImpl::SharedModel>> g_models;
+
+// Streaming sizes are whole encoder frames: 8 feature frames of 10 ms
+const size_t kMsPerFeatureFrame = 10;
+const size_t kSubsampling = 8;
+const size_t kMelBins = 80;
+
+size_t toEncoderFrames(int ms) {
+    size_t frames = (static_cast<size_t>(std::max(ms, 0)) + kMsPerFeatureFrame - 1) / kMsPerFeatureFrame;
+    return (frames + kSubsampling - 1) / kSubsampling * kSubsampling;
+}
+
+} // namespace
+
+NeMoCTCImpl::NeMoCTCImpl() : initialized_(false), quantized_encoder_(false),
+                             beam_size_(1), max_candidates_per_frame_(8),
+                             frames_offset_(0), left_frames_(0), chunk_frames_(0), right_frames_(0),
+                             decoded_until_(0), windows_encoded_(0), window_frames_encoded_(0),
+                             frames_consumed_(0),
+                             blank_skip_threshold_(0.0f),
+                             frames_decoded_(0), frames_skipped_(0), decode_us_(0) {
+}
+
+NeMoCTCImpl::NeMoCTCImpl(std::shared_ptr<const SharedModel> model)
+    : model_(std::move(model)),
+      memory_info_(std::make_unique<Ort::MemoryInfo>(
+          Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))),
+      initialized_(model_ != nullptr),
+      quantized_encoder_(false),
+      beam_size_(1),
+      max_candidates_per_frame_(8),
+      frames_offset_(0),
+      left_frames_(0),
+      chunk_frames_(0),
+      right_frames_(0),
+      decoded_until_(0),
+      windows_encoded_(0),
+      window_frames_encoded_(0),
+      frames_consumed_(0),
+      blank_skip_threshold_(0.0f),
+      frames_decoded_(0),
+      frames_skipped_(0),
+      decode_us_(0) {
 }
 
 NeMoCTCImpl::~NeMoCTCImpl() {
 }
 
+std::shared_ptr<const NeMoCTCImpl::SharedModel> NeMoCTCImpl::loadSharedModel(const std::string& model_path,
+                                                                             const std::string& tokens_path,
+                                                                             const onnx_stt::OrtRuntime::SessionConfig& session_config) {
+    const std::string key = model_path + "|" + tokens_path + "|" + session_config.key();
+    
+    // Held across the load so concurrent operator instances wait for one copy
+    std::lock_guard<std::mutex> lock(g_models_mutex);
+    auto existing = g_models[key].lock();
+    if (existing) {
+        std::cout << "Reusing loaded NeMo CTC model: " << model_path << std::endl;
+        return existing;
+    }
+    
+    auto model = std::make_shared<SharedModel>();
+    
+    // Load model on the process-wide thread pools
+    model->session = onnx_stt::OrtRuntime::instance().getSession(model_path, session_config);
+    model->model_path = model_path;
+    
+    // Get model input/output info
+    Ort::AllocatorWithDefaultOptions allocator;
+    
+    // Input info
+    size_t num_inputs = model->session->GetInputCount();
+    model->input_names.reserve(num_inputs);
+    model->input_shapes.reserve(num_inputs);
+    
+    for (size_t i = 0; i < num_inputs; i++) {
+        auto input_name = model->session->GetInputNameAllocated(i, allocator);
+        model->input_names.push_back(std::string(input_name.get()));
+        
+        auto input_shape = model->session->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape();
+        model->input_shapes.push_back(input_shape);
+    }
+    
+    // Output info
+    size_t num_outputs = model->session->GetOutputCount();
+    model->output_names.reserve(num_outputs);
+    model->output_shapes.reserve(num_outputs);
+    
+    for (size_t i = 0; i < num_outputs; i++) {
+        auto output_name = model->session->GetOutputNameAllocated(i, allocator);
+        model->output_names.push_back(std::string(output_name.get()));
+        
+        auto output_shape = model->session->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape();
+        model->output_shapes.push_back(output_shape);
+    }
+    
+    // Load vocabulary
+    if (!loadVocabulary(tokens_path, *model)) {
+        std::cerr << "Failed to load vocabulary from: " << tokens_path << std::endl;
+        return nullptr;
+    }
+    
+    std::cout << "Model inputs: " << num_inputs << ", outputs: " << num_outputs << std::endl;
+    
+    g_models[key] = model;
+    return model;
+}
+
 bool NeMoCTCImpl::initialize(const std::string& model_path, const std::string& tokens_path) {
     try {
-        // Initialize ONNX Runtime
-        env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "NeMoCTC");
-        session_options_ = std::make_unique<Ort::SessionOptions>();
-        session_options_->SetIntraOpNumThreads(1);
-        session_options_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
-        
         memory_info_ = std::make_unique<Ort::MemoryInfo>(
             Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)
         );
         
-        // Load model
-        session_ = std::make_unique<Ort::Session>(*env_, model_path.c_str(), *session_options_);
-        
-        // Get model input/output info
-        Ort::AllocatorWithDefaultOptions allocator;
-        
-        // Input info
-        size_t num_inputs = session_->GetInputCount();
-        input_names_.reserve(num_inputs);
-        input_shapes_.reserve(num_inputs);
-        
-        for (size_t i = 0; i < num_inputs; i++) {
-            auto input_name = session_->GetInputNameAllocated(i, allocator);
-            input_names_.push_back(std::string(input_name.get()));
-            
-            auto input_shape = session_->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape();
-            input_shapes_.push_back(input_shape);
-        }
-        
-        // Output info
-        size_t num_outputs = session_->GetOutputCount();
-        output_names_.reserve(num_outputs);
-        output_shapes_.reserve(num_outputs);
-        
-        for (size_t i = 0; i < num_outputs; i++) {
-            auto output_name = session_->GetOutputNameAllocated(i, allocator);
-            output_names_.push_back(std::string(output_name.get()));
-            
-            auto output_shape = session_->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape();
-            output_shapes_.push_back(output_shape);
-        }
-        
-        // Load vocabulary
-        if (!loadVocabulary(tokens_path)) {
-            std::cerr << "Failed to load vocabulary from: " << tokens_path << std::endl;
+        model_ = loadSharedModel(onnx_stt::OrtRuntime::selectModel(model_path, quantized_encoder_),
+                                 tokens_path, session_config_);
+        if (!model_) {
             return false;
         }
         
         initialized_ = true;
         std::cout << "✅ NeMo CTC model initialized successfully" << std::endl;
-        std::cout << "Model inputs: " << num_inputs << ", outputs: " << num_outputs << std::endl;
-        std::cout << "Vocabulary size: " << vocab_.size() << ", blank_id: " << blank_id_ << std::endl;
+        std::cout << "Vocabulary size: " << model_->vocab.size() << ", blank_id: " << model_->blank_id << std::endl;
         
         return true;
         
@@ -75,7 +144,35 @@ bool NeMoCTCImpl::initialize(const std::string& model_path, const std::string& t
     }
 }
 
-bool NeMoCTCImpl::loadVocabulary(const std::string& tokens_path) {
+void NeMoCTCImpl::setBeamSearch(int beam_size, int max_candidates_per_frame) {
+    beam_size_ = std::max(1, beam_size);
+    max_candidates_per_frame_ = std::max(1, max_candidates_per_frame);
+    decode_.beam_search.reset();  // rebuilt with the new limits on the next decode
+    resetDecoder();
+}
+
+void NeMoCTCImpl::setBufferedStreaming(int left_context_ms, int chunk_ms, int right_context_ms) {
+    left_frames_ = toEncoderFrames(left_context_ms);
+    chunk_frames_ = toEncoderFrames(chunk_ms);
+    right_frames_ = toEncoderFrames(right_context_ms);
+    resetDecoder();
+}
+
+std::unique_ptr<NeMoCTCInterface> NeMoCTCImpl::createStream() const {
+    if (!initialized_) {
+        return nullptr;
+    }
+    std::unique_ptr<NeMoCTCImpl> stream(new NeMoCTCImpl(model_));
+    stream->blank_skip_threshold_ = blank_skip_threshold_;
+    stream->beam_size_ = beam_size_;
+    stream->max_candidates_per_frame_ = max_candidates_per_frame_;
+    stream->left_frames_ = left_frames_;
+    stream->chunk_frames_ = chunk_frames_;
+    stream->right_frames_ = right_frames_;
+    return std::unique_ptr<NeMoCTCInterface>(std::move(stream));
+}
+
+bool NeMoCTCImpl::loadVocabulary(const std::string& tokens_path, SharedModel& model) {
     std::ifstream file(tokens_path);
     if (!file.is_open()) {
         std::cerr << "Cannot open tokens file: " << tokens_path << std::endl;
@@ -92,15 +189,15 @@ bool NeMoCTCImpl::loadVocabulary(const std::string& tokens_path) {
         
         // Read token and id (space separated)
         if (ss >> token >> id) {
-            vocab_[id] = token;
+            model.vocab[id] = token;
             max_id = std::max(max_id, id);
         }
     }
     
     // Blank token is typically the last one
-    blank_id_ = max_id;
+    model.blank_id = max_id;
     
-    return !vocab_.empty();
+    return !model.vocab.empty();
 }
 
 std::vector<float> NeMoCTCImpl::extractMelFeatures(const std::vector<float>& audio_samples) {
@@ -112,8 +209,6 @@ std::vector<float> NeMoCTCImpl::extractMelFeatures(const std::vector<float>& aud
         return {};
     }
     
-    std::cout << "Kaldi extracted " << mel_features.size() << " feature values" << std::endl;
-    
     return mel_features;
 }
 
@@ -162,152 +257,369 @@ std::string NeMoCTCImpl::transcribe(const std::vector<float>& audio_samples) {
         }
         std::cout << std::endl;
         
-        // Prepare input tensors - match working test format exactly
-        std::vector<int64_t> audio_shape = {1, n_mels, n_frames};  // [batch, features, time] - CORRECT format
-        std::vector<int64_t> length_shape = {1};
+        std::vector<int64_t> logits_shape;
+        std::vector<float> logits_vec = runInference(mel_features, n_frames, logits_shape);
         
-        // Features are already in [features, time] format from Kaldi extractor
-        // This matches the working test_direct_inference exactly
-        auto audio_tensor = Ort::Value::CreateTensor<float>(
-            *memory_info_, 
-            mel_features.data(), 
-            mel_features.size(),
-            audio_shape.data(), 
-            audio_shape.size()
-        );
-        
-        std::vector<int64_t> length_data = {n_frames};
-        auto length_tensor = Ort::Value::CreateTensor<int64_t>(
-            *memory_info_,
-            length_data.data(),
-            length_data.size(),
-            length_shape.data(),
-            length_shape.size()
-        );
-        
-        // Prepare input/output arrays
-        std::vector<Ort::Value> input_tensors;
-        input_tensors.push_back(std::move(audio_tensor));
-        input_tensors.push_back(std::move(length_tensor));
-        
-        std::vector<const char*> input_names_cstr;
-        for (const auto& name : input_names_) {
-            input_names_cstr.push_back(name.c_str());
-        }
+        // Decode CTC output
+        return ctcDecode(logits_vec, logits_shape);
         
-        std::vector<const char*> output_names_cstr;
-        for (const auto& name : output_names_) {
-            output_names_cstr.push_back(name.c_str());
+    } catch (const std::exception& e) {
+        return "ERROR: " + std::string(e.what());
+    }
+}
+
+std::string NeMoCTCImpl::transcribeChunk(const std::vector<float>& audio_samples) {
+    if (!initialized_) {
+        std::cerr << "NeMo CTC model not initialized" << std::endl;
+        return "";
+    }
+    
+    try {
+        // Features only for the new samples; frames match the offline extractor
+        feature_extractor_.acceptWaveform(audio_samples, stream_frames_);
+        if (chunk_frames_ > 0) {
+            runBufferedWindows(false);
+        } else {
+            runPendingFrames(false);
         }
+        return tokensToText(takeStableTokens());
         
-        // Run inference
-        auto output_tensors = session_->Run(
-            Ort::RunOptions{nullptr},
-            input_names_cstr.data(),
-            input_tensors.data(),
-            input_tensors.size(),
-            output_names_cstr.data(),
-            output_names_cstr.size()
-        );
-        
-        // Get output logits
-        float* logits_data = output_tensors[0].GetTensorMutableData<float>();
-        auto logits_shape = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
-        
-        // Convert to vector for decoding
-        size_t logits_size = 1;
-        for (auto dim : logits_shape) {
-            logits_size *= dim;
+    } catch (const std::exception& e) {
+        std::cerr << "NeMo CTC chunk decode failed: " << e.what() << std::endl;
+        return "";
+    }
+}
+
+std::string NeMoCTCImpl::flushStream() {
+    if (!initialized_) {
+        return "";
+    }
+    try {
+        // The last frames and windows have no lookahead beyond the end of the stream
+        feature_extractor_.inputFinished(stream_frames_);
+        if (chunk_frames_ > 0) {
+            runBufferedWindows(true);
+        } else {
+            runPendingFrames(true);
         }
-        
-        std::vector<float> logits_vec(logits_data, logits_data + logits_size);
-        
-        // Decode CTC output
-        return ctcDecode(logits_vec, logits_shape);
+    } catch (const std::exception& e) {
+        std::cerr << "NeMo CTC final window failed: " << e.what() << std::endl;
+    }
+    std::string result = tokensToText(takeFinalTokens());
+    resetDecoder();
+    return result;
+}
+
+bool NeMoCTCImpl::warmUp(int duration_ms) {
+    if (!initialized_ || duration_ms <= 0) {
+        return false;
+    }
+    
+    try {
+        // Silence at the model's 10 ms frame rate
+        const int n_mels = 80;
+        const int n_frames = std::max(1, duration_ms / 10);
+        std::vector<float> mel_features(static_cast<size_t>(n_mels) * n_frames, 0.0f);
+        std::vector<int64_t> logits_shape;
+        auto start = std::chrono::steady_clock::now();
+        runInference(mel_features, n_frames, logits_shape);
+        onnx_stt::OrtRuntime::instance().recordFirstRun(
+            model_->model_path,
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        std::cout << "NeMo CTC warm-up done (" << n_frames << " frames)" << std::endl;
+        return true;
         
     } catch (const std::exception& e) {
-        return "ERROR: " + std::string(e.what());
+        std::cerr << "NeMo CTC warm-up failed: " << e.what() << std::endl;
+        return false;
     }
 }
 
-std::string NeMoCTCImpl::ctcDecode(const std::vector<float>& logits, const std::vector<int64_t>& shape) {
-    // Simple CTC decoding: argmax + remove consecutive duplicates + remove blanks
+std::vector<float> NeMoCTCImpl::runInference(std::vector<float>& mel_features, int n_frames,
+                                             std::vector<int64_t>& logits_shape) {
+    const int n_mels = 80;
     
-    int batch_size = shape[0];
-    int time_steps = shape[1]; 
-    int vocab_size = shape[2];
+    // Prepare input tensors - match working test format exactly
+    std::vector<int64_t> audio_shape = {1, n_mels, n_frames};  // [batch, features, time] - CORRECT format
+    std::vector<int64_t> length_shape = {1};
     
-    std::cout << "CTC decode: batch_size=" << batch_size << ", time_steps=" << time_steps 
-              << ", vocab_size=" << vocab_size << std::endl;
+    // Features are already in [features, time] format from Kaldi extractor
+    // This matches the working test_direct_inference exactly
+    auto audio_tensor = Ort::Value::CreateTensor<float>(
+        *memory_info_, 
+        mel_features.data(), 
+        mel_features.size(),
+        audio_shape.data(), 
+        audio_shape.size()
+    );
     
-    std::string result;
+    std::vector<int64_t> length_data = {n_frames};
+    auto length_tensor = Ort::Value::CreateTensor<int64_t>(
+        *memory_info_,
+        length_data.data(),
+        length_data.size(),
+        length_shape.data(),
+        length_shape.size()
+    );
     
-    // Process first batch only
-    int prev_token = -1;
+    // Prepare input/output arrays
+    std::vector<Ort::Value> input_tensors;
+    input_tensors.push_back(std::move(audio_tensor));
+    input_tensors.push_back(std::move(length_tensor));
     
-    // Debug: Print first few time steps
-    std::cout << "First 5 time steps predictions:" << std::endl;
+    std::vector<const char*> input_names_cstr;
+    for (const auto& name : model_->input_names) {
+        input_names_cstr.push_back(name.c_str());
+    }
     
-    for (int t = 0; t < time_steps; t++) {
-        // Find argmax for this time step
-        int max_idx = 0;
-        float max_val = logits[t * vocab_size];
-        
-        for (int v = 1; v < vocab_size; v++) {
-            float val = logits[t * vocab_size + v];
-            if (val > max_val) {
-                max_val = val;
-                max_idx = v;
+    std::vector<const char*> output_names_cstr;
+    for (const auto& name : model_->output_names) {
+        output_names_cstr.push_back(name.c_str());
+    }
+    
+    // Run inference
+    auto output_tensors = model_->session->Run(
+        Ort::RunOptions{nullptr},
+        input_names_cstr.data(),
+        input_tensors.data(),
+        input_tensors.size(),
+        output_names_cstr.data(),
+        output_names_cstr.size()
+    );
+    
+    // Get output logits
+    float* logits_data = output_tensors[0].GetTensorMutableData<float>();
+    logits_shape = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
+    
+    // Convert to vector for decoding
+    size_t logits_size = 1;
+    for (auto dim : logits_shape) {
+        logits_size *= dim;
+    }
+    
+    return std::vector<float>(logits_data, logits_data + logits_size);
+}
+
+std::string NeMoCTCImpl::ctcDecode(const std::vector<float>& logits, const std::vector<int64_t>& shape) {
+    // Whole utterance: decode every frame on a fresh state, then take the best
+    // path; the stream's features and decode state are put back untouched
+    DecodeState stream_state;
+    std::swap(decode_, stream_state);
+    decodeFrames(logits.data(), static_cast<int>(shape[1]), static_cast<int>(shape[2]));
+    std::string result = tokensToText(takeFinalTokens());
+    std::swap(decode_, stream_state);
+    return result;
+}
+
+void NeMoCTCImpl::resetDecoder() {
+    decode_.prev_token = -1;
+    decode_.pending_tokens.clear();
+    decode_.tokens_emitted = 0;
+    decode_.text_emitted = false;
+    stream_frames_.clear();
+    frames_offset_ = 0;
+    decoded_until_ = 0;
+    feature_extractor_.reset();
+    if (decode_.beam_search) {
+        decode_.beam_search->reset();
+    }
+}
+
+void NeMoCTCImpl::decodeFrames(const float* logits, int time_steps, int vocab_size) {
+    // Greedy (argmax, collapse repeats, drop blanks) or prefix beam search;
+    // both continue from the state left by the previous call
+    auto decode_start = std::chrono::steady_clock::now();
+    
+    if (beam_size_ > 1) {
+        if (!decode_.beam_search) {
+            onnx_stt::CTCPrefixBeamSearch::Config config;
+            config.blank_id = model_->blank_id;
+            config.beam_size = beam_size_;
+            config.max_candidates_per_frame = max_candidates_per_frame_;
+            config.blank_skip_threshold = blank_skip_threshold_;
+            config.inputs_are_log_probs = true;
+            decode_.beam_search.reset(new onnx_stt::CTCPrefixBeamSearch(config));
+        }
+        uint64_t skipped_before = decode_.beam_search->framesSkipped();
+        decode_.beam_search->advance(logits, static_cast<size_t>(time_steps), static_cast<size_t>(vocab_size));
+        frames_skipped_ += decode_.beam_search->framesSkipped() - skipped_before;
+    } else {
+        // The model outputs log-probabilities: a frame with log P(blank) above
+        // the threshold is blank without scanning the vocabulary
+        const float skip_log_prob = blank_skip_threshold_ > 0.0f ?
+            std::log(blank_skip_threshold_) : std::numeric_limits<float>::infinity();
+        
+        for (int t = 0; t < time_steps; t++) {
+            const float* frame = logits + static_cast<size_t>(t) * vocab_size;
+            if (frame[model_->blank_id] > skip_log_prob) {
+                decode_.prev_token = model_->blank_id;
+                ++frames_skipped_;
+                continue;
             }
+            
+            // Find argmax for this time step
+            int max_idx = static_cast<int>(std::max_element(frame, frame + vocab_size) - frame);
+            
+            // Skip repeats of the previous frame's token and blanks
+            if (max_idx != decode_.prev_token && max_idx != model_->blank_id) {
+                decode_.pending_tokens.push_back(max_idx);
+            }
+            decode_.prev_token = max_idx;
         }
-        
-        // Debug output for first 5 frames
-        if (t < 5) {
-            std::cout << "  Frame " << t << ": max_idx=" << max_idx 
-                      << " (blank=" << blank_id_ << "), max_val=" << max_val;
-            if (vocab_.find(max_idx) != vocab_.end()) {
-                std::cout << ", token='" << vocab_[max_idx] << "'";
+    }
+    
+    frames_decoded_ += static_cast<uint64_t>(time_steps);
+    decode_us_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - decode_start).count());
+}
+
+std::vector<float> NeMoCTCImpl::encodeFrames(size_t begin, size_t count, std::vector<int64_t>& logits_shape) {
+    // Stream frames [begin, begin + count) as [features, time] encoder input
+    std::vector<float> mel_features(count * kMelBins);
+    stream_frames_.view().copyBinsByFrames(mel_features.data(), begin - frames_offset_, count);
+    return runInference(mel_features, static_cast<int>(count), logits_shape);
+}
+
+void NeMoCTCImpl::runPendingFrames(bool final) {
+    // Encode the pending frames in whole encoder frames; the remainder waits
+    // for the next chunk, or is encoded as it is at the end of the stream
+    size_t pending = stream_frames_.numFrames();
+    size_t count = final ? pending : pending / kSubsampling * kSubsampling;
+    if (count == 0) {
+        return;
+    }
+    std::vector<int64_t> logits_shape;
+    std::vector<float> logits = encodeFrames(frames_offset_, count, logits_shape);
+    decodeFrames(logits.data(), static_cast<int>(logits_shape[1]), static_cast<int>(logits_shape[2]));
+    stream_frames_.dropFrames(count);
+    frames_offset_ += count;
+}
+
+void NeMoCTCImpl::runBufferedWindows(bool final) {
+    // Encode [chunk start - left, chunk end + right) for every chunk whose
+    // lookahead is buffered (at the end of the stream, whatever is left). The
+    // window's output frames are placed by timestamp, frame k centred at
+    // window_begin + (k + 0.5) * frames_per_step, and only those centred in
+    // the chunk are decoded, so consecutive windows hand over at the chunk
+    // boundary without decoding any stretch of audio twice. Windows are cut
+    // from the stream's features, so overlap costs encoder time only.
+    const size_t end = frames_offset_ + stream_frames_.numFrames();
+    while (chunk_frames_ > 0 && decoded_until_ < end) {
+        size_t chunk_end = decoded_until_ + chunk_frames_;
+        if (!final && chunk_end + right_frames_ > end) {
+            break;
+        }
+        chunk_end = std::min(chunk_end, end);
+        const bool last = chunk_end == end;
+        const size_t window_begin = std::max(frames_offset_,
+            decoded_until_ > left_frames_ ? decoded_until_ - left_frames_ : size_t(0));
+        const size_t window_end = std::min(end, chunk_end + right_frames_);
+        
+        std::vector<int64_t> logits_shape;
+        std::vector<float> logits = encodeFrames(window_begin, window_end - window_begin, logits_shape);
+        const int time_steps = static_cast<int>(logits_shape[1]);
+        const int vocab_size = static_cast<int>(logits_shape[2]);
+        if (time_steps > 0) {
+            const double frames_per_step = static_cast<double>(window_end - window_begin) / time_steps;
+            auto firstCentredAt = [&](size_t frame) {
+                double k = std::ceil(static_cast<double>(frame - window_begin) / frames_per_step - 0.5);
+                return std::min(std::max(static_cast<int>(k), 0), time_steps);
+            };
+            const int first = firstCentredAt(decoded_until_);
+            const int stop = last && final ? time_steps : firstCentredAt(chunk_end);
+            if (stop > first) {
+                decodeFrames(logits.data() + static_cast<size_t>(first) * vocab_size, stop - first, vocab_size);
             }
-            std::cout << std::endl;
         }
-        
-        // Skip if same as previous token (remove consecutive duplicates)
-        if (max_idx == prev_token) {
-            continue;
+        windows_encoded_++;
+        window_frames_encoded_ += window_end - window_begin;
+        frames_consumed_ += chunk_end - decoded_until_;
+        decoded_until_ = chunk_end;
+        
+        // Keep only the next window's left context
+        size_t keep_from = decoded_until_ > left_frames_ ? decoded_until_ - left_frames_ : 0;
+        if (keep_from > frames_offset_) {
+            stream_frames_.dropFrames(keep_from - frames_offset_);
+            frames_offset_ = keep_from;
         }
-        
-        // Skip blank token
-        if (max_idx == blank_id_) {
-            prev_token = max_idx;
+    }
+}
+
+std::vector<int> NeMoCTCImpl::takeStableTokens() {
+    std::vector<int> tokens;
+    if (beam_size_ > 1 && decode_.beam_search) {
+        tokens = decode_.beam_search->stableTokens(decode_.tokens_emitted);
+    } else {
+        // A greedy token is final as soon as its frame is decoded
+        tokens.swap(decode_.pending_tokens);
+    }
+    decode_.tokens_emitted += tokens.size();
+    return tokens;
+}
+
+std::vector<int> NeMoCTCImpl::takeFinalTokens() {
+    std::vector<int> tokens;
+    if (beam_size_ > 1 && decode_.beam_search) {
+        std::vector<int> best = decode_.beam_search->bestTokens();
+        if (best.size() > decode_.tokens_emitted) {
+            tokens.assign(best.begin() + decode_.tokens_emitted, best.end());
+        }
+    } else {
+        tokens.swap(decode_.pending_tokens);
+    }
+    decode_.tokens_emitted += tokens.size();
+    return tokens;
+}
+
+std::string NeMoCTCImpl::tokensToText(const std::vector<int>& tokens) {
+    std::string result;
+    for (int id : tokens) {
+        auto it = model_->vocab.find(id);
+        if (it == model_->vocab.end()) {
             continue;
         }
-        
-        // Add token to result
-        if (vocab_.find(max_idx) != vocab_.end()) {
-            std::string token = vocab_[max_idx];
-            
-            // Handle SentencePiece tokens (▁ character is 0xE2 0x96 0x81 in UTF-8)
-            if (token.length() >= 3 && 
-                (unsigned char)token[0] == 0xE2 && 
-                (unsigned char)token[1] == 0x96 && 
-                (unsigned char)token[2] == 0x81) {
-                result += " " + token.substr(3);  // Remove ▁ and add space
-            } else {
-                result += token;
-            }
+        const std::string& token = it->second;
+        
+        // Handle SentencePiece tokens (▁ character is 0xE2 0x96 0x81 in UTF-8)
+        if (token.length() >= 3 && 
+            (unsigned char)token[0] == 0xE2 && 
+            (unsigned char)token[1] == 0x96 && 
+            (unsigned char)token[2] == 0x81) {
+            result += " " + token.substr(3);  // Remove ▁ and add space
+        } else {
+            result += token;
         }
-        
-        prev_token = max_idx;
     }
     
-    // Trim leading/trailing spaces
-    if (!result.empty() && result[0] == ' ') {
+    // Trim the leading space of the stream's first word only, so deltas
+    // concatenate into the full transcript
+    if (!decode_.text_emitted && !result.empty() && result[0] == ' ') {
         result = result.substr(1);
     }
-    
+    if (!result.empty()) {
+        decode_.text_emitted = true;
+    }
     return result;
 }
 
+std::map<std::string, double> NeMoCTCImpl::getStats() const {
+    std::map<std::string, double> stats;
+    stats["frames_decoded"] = static_cast<double>(frames_decoded_);
+    stats["frames_blank_skipped"] = static_cast<double>(frames_skipped_);
+    stats["decode_us"] = static_cast<double>(decode_us_);
+    stats["beam_size"] = static_cast<double>(beam_size_);
+    
+    // Buffered streaming: encoder input per second of decoded audio is
+    // (left + chunk + right) / chunk once the left context has filled
+    stats["buffered_chunk_ms"] = static_cast<double>(chunk_frames_ * kMsPerFeatureFrame);
+    stats["buffered_left_context_ms"] = static_cast<double>(left_frames_ * kMsPerFeatureFrame);
+    stats["buffered_right_context_ms"] = static_cast<double>(right_frames_ * kMsPerFeatureFrame);
+    stats["buffered_windows"] = static_cast<double>(windows_encoded_);
+    stats["buffered_encode_ratio"] = frames_consumed_ > 0 ?
+        static_cast<double>(window_frames_encoded_) / static_cast<double>(frames_consumed_) : 0.0;
+    return stats;
+}
+
 std::string NeMoCTCImpl::getModelInfo() const {
     if (!initialized_) {
         return "Model not initialized";
@@ -315,28 +627,28 @@ std::string NeMoCTCImpl::getModelInfo() const {
     
     std::stringstream info;
     info << "NeMo CTC Model Info:\n";
-    info << "Inputs: " << input_names_.size() << "\n";
-    for (size_t i = 0; i < input_names_.size(); i++) {
-        info << "  " << input_names_[i] << ": [";
-        for (size_t j = 0; j < input_shapes_[i].size(); j++) {
+    info << "Inputs: " << model_->input_names.size() << "\n";
+    for (size_t i = 0; i < model_->input_names.size(); i++) {
+        info << "  " << model_->input_names[i] << ": [";
+        for (size_t j = 0; j < model_->input_shapes[i].size(); j++) {
             if (j > 0) info << ", ";
-            info << input_shapes_[i][j];
+            info << model_->input_shapes[i][j];
         }
         info << "]\n";
     }
     
-    info << "Outputs: " << output_names_.size() << "\n";
-    for (size_t i = 0; i < output_names_.size(); i++) {
-        info << "  " << output_names_[i] << ": [";
-        for (size_t j = 0; j < output_shapes_[i].size(); j++) {
+    info << "Outputs: " << model_->output_names.size() << "\n";
+    for (size_t i = 0; i < model_->output_names.size(); i++) {
+        info << "  " << model_->output_names[i] << ": [";
+        for (size_t j = 0; j < model_->output_shapes[i].size(); j++) {
             if (j > 0) info << ", ";
-            info << output_shapes_[i][j];
+            info << model_->output_shapes[i][j];
         }
         info << "]\n";
     }
     
-    info << "Vocabulary size: " << vocab_.size() << "\n";
-    info << "Blank token ID: " << blank_id_;
+    info << "Vocabulary size: " << model_->vocab.size() << "\n";
+    info << "Blank token ID: " << model_->blank_id;
     
     return info.str();
 }
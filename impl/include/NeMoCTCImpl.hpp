@@ -5,50 +5,122 @@
 #include <string>
 #include <memory>
 #include <unordered_map>
+#include <map>
+#include <mutex>
 #include "KaldiFbankFeatureExtractor.hpp"
 #include "NeMoCTCInterface.hpp"
+#include "OrtRuntime.hpp"
+#include "CTCPrefixBeamSearch.hpp"
 
 class NeMoCTCImpl : public NeMoCTCInterface {
 public:
+    // Loaded session, I/O metadata and vocabulary; immutable and shared by all
+    // instances using the same model and tokens files in this process
+    struct SharedModel {
+        std::shared_ptr<Ort::Session> session;  // from the OrtRuntime registry
+        std::string model_path;
+        std::vector<std::string> input_names;
+        std::vector<std::string> output_names;
+        std::vector<std::vector<int64_t>> input_shapes;
+        std::vector<std::vector<int64_t>> output_shapes;
+        std::unordered_map<int, std::string> vocab;
+        int blank_id = -1;
+    };
+    
     NeMoCTCImpl();
+    explicit NeMoCTCImpl(std::shared_ptr<const SharedModel> model);
     ~NeMoCTCImpl();
     
-    // Initialize with CTC model and tokens
+    void setOptimizedModelCache(bool enable) override { session_config_.cache_optimized_model = enable; }
+    void setMemoryMappedModel(bool enable) override { session_config_.memory_map = enable; }
+    void setQuantizedEncoder(bool enable) override { quantized_encoder_ = enable; }
+    void setBlankSkipThreshold(float threshold) override { blank_skip_threshold_ = threshold; }
+    void setBeamSearch(int beam_size, int max_candidates_per_frame) override;
+    void setBufferedStreaming(int left_context_ms, int chunk_ms, int right_context_ms) override;
+    
+    // Initialize with CTC model and tokens (reuses an already loaded copy)
     bool initialize(const std::string& model_path, const std::string& tokens_path) override;
     
+    bool warmUp(int duration_ms) override;
+    
+    std::unique_ptr<NeMoCTCInterface> createStream() const override;
+    
     // Process audio and return transcription
     std::string transcribe(const std::vector<float>& audio_samples) override;
     
+    // Streaming: decoder state carries across chunks, only final text is returned
+    std::string transcribeChunk(const std::vector<float>& audio_samples) override;
+    std::string flushStream() override;
+    
     // Get model info
     std::string getModelInfo() const override;
     bool isInitialized() const override { return initialized_; }
+    std::map<std::string, double> getStats() const override;
     
 private:
-    // ONNX Runtime components
-    std::unique_ptr<Ort::Env> env_;
-    std::unique_ptr<Ort::Session> session_;
-    std::unique_ptr<Ort::SessionOptions> session_options_;
+    // Shared model; everything below is per instance
+    std::shared_ptr<const SharedModel> model_;
     std::unique_ptr<Ort::MemoryInfo> memory_info_;
     
-    // Model metadata
-    std::vector<std::string> input_names_;
-    std::vector<std::string> output_names_;
-    std::vector<std::vector<int64_t>> input_shapes_;
-    std::vector<std::vector<int64_t>> output_shapes_;
-    
-    // Vocabulary
-    std::unordered_map<int, std::string> vocab_;
-    int blank_id_;
-    
     // State
     bool initialized_;
+    onnx_stt::OrtRuntime::SessionConfig session_config_;
+    bool quantized_encoder_;
+    
+    // Prefix beam search (beam_size_ 1: greedy)
+    int beam_size_;
+    int max_candidates_per_frame_;
+    
+    // Decoder state carried across chunks of a stream. transcribe() decodes
+    // its utterance on a state of its own, so a stream in progress survives it.
+    struct DecodeState {
+        int prev_token = -1;                // greedy: last frame's argmax
+        std::vector<int> pending_tokens;    // greedy: decoded, not yet returned
+        size_t tokens_emitted = 0;          // tokens already returned as text
+        bool text_emitted = false;          // stream has produced text (keep word spaces)
+        std::unique_ptr<onnx_stt::CTCPrefixBeamSearch> beam_search;  // created on first decode
+    };
+    DecodeState decode_;
+    
+    // Stream features from the streaming extractor, [frames, 80]. Unbuffered
+    // chunks encode whatever is pending; buffered streaming (chunk_frames_ 0:
+    // off) keeps the left context before decoded_until_ up to the newest frame.
+    // Sizes are in 10 ms feature frames.
+    onnx_stt::FeatureMatrix stream_frames_;
+    size_t frames_offset_;              // stream frame index of stream_frames_ frame 0
+    size_t left_frames_;
+    size_t chunk_frames_;
+    size_t right_frames_;
+    size_t decoded_until_;              // stream frame up to which the CTC output is decoded
+    uint64_t windows_encoded_;
+    uint64_t window_frames_encoded_;    // encoder input, overlap included
+    uint64_t frames_consumed_;
+    
+    // Blank skipping and decoder counters
+    float blank_skip_threshold_;
+    uint64_t frames_decoded_;
+    uint64_t frames_skipped_;
+    uint64_t decode_us_;
     
     // Feature extractor
     KaldiFbankFeatureExtractor feature_extractor_;
     
     // Helper methods
-    bool loadVocabulary(const std::string& tokens_path);
+    static std::shared_ptr<const SharedModel> loadSharedModel(const std::string& model_path,
+                                                             const std::string& tokens_path,
+                                                             const onnx_stt::OrtRuntime::SessionConfig& session_config);
+    static bool loadVocabulary(const std::string& tokens_path, SharedModel& model);
     std::vector<float> extractMelFeatures(const std::vector<float>& audio_samples);
     std::vector<float> loadWorkingFeatures(const std::string& filename);
+    std::vector<float> runInference(std::vector<float>& mel_features, int n_frames,
+                                    std::vector<int64_t>& logits_shape);
     std::string ctcDecode(const std::vector<float>& logits, const std::vector<int64_t>& shape);
+    void resetDecoder();
+    void decodeFrames(const float* logits, int time_steps, int vocab_size);
+    void runBufferedWindows(bool final);
+    void runPendingFrames(bool final);
+    std::vector<float> encodeFrames(size_t begin, size_t count, std::vector<int64_t>& logits_shape);
+    std::vector<int> takeStableTokens();
+    std::vector<int> takeFinalTokens();
+    std::string tokensToText(const std::vector<int>& tokens);
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <map>
 
 /**
  * Pure interface for NeMo CTC speech recognition that completely hides ONNX Runtime headers
@@ -13,15 +14,62 @@ class NeMoCTCInterface {
 public:
     virtual ~NeMoCTCInterface() = default;
     
+    // Save the optimized graph next to the model on first load and reuse it on
+    // later loads (call before initialize)
+    virtual void setOptimizedModelCache(bool enable) = 0;
+    
+    // Map ORT-format models read-only so processes on a host share the weights
+    // (call before initialize)
+    virtual void setMemoryMappedModel(bool enable) = 0;
+    
+    // Load the INT8 variant <model>.int8.onnx of the CTC model (call before initialize)
+    virtual void setQuantizedEncoder(bool enable) = 0;
+    
+    // Frames whose blank posterior exceeds threshold are taken as blank without
+    // searching them (0: off; values >= 0.5 leave greedy output unchanged)
+    virtual void setBlankSkipThreshold(float threshold) = 0;
+    
+    // Decode with a CTC prefix beam search keeping beam_size prefixes and
+    // expanding at most max_candidates_per_frame tokens per frame (1: greedy)
+    virtual void setBeamSearch(int beam_size, int max_candidates_per_frame) = 0;
+    
+    // Buffered streaming for models trained without chunking: transcribeChunk()
+    // buffers the stream's features and encodes overlapping windows of left
+    // context + chunk + right lookahead, decoding only each chunk's frames. Text
+    // for a chunk is returned once its lookahead has arrived. Sizes are rounded
+    // up to 80 ms (one encoder frame); chunk_ms 0 encodes the new frames of
+    // every transcribeChunk() call alone.
+    virtual void setBufferedStreaming(int left_context_ms, int chunk_ms, int right_context_ms) = 0;
+    
     // Initialize with CTC model and tokens paths
     virtual bool initialize(const std::string& model_path, const std::string& tokens_path) = 0;
     
+    // Run a silent chunk of duration_ms through the model so lazy kernel
+    // initialization happens before the first real audio
+    virtual bool warmUp(int duration_ms) = 0;
+    
     // Process audio samples and return transcription
     virtual std::string transcribe(const std::vector<float>& audio_samples) = 0;
     
+    // Streaming: decode the next chunk of a stream, carrying the decoder state
+    // (previous token, beam) over from the last chunk, and return only text
+    // that became final since the last call; the returned pieces concatenate
+    // into the transcript. transcribe() in between leaves the stream as it was.
+    virtual std::string transcribeChunk(const std::vector<float>& audio_samples) = 0;
+    
+    // Streaming: return the text still held back and start a new stream
+    virtual std::string flushStream() = 0;
+    
     // Get model info
     virtual std::string getModelInfo() const = 0;
     virtual bool isInitialized() const = 0;
+    
+    // Decoder counters: frames decoded, frames skipped as blank, decode time
+    virtual std::map<std::string, double> getStats() const = 0;
+    
+    // Create another initialized instance sharing this one's loaded model
+    // (nullptr if not initialized)
+    virtual std::unique_ptr<NeMoCTCInterface> createStream() const = 0;
 };
 
 // Factory function - implementation in .cpp file to hide ONNX dependencies
@@ -2,8 +2,12 @@
 #define NEMO_CACHE_AWARE_CONFORMER_HPP
 
 #include "ModelInterface.hpp"
+#include "BatchModel.hpp"
 #include "CacheManager.hpp"
+#include "FeatureRing.hpp"
+#include "OrtRuntime.hpp"
 #include <onnxruntime_cxx_api.h>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -22,82 +26,230 @@ namespace onnx_stt {
  * - Output: encoded features + updated cache tensors
  * - Cache: last_channel_cache, last_time_cache
  * 
+ * Incoming frames go through a FeatureRing: the encoder sees chunks of
+ * pre_encode_cache_frames from the previous chunk plus a step that is a
+ * multiple of subsampling_factor, and frames short of a step wait for the
+ * next call. flush() pads and encodes what is left at end of stream.
+ * first_chunk_frames and chunk_ramp shorten the first chunks of a stream.
+ * 
  * Supported Models:
  * - stt_en_fastconformer_hybrid_large_streaming_multi (114M params)
  * - Custom NeMo cache-aware models exported with cache_support=True
  */
-class NeMoCacheAwareConformer : public ModelInterface {
+class NeMoCacheAwareConformer : public ModelInterface, public BatchModel {
 public:
     struct NeMoConfig {
         std::string model_path;
-        int num_threads = 4;
+        int num_threads = 4;            // only used if the session opts out of the global pools
         int batch_size = 1;
         int feature_dim = 80;           // 80-dim log-mel features
-        int chunk_frames = 160;         // Recommended: divisible by 4, gives 40 frames after subsampling
+        int chunk_frames = 160;         // Encoder input frames per chunk, pre-encode context included
         int last_channel_cache_size = 64;  // Configurable cache size
         int last_time_cache_size = 64;
         int num_cache_layers = 12;      // Number of layers with caching
         int hidden_size = 512;          // Model hidden dimension
         
+        // Chunks advance by a multiple of the subsampling factor and start with
+        // the last pre-encode cache frames of the previous chunk (-1: factor + 1)
+        int subsampling_factor = 8;
+        int pre_encode_cache_frames = -1;
+        float feature_pad_value = 0.0f;  // features before the first frame and after the last
+        
+        // Time to first token: the first chunk of a stream takes first_chunk_frames
+        // new frames (0: a full step) and the next chunk_ramp chunks grow evenly
+        // from there to the full step
+        int first_chunk_frames = 0;
+        int chunk_ramp = 0;
+        
         // Attention context configuration (affects latency)
-        // [70,0]: 0ms, [70,1]: 80ms, [70,16]: 480ms, [70,33]: 1040ms
+        // [70,0]: 0ms, [70,1]: 80ms, [70,6]: 480ms, [70,13]: 1040ms
         int att_context_size_left = 70;
         int att_context_size_right = 0;  // 0ms latency by default
         
         // Vocabulary file path for token decoding
         std::string vocab_path = "";
+        
+        // Run through Ort::IoBinding with preallocated, ping-ponged cache buffers
+        // (false: plain Run() with the model's cache outputs copied back per chunk)
+        bool use_io_binding = true;
+        
+        // Save the optimized graph next to the model and reuse it on later loads
+        bool cache_optimized_model = false;
+        
+        // Map ORT-format models read-only so PEs on a host share the weights
+        bool memory_map_model = false;
+        
+        // Load the INT8 variant <model>.int8.onnx (encoder and its heads are one file)
+        bool quantized_encoder = false;
+        
+        // Specialize the session to the fixed chunk shape (free time dimension
+        // pinned); falls back to the dynamic-shape session if the model has no
+        // named free dimensions
+        bool fixed_shape_encoder = false;
+        
+        // Frames whose blank posterior exceeds this are taken as blank without
+        // scanning the other classes (0: off; any value >= 0.5 leaves greedy
+        // output unchanged)
+        float blank_skip_threshold = 0.0f;
+    };
+
+    // Per-stream state owned by the caller when several streams share this
+    // model through processBatch()
+    using StreamCache = onnx_stt::StreamCache;
+    using BatchEntry = onnx_stt::BatchEntry;
+
+    /**
+     * Immutable part of a loaded model: session, I/O metadata and vocabulary.
+     * Shared by every stream created from it (Ort::Session::Run is thread-safe),
+     * so an additional stream only costs its own cache and I/O buffers.
+     */
+    struct SharedModel {
+        std::shared_ptr<Ort::Session> session;  // from the OrtRuntime registry
+        
+        // Model input/output names, read from the session once at load
+        std::vector<std::string> input_name_storage;
+        std::vector<std::string> output_name_storage;
+        std::vector<const char*> input_names;
+        std::vector<const char*> output_names;
+        
+        // Positions of the known tensors in input_names/output_names (-1 = absent)
+        int audio_input_index = -1;
+        int length_input_index = -1;
+        int channel_cache_input_index = -1;
+        int time_cache_input_index = -1;
+        int channel_len_input_index = -1;
+        int logits_output_index = -1;
+        int channel_cache_output_index = -1;
+        int time_cache_output_index = -1;
+        int channel_len_output_index = -1;
+        
+        int64_t model_batch_dim = 1;        // audio input batch dimension (-1 = dynamic)
+        int64_t model_time_dim = -1;        // audio input time dimension (-1 = dynamic)
+        bool fixed_shape = false;           // session specialized to the chunk shape
+        
+        // Cache shapes of one stream (empty if the model has no cache inputs)
+        std::vector<int64_t> channel_cache_shape;
+        std::vector<int64_t> time_cache_shape;
+        int cache_batch_axis = 1;           // batch dimension of the cache tensors
+        
+        // Vocabulary for token decoding
+        std::vector<std::string> vocabulary;
+        bool vocab_loaded = false;
     };
 
+    // Load the shared part once; returns nullptr on failure
+    static std::shared_ptr<const SharedModel> loadSharedModel(const NeMoConfig& config);
+
     explicit NeMoCacheAwareConformer(const NeMoConfig& config);
+    
+    // Stream over an already loaded model (initialize() skips loading)
+    NeMoCacheAwareConformer(const NeMoConfig& config, std::shared_ptr<const SharedModel> model);
     virtual ~NeMoCacheAwareConformer();
 
     // ModelInterface implementation
     bool initialize(const ModelConfig& config) override;
     ModelInterface::TranscriptionResult processChunk(const std::vector<std::vector<float>>& features,
                                                     uint64_t timestamp_ms) override;
+    ModelInterface::TranscriptionResult processChunk(const FeatureView& features,
+                                                    uint64_t timestamp_ms) override;
     void reset() override;
     std::map<std::string, double> getStats() const override;
     bool supportsStreaming() const override { return true; }
     int getFeatureDim() const override { return config_.feature_dim; }
-    int getChunkFrames() const override { return config_.chunk_frames; }
+    int getChunkFrames() const override { return static_cast<int>(feature_ring_.stepFrames()); }
     const ModelConfig& getConfig() const override { return model_config_; }
+    std::unique_ptr<ModelInterface> createStream() const override;
+    
+    // End of stream: encode the frames still buffered (the only padded chunk)
+    // and start the next stream with fresh context
+    ModelInterface::TranscriptionResult flush(uint64_t timestamp_ms) override;
+    
+    const std::shared_ptr<const SharedModel>& getSharedModel() const { return model_; }
+    
+    // Cross-stream batching: each stream's frames go through its own ring
+    // (chunked exactly as processChunk() does), and each round of complete
+    // windows is one encoder call with the caches gathered along the cache
+    // batch axis and scattered back afterwards. Not thread-safe; one caller
+    // (the scheduler) at a time.
+    bool processBatch(std::vector<BatchEntry>& entries) override;
+    StreamCache createStreamCache() const override;
+    void resetStreamCache(StreamCache& cache) const override;
+    
+    // Largest batch the exported model accepts (1 if its batch dimension is fixed)
+    int getMaxBatchSize() const override;
 
 private:
     NeMoConfig config_;
     ModelConfig model_config_;
     
-    // ONNX Runtime components
-    std::unique_ptr<Ort::Env> env_;
-    std::unique_ptr<Ort::Session> session_;
+    // Shared model (session, metadata, vocabulary); everything below is per stream
+    std::shared_ptr<const SharedModel> model_;
     Ort::MemoryInfo memory_info_;
     
-    // Cache management
-    std::unique_ptr<CacheManager> cache_manager_;
+    // Reused [batch, time, features] input buffer (no per-chunk allocation)
+    std::vector<float> audio_signal_buffer_;
+    std::vector<int64_t> length_buffer_;
+    size_t input_frames_;  // time dimension of audio_signal_buffer_
     
-    // Model input/output names
-    std::vector<const char*> input_names_;
-    std::vector<const char*> output_names_;
+    // Frames waiting for a full subsampling-aligned chunk, plus the pre-encode context
+    FeatureRing feature_ring_;
     
-    // Cache tensors for streaming
-    std::vector<float> cache_last_channel_;
-    std::vector<float> cache_last_time_;
+    // Ping-pong cache buffers: slot cache_slot_ holds the cache fed to the next
+    // chunk, the other slot receives the model's updated cache
+    std::vector<float> cache_last_channel_[2];
+    std::vector<float> cache_last_time_[2];
+    std::vector<int64_t> cache_last_channel_len_[2];
+    int cache_slot_;
     bool cache_initialized_;
     
+    // IoBinding mode: one binding per ping-pong parity, bound once. Logits are
+    // bound to a persistent buffer once their shape is known from the first run.
+    std::unique_ptr<Ort::IoBinding> io_bindings_[2];
+    std::vector<float> logits_buffer_;
+    std::vector<int64_t> logits_shape_;
+    bool logits_bound_;
+    
+    // Cross-stream batch scratch (grows to the largest batch seen)
+    std::vector<float> batch_audio_;
+    std::vector<int64_t> batch_length_;
+    std::vector<float> batch_channel_cache_;
+    std::vector<float> batch_time_cache_;
+    std::vector<int64_t> batch_channel_len_;
+    
     // Statistics
     mutable uint64_t total_chunks_processed_;
     mutable uint64_t total_processing_time_ms_;
     mutable uint64_t cache_updates_;
+    uint64_t last_chunk_latency_us_;
+    uint64_t total_chunk_latency_us_;
+    uint64_t ort_output_allocations_;   // output tensors allocated by ORT during Run
+    uint64_t cache_bytes_copied_;       // cache bytes copied back from outputs
+    uint64_t ctc_frames_;               // frames through decodeCTCTokens
+    uint64_t ctc_frames_skipped_;       // of which taken as blank by the threshold
+    uint64_t ctc_decode_us_;            // time spent in decodeCTCTokens
+    uint64_t padded_frames_;            // pad frames encoded (end-of-stream chunks only)
     
-    // Vocabulary for token decoding
-    std::vector<std::string> vocabulary_;
-    bool vocab_loaded_;
+    // Time to first token: from a stream's first frame to its first non-empty
+    // text (wall clock), and the audio received by then. Kept for the last
+    // stream that produced text; -1 before any did.
+    std::chrono::steady_clock::time_point stream_start_;
+    uint64_t stream_frames_;            // frames received in the current stream
+    bool first_token_seen_;             // current stream has produced text
+    double first_token_ms_;
+    double first_token_audio_ms_;
     
     // Private methods
-    bool initializeONNXSession();
+    static bool initializeONNXSession(const NeMoConfig& config, SharedModel& model);
+    static bool loadVocabulary(const std::string& vocab_path, SharedModel& model);
     bool initializeCacheTensors();
-    bool loadVocabulary(const std::string& vocab_path);
-    std::vector<Ort::Value> prepareCacheInputs();
+    bool initializeIoBindings();
+    std::vector<Ort::Value> prepareInputs(int slot, size_t time_frames);
     void updateCacheFromOutputs(std::vector<Ort::Value>& outputs);
+    void bindLogitsOutput();
+    bool runWithIoBinding(const float*& logits, std::vector<int64_t>& logits_shape);
+    std::string encodeWindow(size_t window_frames);
+    void runBatchRound(std::vector<BatchEntry>& entries, const std::vector<size_t>& round);
+    void noteText(const std::string& text);
     std::string decodeTokens(const float* logits, size_t logits_size);
     std::string decodeCTCTokens(const float* log_probs, int64_t seq_len, int64_t num_classes);
     void updateStats(uint64_t processing_time_ms) const;
@@ -3,9 +3,10 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <map>
 #include <onnxruntime_cxx_api.h>
 #include "ModelInterface.hpp"
-#include "FeatureExtractor.hpp"
+#include "ImprovedFbank.hpp"
 
 namespace onnx_stt {
 
@@ -19,17 +20,33 @@ namespace onnx_stt {
  * Model: nvidia/stt_en_fastconformer_hybrid_large_streaming_multi
  * Architecture: 17-layer FastConformer encoder (512 d_model) + Hybrid decoders
  * Features: Cache-aware streaming, chunked attention, multi-latency support
+ * 
+ * The model is trained for several right contexts (att_context_size [70,R]
+ * with R = 0, 1, 6, 13 encoder frames). Each one is a separate ONNX export
+ * (see export_nemo_cache_aware_onnx.py) named
+ * fastconformer_ctc_cache_aware_<latency>ms.onnx in the model directory.
+ * All of them share the 70-frame left context, so the cache_last_channel,
+ * cache_last_time and cache_last_channel_len tensors have the same shape in
+ * every mode and setLatencyMode() can switch exports in the middle of a stream.
+ * 
+ * Each chunk is prefixed with the last pre-encode cache frames of the
+ * previous chunk (log-zero padding before the first one), as in NeMo's
+ * CacheAwareStreamingAudioBuffer, so every chunk, the first included, is
+ * SUBSAMPLING * (R + 1) mel frames and yields R + 1 encoder frames.
  */
 class NeMoCacheAwareStreaming : public ModelInterface {
 public:
     /**
      * @brief Streaming latency configurations
+     *
+     * Each value is the mode's right context in encoder frames
+     * (att_context_size[1]); one frame is 80 ms of audio.
      */
     enum class LatencyMode {
-        ULTRA_LOW = 0,    // 0ms latency (fully causal)
-        VERY_LOW = 1,     // 80ms latency 
-        LOW = 16,         // 480ms latency
-        MEDIUM = 33       // 1040ms latency
+        ULTRA_LOW = 0,    // [70,0]: 0ms latency (fully causal)
+        VERY_LOW = 1,     // [70,1]: 80ms latency
+        LOW = 6,          // [70,6]: 480ms latency
+        MEDIUM = 13       // [70,13]: 1040ms latency
     };
     
     /**
@@ -48,44 +65,88 @@ private:
     static constexpr int D_MODEL = 512;
     static constexpr int N_LAYERS = 17;
     static constexpr int VOCAB_SIZE = 1024;
+    static constexpr int SUBSAMPLING = 8;            // mel frames per encoder frame
+    static constexpr int LEFT_CONTEXT = 70;          // att_context_size[0], all modes
+    static constexpr int CONV_CACHE = 8;             // conv_kernel_size - 1
+    static constexpr int PRE_ENCODE_CACHE = SUBSAMPLING + 1;  // mel frames carried into the next chunk
+    static constexpr int DROP_PRE_ENCODED = 2;       // encoder frames the export drops per chunk
+    
+    // One export of the encoder (with its CTC head) for one right context
+    struct EncoderSession {
+        std::shared_ptr<Ort::Session> session;  // from the OrtRuntime registry
+        std::string path;
+        std::vector<std::string> input_names;
+        std::vector<std::string> output_names;
+        int audio_input = -1;
+        int length_input = -1;
+        int channel_input = -1;
+        int time_input = -1;
+        int channel_len_input = -1;
+        int output = -1;             // log-probs, or encoder states for ctc_decoder_session_
+        int length_output = -1;
+        int channel_output = -1;
+        int time_output = -1;
+        int channel_len_output = -1;
+        bool outputs_log_probs = false;
+        std::vector<int64_t> channel_shape;  // cache_last_channel, batch 1
+        std::vector<int64_t> time_shape;     // cache_last_time, batch 1
+    };
+    
+    // Loaded exports keyed by right context (encoder frames); loaded on first use
+    std::map<int, std::shared_ptr<EncoderSession>> encoders_;
+    std::shared_ptr<EncoderSession> encoder_;
     
-    // ONNX Runtime components
-    std::unique_ptr<Ort::Env> ort_env_;
-    std::unique_ptr<Ort::Session> encoder_session_;
-    std::unique_ptr<Ort::Session> ctc_decoder_session_;
-    std::unique_ptr<Ort::Session> rnnt_decoder_session_;
+    // Separate CTC head for exports whose output is the encoder states
+    std::shared_ptr<Ort::Session> ctc_decoder_session_;
+    std::vector<std::string> ctc_input_names_;
+    std::vector<std::string> ctc_output_names_;
+    
+    std::unique_ptr<Ort::MemoryInfo> memory_info_;
     
     // Model state and caching
     LatencyMode latency_mode_;
     DecoderType decoder_type_;
+    std::string model_dir_;
+    bool initialized_;
     
-    // Cache management for streaming
+    // Cache-aware streaming state carried between chunks
     struct StreamingCache {
-        std::vector<std::vector<float>> encoder_states;  // Layer-wise hidden states
-        std::vector<std::vector<float>> attention_cache; // Attention cache for each layer
-        std::vector<float> prediction_cache;             // RNN-T prediction network cache
-        int processed_frames;                            // Number of processed audio frames
-        int context_size;                                // Current context size based on latency
+        std::vector<float> cache_last_channel;        // [batch, layers, LEFT_CONTEXT, d_model]
+        std::vector<float> cache_last_time;           // [batch, layers, d_model, CONV_CACHE]
+        std::vector<int64_t> cache_last_channel_len;  // [batch]
+        std::vector<float> pre_encode;                // last PRE_ENCODE_CACHE mel frames, [frames, N_MELS]
+        std::vector<float> pending;                   // mel frames not yet encoded, [frames, N_MELS]
+        std::vector<float> pending_audio;             // samples short of the next mel frame
+        int processed_frames;                         // mel frames encoded so far
+        int chunks;                                   // chunks encoded so far
+        int prev_token;                               // CTC: last frame's argmax
+        bool text_emitted;                            // stream has produced text
     };
     
     std::unique_ptr<StreamingCache> cache_;
     
-    // Feature extraction
-    std::unique_ptr<FeatureExtractor> feature_extractor_;
+    // Feature extraction (log-mel, NeMo preprocessor settings, no normalization)
+    std::unique_ptr<improved_fbank::FbankComputer> feature_extractor_;
     
     // Vocabulary and tokenization
     std::vector<std::string> vocabulary_;
+    bool word_piece_vocab_;    // "##" marks word continuations instead of "▁" marking starts
+    int blank_id_;
     std::string unk_token_ = "<unk>";
     std::string blank_token_ = "<blank>";
     
     // Streaming configuration
-    int chunk_size_;           // Audio chunk size based on latency mode
-    int context_frames_;       // Look-ahead frames for attention
+    int lookahead_frames_;     // right context R in encoder frames
+    int chunk_frames_;         // mel frames per chunk, SUBSAMPLING * (R + 1)
     float confidence_threshold_ = 0.3f;
     
+    // Timing
+    double total_processing_ms_;
+    double last_chunk_ms_;
+    
     // Model configuration
     ModelConfig config_;
-    
+
 public:
     /**
      * @brief Constructor
@@ -93,7 +154,7 @@ public:
      * @param latency_mode Desired latency configuration
      * @param decoder_type Decoder type to use
      */
-    NeMoCacheAwareStreaming(const std::string& model_dir, 
+    NeMoCacheAwareStreaming(const std::string& model_dir,
                            LatencyMode latency_mode = LatencyMode::LOW,
                            DecoderType decoder_type = DecoderType::CTC);
     
@@ -110,8 +171,12 @@ public:
     /**
      * @brief Process audio features
      */
-    TranscriptionResult processChunk(const std::vector<std::vector<float>>& features, 
+    TranscriptionResult processChunk(const std::vector<std::vector<float>>& features,
                                    uint64_t timestamp_ms) override;
+    using ModelInterface::processChunk;  // contiguous FeatureView overload
+    
+    // End of stream: decode the queued frames as the final chunk
+    TranscriptionResult flush(uint64_t timestamp_ms) override;
     
     /**
      * @brief Reset streaming state and cache
@@ -145,16 +210,20 @@ public:
     
     // Legacy compatibility methods
     bool initialize();
-    std::string processAudioChunk(const float* audio_chunk, 
-                                 int chunk_size, 
+    std::string processAudioChunk(const float* audio_chunk,
+                                 int chunk_size,
                                  bool is_final = false);
     std::string getModelInfo() const;
     
     /**
      * @brief Set latency mode (affects chunk size and context)
+     * 
+     * Switches to the export for the mode's att_context_size, loading it on
+     * first use. The caches carry over, so this can be called mid-stream.
      * @param mode New latency mode
+     * @return false if the mode's export cannot be loaded (mode unchanged)
      */
-    void setLatencyMode(LatencyMode mode);
+    bool setLatencyMode(LatencyMode mode);
     
     /**
      * @brief Set decoder type
@@ -173,64 +242,73 @@ public:
     };
     
     StreamingStats getStreamingStats() const;
-
-private:
+    
     /**
-     * @brief Load ONNX model sessions
+     * @brief Right context (encoder frames) of a latency mode
      */
-    bool loadONNXModels(const std::string& model_dir);
+    static int lookaheadFrames(LatencyMode mode);
     
     /**
-     * @brief Load vocabulary from file
+     * @brief Mel frames per chunk in a latency mode, SUBSAMPLING * (R + 1)
      */
-    bool loadVocabulary(const std::string& vocab_file);
+    static int chunkFrames(LatencyMode mode);
     
     /**
-     * @brief Configure streaming parameters based on latency mode
+     * @brief Encoder frames one chunk yields: its window (pre-encode cache
+     * plus chunk) subsampled, less the frames the export drops (R + 1)
      */
-    void configureLatencyMode();
+    static int encoderFramesPerChunk(LatencyMode mode);
     
     /**
-     * @brief Extract mel-spectrogram features from audio
+     * @brief Export file for a latency mode
      */
-    std::vector<std::vector<float>> extractFeatures(const float* audio, int length);
+    static std::string encoderFileName(LatencyMode mode);
+
+private:
+    /**
+     * @brief Load (or reuse) the export for a right context
+     */
+    std::shared_ptr<EncoderSession> loadEncoder(int lookahead);
     
     /**
-     * @brief Run encoder with cache management
+     * @brief Load the standalone CTC head, if the model directory has one
      */
-    std::vector<std::vector<float>> runEncoder(const std::vector<std::vector<float>>& features);
+    bool loadCTCDecoder(const std::string& path);
     
     /**
-     * @brief Run CTC decoder
+     * @brief Load vocabulary from file
      */
-    std::string runCTCDecoder(const std::vector<std::vector<float>>& encoder_output);
+    bool loadVocabulary(const std::string& vocab_file);
     
     /**
-     * @brief Run RNN-T decoder with prediction network caching
+     * @brief Configure streaming parameters based on latency mode
      */
-    std::string runRNNTDecoder(const std::vector<std::vector<float>>& encoder_output);
+    void configureLatencyMode();
     
     /**
-     * @brief Decode token IDs to text using vocabulary
+     * @brief Zeroed caches for a new stream
      */
-    std::string decodeTokens(const std::vector<int>& token_ids);
+    void resetCache();
     
     /**
-     * @brief Update encoder cache with new states
+     * @brief Append mel frames ([frames, N_MELS]) and encode every complete chunk
      */
-    void updateEncoderCache(const std::vector<std::vector<float>>& new_states);
+    std::string acceptFeatures(const float* frames, size_t num_frames, bool is_final);
     
     /**
-     * @brief Get appropriate context size for current latency mode
+     * @brief Run the encoder on one chunk of mel frames with the streaming caches
      */
-    int getContextSize() const;
+    std::string runEncoderChunk(const float* frames, int num_frames);
     
     /**
-     * @brief Apply cache-aware attention mechanism
+     * @brief Greedy CTC over [frames, classes] log-probs, continuing the stream
      */
-    std::vector<std::vector<float>> applyCacheAwareAttention(
-        const std::vector<std::vector<float>>& inputs,
-        int layer_idx);
+    std::string runCTCDecoder(const float* log_probs, int frames, int classes);
+    
+    /**
+     * @brief Decode token IDs to text using vocabulary
+     */
+    std::string decodeTokens(const std::vector<int>& token_ids);
 };
 
 /**
@@ -242,4 +320,4 @@ std::unique_ptr<NeMoCacheAwareStreaming> createNeMoCacheAwareModel(
     NeMoCacheAwareStreaming::DecoderType decoder = NeMoCacheAwareStreaming::DecoderType::CTC
 );
 
-} // namespace onnx_stt
\ No newline at end of file
+} // namespace onnx_stt
@@ -10,6 +10,7 @@
 #include <chrono>
 #include "ZipformerRNNT.hpp"
 #include "simple_fbank.hpp"
+#include "AudioPreprocessor.hpp"
 
 namespace onnx_stt {
 
@@ -37,10 +38,19 @@ public:
         // Decoding parameters
         int beam_size = 10;
         int blank_id = 0;
+        std::string decoding_method = "modified_beam_search";  // or "greedy_search" (lowest latency)
+        int max_symbols_per_frame = 1;       // greedy_search: symbols emitted per encoder frame
         
         // Performance tuning
         int num_threads = 4;
         bool use_gpu = false;
+        
+        // Startup
+        bool cache_optimized_model = false;  // save/reuse optimized graphs next to the models
+        bool memory_map_model = false;       // map .ort models read-only, shared between PEs
+        bool quantized_encoder = false;      // INT8 encoder (<encoder>.int8.onnx); decoder/joiner stay FP32
+        bool fixed_shape_encoder = false;    // pin the encoder's free dimensions to the chunk shape
+        int warmup_ms = 0;                   // silent audio run through the model at initialize()
     };
     
     struct TranscriptionResult {
@@ -81,6 +91,7 @@ private:
     std::unique_ptr<simple_fbank::FbankComputer> fbank_;
     
     // Audio buffering for streaming
+    AudioPreprocessor preprocessor_;
     std::vector<float> audio_buffer_;
     std::vector<float> feature_buffer_;
     
@@ -25,8 +25,17 @@ public:
         int frame_shift_ms = 10;
         int beam_size = 10;
         int blank_id = 0;
+        std::string decoding_method = "modified_beam_search";  // or "greedy_search" (lowest latency)
+        int max_symbols_per_frame = 1;       // greedy_search: symbols emitted per encoder frame
         int num_threads = 4;
         bool use_gpu = false;
+        
+        // Startup
+        bool cache_optimized_model = false;  // save/reuse optimized graphs next to the models
+        bool memory_map_model = false;       // map .ort models read-only, shared between PEs
+        bool quantized_encoder = false;      // INT8 encoder (<encoder>.int8.onnx); decoder/joiner stay FP32
+        bool fixed_shape_encoder = false;    // pin the encoder's free dimensions to the chunk shape
+        int warmup_ms = 0;                   // silent audio run through the model at initialize()
     };
     
     struct TranscriptionResult {
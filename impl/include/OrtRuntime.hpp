@@ -0,0 +1,178 @@
+#ifndef ORT_RUNTIME_HPP
+#define ORT_RUNTIME_HPP
+
+#include <onnxruntime_cxx_api.h>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace onnx_stt {
+
+/**
+ * Process-wide ONNX Runtime environment and session registry
+ *
+ * One Ort::Env owns global intra/inter-op thread pools, and sessions are created
+ * with DisablePerSessionThreads(), so all models loaded in a PE share the same
+ * threads instead of each session starting its own pool. Sessions are handed out
+ * by model path and options: asking again for a loaded pair returns the same
+ * session. All sessions share one prepacked-weights container, so kernels
+ * prepacked for a model are not duplicated when it is loaded with other options.
+ *
+ * With cache_optimized_model set, the graph optimized on first load is saved
+ * next to the source model as <model>.<hash>.opt.onnx, where the hash covers the
+ * source contents, the ORT version and the optimization level. Later loads with
+ * a matching hash read that file and skip graph optimization.
+ *
+ * With memory_map set, ORT-format models (.ort) are mapped read-only and the
+ * session uses the initializers in place, so PEs on one host loading the same
+ * file share its pages through the page cache. Combined with the optimized-model
+ * cache, an .onnx model is cached in ORT format and then mapped.
+ *
+ * Sessions with free_dimension_overrides are separate registry entries from the
+ * dynamic-shape session of the same file, one per pinned shape.
+ *
+ * Different models load concurrently: the registry lock is only held to look up
+ * or publish a session, and a second request for a model that is still loading
+ * waits for that load instead of starting another. Each load is timed per phase
+ * (cache hash, session creation, first run) for cold-start analysis.
+ */
+class OrtRuntime {
+public:
+    struct Config {
+        int intra_op_threads = 0;      // global intra-op pool size (0: ORT default, one per core)
+        int inter_op_threads = 1;      // global inter-op pool size
+        bool allow_spinning = false;   // idle pool threads spin instead of sleeping
+    };
+
+    struct SessionConfig {
+        GraphOptimizationLevel optimization_level = GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+        bool use_global_threads = true;  // false: private pool of intra_op_threads
+        int intra_op_threads = 1;
+        bool cache_optimized_model = false;  // save/reuse the optimized graph next to the model
+        bool memory_map = false;             // map .ort models and use their weights in place
+        
+        // Symbolic input dimensions pinned to fixed sizes (AddFreeDimensionOverrideByName),
+        // so ORT can plan memory and pick kernels for the one shape a stream feeds
+        std::map<std::string, int64_t> free_dimension_overrides;
+
+        // Registry key component; sessions with equal keys are shared
+        std::string key() const;
+    };
+
+    // One model of a set loaded together by loadSessions()
+    struct SessionRequest {
+        std::string model_path;
+        SessionConfig options;
+    };
+
+    // Phases of one session load, in milliseconds
+    struct LoadTiming {
+        std::string model_path;
+        double read_ms = 0.0;         // hashing the model file for the optimized model cache
+        double create_ms = 0.0;       // reading, parsing, graph optimization and kernel setup
+        double first_run_ms = -1.0;   // first inference, once reported by the model (-1: not yet)
+        bool optimized_cache_hit = false;
+        bool optimized_cache_written = false;
+        size_t mapped_bytes = 0;      // size of the shared mapping (0: weights copied)
+    };
+
+    // Set the global thread pool sizes. Must be called before the first
+    // instance(); returns false (and changes nothing) once the Env exists.
+    static bool configure(const Config& config);
+
+    static OrtRuntime& instance();
+
+    Ort::Env& env() { return env_; }
+
+    // Shared session for a model file; loaded on first request, released when
+    // the last user drops it. Throws Ort::Exception if the model cannot load.
+    std::shared_ptr<Ort::Session> getSession(const std::string& model_path,
+                                             const SessionConfig& options);
+
+    // Load several sessions in parallel, one thread per model, and return them
+    // in request order. Waits for every load; if any failed, rethrows the first
+    // failure (later requests' sessions are released again).
+    std::vector<std::shared_ptr<Ort::Session>> loadSessions(const std::vector<SessionRequest>& requests);
+
+    // Record the duration of the first inference through a freshly loaded model
+    void recordFirstRun(const std::string& model_path, double first_run_ms);
+
+    // Phase timings of every session loaded so far, in load order
+    std::vector<LoadTiming> getLoadTimings() const;
+
+    // Registry counters plus process thread count and RSS
+    std::map<std::string, double> getStats() const;
+
+    // Threads, VmRSS, VmHWM and the anonymous/file split of RSS (MiB) of this
+    // process, from /proc/self/status
+    static std::map<std::string, double> getProcessStats();
+
+    // Path of the optimized-model cache for a model under the given options
+    // (level, pinned dimensions; ORT format if memory-mapped). "" if the model
+    // cannot be read
+    static std::string optimizedModelPath(const std::string& model_path,
+                                          const SessionConfig& options);
+
+    // Symbolic dimension names of a session input, one per axis ("" for fixed
+    // or unnamed axes)
+    static std::vector<std::string> symbolicDimensions(Ort::Session& session, size_t input_index);
+
+    // Overrides pinning the named free axes of an input to the shape it is fed.
+    // Axis 0 (batch) stays dynamic so streams can still be batched together.
+    static std::map<std::string, int64_t> fixedShapeOverrides(Ort::Session& session, size_t input_index,
+                                                              const std::vector<int64_t>& shape);
+
+    // INT8 variant of a model: <model>.int8.onnx next to it, the name
+    // quantize_encoder.py writes and sherpa-onnx releases use
+    static std::string quantizedModelPath(const std::string& model_path);
+
+    // The model to load: its INT8 variant when quantized is set and that file
+    // exists, otherwise model_path itself (with a warning if quantized was asked for)
+    static std::string selectModel(const std::string& model_path, bool quantized);
+
+private:
+    explicit OrtRuntime(const Config& config);
+    ~OrtRuntime();
+    OrtRuntime(const OrtRuntime&) = delete;
+    OrtRuntime& operator=(const OrtRuntime&) = delete;
+
+    // Registry slot: the live session, or the pending load other callers wait on
+    struct Entry {
+        std::weak_ptr<Ort::Session> session;
+        std::shared_future<std::shared_ptr<Ort::Session>> loading;
+    };
+
+    // Load a session, through the optimized-model cache if enabled. Called
+    // without the mutex; fills in the read and create phases of timing.
+    std::shared_ptr<Ort::Session> createSession(const std::string& model_path,
+                                                const SessionConfig& options,
+                                                LoadTiming& timing);
+
+    // Create a session from one file, mapping it when memory_map is set and the
+    // file is in ORT format
+    std::shared_ptr<Ort::Session> openSession(const std::string& path,
+                                              Ort::SessionOptions& session_options,
+                                              bool memory_map,
+                                              LoadTiming& timing);
+
+    Config config_;
+    Ort::Env env_;
+    OrtPrepackedWeightsContainer* prepacked_weights_;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry> sessions_;
+    std::vector<LoadTiming> load_timings_;
+    uint64_t sessions_created_;
+    uint64_t sessions_reused_;
+    uint64_t optimized_cache_hits_;
+    uint64_t optimized_cache_writes_;
+    double total_load_ms_;
+};
+
+} // namespace onnx_stt
+
+#endif // ORT_RUNTIME_HPP
@@ -4,6 +4,9 @@
 #include <vector>
 #include <cmath>
 #include <cstdlib>
+#include <memory>
+#include "MelFilterbank.hpp"
+#include "AudioPreprocessor.hpp"
 
 /**
  * Simple feature extractor for the proven NeMo implementation
@@ -23,15 +26,22 @@ public:
         int frame_shift
     );
 
+    // Restart the dither sequence (new utterance); otherwise each call
+    // continues the stream where the previous one stopped
+    void reset() { dither_.reset(); }
+
 private:
+    onnx_stt::AudioPreprocessor dither_;
+
     // Librosa-based helper functions
     std::vector<float> extractSTFTFrame(const std::vector<float>& audio_data, 
                                        int center, int n_fft, int win_length);
     std::vector<float> applyWindow(const std::vector<float>& frame, int win_length);
     std::vector<float> computeLibrosaFFT(const std::vector<float>& windowed_frame);
     std::vector<std::vector<float>> createMelFilterbank(int n_mels, int n_fft, int sample_rate);
+    std::shared_ptr<const onnx_stt::MelFilterbank> getMelFilterbank(int n_mels, int n_fft, int sample_rate);
     std::vector<float> applyMelFilterbank(const std::vector<float>& power_spectrum,
-                                         const std::vector<std::vector<float>>& mel_basis);
+                                         const onnx_stt::MelFilterbank& mel_basis);
     
     // Legacy helper functions (for compatibility)
     std::vector<float> applyWindow(const std::vector<float>& frame);
@@ -4,8 +4,14 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <functional>
+#include <unordered_map>
 #include <onnxruntime_cxx_api.h>
 #include "ProvenFeatureExtractor.hpp"
+#include "OrtRuntime.hpp"
 
 /**
  * Proven NeMo Speech-to-Text implementation using validated ONNX models
@@ -16,35 +22,89 @@ public:
     ProvenNeMoSTT();
     ~ProvenNeMoSTT();
 
+    // Save optimized graphs next to the models on first load and reuse them on
+    // later loads (call before initialize)
+    void setOptimizedModelCache(bool enable) { cache_optimized_model_ = enable; }
+    
+    // Map ORT-format models read-only so PEs on a host share the weights
+    // (call before initialize)
+    void setMemoryMappedModel(bool enable) { memory_map_model_ = enable; }
+    
+    // Load the INT8 encoder <encoder>.int8.onnx; the decoder stays FP32
+    // (call before initialize)
+    void setQuantizedEncoder(bool enable) { quantized_encoder_ = enable; }
+    
+    // Most symbols the transducer may emit on one encoder frame before moving
+    // to the next (guards against a decoder that never predicts blank)
+    void setMaxSymbolsPerFrame(int max_symbols) { max_symbols_per_frame_ = std::max(1, max_symbols); }
+    
+    // Hybrid encoders exported with their CTC head as an extra output: frames
+    // where the CTC blank posterior exceeds threshold get no decoder_joint
+    // call (0: off). Without a CTC output every frame is decoded
+    void setBlankSkipThreshold(float threshold) { blank_skip_threshold_ = threshold; }
+    
+    // Long-form transcribe(): inputs over segment_ms are encoded in segments
+    // of segment_ms overlapping by overlap_ms, so peak memory follows the
+    // segment length rather than the file (0: off, one encoder pass). With
+    // cut_at_silence a segment ends at the quietest 10 ms of its last
+    // overlap_ms instead, without overlap, when that stretch is silent. Each
+    // overlap is split at its midpoint by encoder frame time and decoding
+    // carries on across segments. Files are read one segment at a time
+    void setLongForm(int segment_ms, int overlap_ms, bool cut_at_silence = true);
+
     // Initialize with the proven working ONNX models
     bool initialize(const std::string& encoder_path, 
                    const std::string& decoder_path,
                    const std::string& vocab_path);
 
+    // Run duration_ms of silence through features, encoder and decoder so lazy
+    // initialization happens before the first real audio
+    bool warmUp(int duration_ms);
+
     // Transcribe audio file using proven approach
     std::string transcribe(const std::string& audio_file_path);
     
     // Transcribe audio data using proven approach
     std::string transcribe(const std::vector<float>& audio_data, int sample_rate);
+    
+    // Transcribe the next chunk of a stream: decoding continues from the
+    // previous chunk's last token and LSTM state. Returns the chunk's text
+    std::string transcribeChunk(const std::vector<float>& audio_data, int sample_rate);
+    
+    // Start a new utterance: blank as the last token, zero LSTM state
+    void resetDecoderState();
 
     // Check if models are loaded
     bool isInitialized() const { return initialized_; }
+    
+    // Whether the encoder has a CTC output usable for blank skipping
+    bool hasCtcHead() const { return ctc_output_index_ >= 0; }
+    
+    // Decoder counters: frames decoded and skipped, decoder_joint calls, decode
+    // time; long-form segments, silence cuts and largest segment
+    std::map<std::string, double> getStats() const;
 
 private:
     // Core inference methods
     std::vector<float> extractFeatures(const std::vector<float>& audio_data, int sample_rate);
     std::vector<float> runEncoder(const std::vector<float>& features);
     std::string runDecoder(const std::vector<float>& encoder_output);
+    bool decodeFrames(const std::vector<float>& encoder_output, size_t first, size_t last,
+                      std::vector<int64_t>& tokens);
+    std::string recognize(const std::vector<float>& audio_data, int sample_rate);
+    
+    // Long-form: read(begin, count, out) fills out with mono samples [begin, begin + count)
+    using SampleReader = std::function<bool(size_t, size_t, std::vector<float>&)>;
+    std::string recognizeLongForm(size_t total_samples, const SampleReader& read);
+    size_t findSilence(const std::vector<float>& audio, size_t from) const;
     
     // Utility methods
     std::vector<float> loadAudioFile(const std::string& file_path, int target_sample_rate = 16000);
     std::string decodeTokens(const std::vector<int64_t>& tokens);
     
-    // ONNX Runtime components
-    std::unique_ptr<Ort::Env> ort_env_;
-    std::unique_ptr<Ort::Session> encoder_session_;
-    std::unique_ptr<Ort::Session> decoder_session_;
-    std::unique_ptr<Ort::SessionOptions> session_options_;
+    // ONNX Runtime components (sessions shared through the OrtRuntime registry)
+    std::shared_ptr<Ort::Session> encoder_session_;
+    std::shared_ptr<Ort::Session> decoder_session_;
     std::unique_ptr<Ort::MemoryInfo> memory_info_;
     
     // Feature extraction
@@ -59,15 +119,56 @@ private:
     std::vector<std::string> encoder_output_names_;
     std::vector<std::string> decoder_input_names_;
     std::vector<std::string> decoder_output_names_;
+    std::string encoder_path_;
+    std::string decoder_path_;
+    
+    // Transducer dimensions, read from the decoder_joint model at load
+    size_t encoder_dim_;
+    size_t state_layers_;
+    size_t state_hidden_;
+    int32_t blank_id_;
+    
+    // Layout of the last encoder output: [1, dim, frames] (NeMo export) or [1, frames, dim]
+    size_t encoded_frames_;
+    bool encoder_channel_major_;
+    
+    // Greedy decoding state, carried across frames, calls and chunks
+    int32_t last_token_;
+    bool text_emitted_;             // utterance has produced text (next word gets its space)
+    std::vector<float> state_1_;    // LSTM hidden state [layers, 1, hidden]
+    std::vector<float> state_2_;    // LSTM cell state [layers, 1, hidden]
+    std::vector<float> frame_;      // one encoder frame [1, dim, 1]
+    int max_symbols_per_frame_;
+    
+    // Blank skipping from the CTC head, and decoder counters
+    int ctc_output_index_;           // encoder output with CTC log-probs (-1: none)
+    float blank_skip_threshold_;
+    std::vector<char> blank_frames_; // per frame of the last encoder output
+    uint64_t frames_decoded_;
+    uint64_t frames_skipped_;
+    uint64_t decoder_calls_;
+    uint64_t decode_us_;
+    
+    // Long-form segmentation (segment_samples_ 0: off) and counters
+    size_t segment_samples_;
+    size_t overlap_samples_;
+    bool cut_at_silence_;
+    uint64_t segments_encoded_;
+    uint64_t silence_cuts_;
+    size_t max_segment_frames_;      // encoder frames of the largest segment
     
     // State
     bool initialized_;
+    bool cache_optimized_model_;
+    bool memory_map_model_;
+    bool quantized_encoder_;
     
     // Configuration matching NeMo's exact parameters
     static constexpr int SAMPLE_RATE = 16000;
     static constexpr int N_MELS = 80;
     static constexpr int FRAME_LENGTH = 400;  // 25ms at 16kHz (was 1024)
     static constexpr int FRAME_SHIFT = 160;   // 10ms at 16kHz (was 256)
+    static constexpr float SILENCE_RMS = 0.005f;  // about -46 dBFS
 };
 
 #endif // PROVEN_NEMO_STT_HPP
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef REAL_FFT_HPP
+#define REAL_FFT_HPP
+
+#include <vector>
+#include <memory>
+#include <complex>
+
+namespace onnx_stt {
+
+/**
+ * Real-input FFT for power-of-two sizes (n_fft = 512 for NeMo/librosa features)
+ *
+ * A real frame of n samples is packed into n/2 complex values, transformed with an
+ * iterative radix-2 FFT and split into the n/2 + 1 non-negative frequency bins.
+ * Twiddles and the bit-reversal permutation are precomputed once per size; plans are
+ * immutable, so one plan can be shared by every extractor and thread in the process.
+ */
+class RealFFT {
+public:
+    explicit RealFFT(int n_fft);
+
+    // Get the shared plan for a given size (created on first use, then cached)
+    static std::shared_ptr<const RealFFT> get(int n_fft);
+
+    int size() const { return n_fft_; }
+    int numBins() const { return n_fft_ / 2 + 1; }
+
+    // Compute |X[k]|^2 for k = 0..n_fft/2 of a real frame of n_fft samples.
+    // 'work' must hold n_fft floats; input and power may not alias work.
+    void powerSpectrum(const float* frame, float* power, float* work) const;
+
+    // Same as above, using a per-thread scratch buffer
+    void powerSpectrum(const float* frame, float* power) const;
+
+    // Convenience overload for vector-based callers
+    std::vector<float> powerSpectrum(const std::vector<float>& frame) const;
+
+private:
+    int n_fft_;
+    int half_;                                      // n_fft / 2 complex points
+    std::vector<int> bit_reverse_;                  // [half_] permutation
+    std::vector<std::complex<float>> twiddles_;     // [half_ / 2] roots for the half-size FFT
+    std::vector<std::complex<float>> split_;        // [half_ + 1] roots e^{-2*pi*i*k/n_fft}
+
+    void complexFFT(std::complex<float>* data) const;
+};
+
+} // namespace onnx_stt
+
+#endif // REAL_FFT_HPP
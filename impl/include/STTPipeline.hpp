@@ -4,6 +4,7 @@
 #include "VADInterface.hpp"
 #include "FeatureExtractor.hpp"
 #include "ModelInterface.hpp"
+#include "AudioPreprocessor.hpp"
 #include <memory>
 #include <vector>
 #include <chrono>
@@ -74,6 +75,11 @@ public:
         
         double real_time_factor = 0.0;
         
+        // Time to first token since initialize()/reset(): first audio in to the
+        // first non-empty text, wall clock and in stream time (-1 until then)
+        double time_to_first_token_ms = -1.0;
+        double first_token_audio_ms = -1.0;
+        
         // Component statistics
         std::map<std::string, double> vad_stats;
         std::map<std::string, double> model_stats;
@@ -85,13 +91,23 @@ public:
     // Initialize all components
     bool initialize();
     
+    // Create another pipeline for a concurrent stream. It gets its own VAD,
+    // feature extractor and model state but shares this pipeline's loaded model
+    // weights when the model supports it (ModelInterface::createStream()).
+    std::unique_ptr<STTPipeline> createStream() const;
+    
     // Process audio chunk (int16 format)
     Result processAudio(const int16_t* samples, size_t num_samples, uint64_t timestamp_ms);
     
     // Process audio chunk (float format)
     Result processAudio(const std::vector<float>& audio, uint64_t timestamp_ms);
     
-    // Reset all components
+    // End of stream: the model processes the frames it still buffers; the
+    // result carries their text and is final
+    Result flush(uint64_t timestamp_ms);
+    
+    // Reset all components (the model is flushed first, so it ends its stream
+    // before its state is cleared)
     void reset();
     
     // Get pipeline configuration
@@ -114,9 +130,17 @@ private:
     
     // State management
     std::vector<float> audio_buffer_;
+    AudioPreprocessor preprocessor_;  // int16 -> float ingestion for this stream
+    std::vector<float> audio_float_;   // reused conversion buffer
+    FeatureMatrix features_;  // reused feature buffer, handed to the model as a view
     uint64_t last_speech_time_ms_;
     bool in_speech_segment_;
     
+    // Start of the stream, for time to first token
+    std::chrono::steady_clock::time_point first_audio_time_;
+    uint64_t first_audio_timestamp_ms_;
+    bool audio_started_;
+    
     // Performance tracking
     mutable Stats stats_;
     std::chrono::steady_clock::time_point last_process_time_;
@@ -129,7 +153,9 @@ private:
     Result processAudioInternal(const std::vector<float>& audio, uint64_t timestamp_ms);
     void updateStats(const Result& result);
     
-    std::vector<float> convertInt16ToFloat(const int16_t* samples, size_t num_samples);
+    // Record time to first token if text is the stream's first; audio_end_ms
+    // is the stream time up to which audio had been fed
+    void noteFirstToken(const std::string& text, std::chrono::steady_clock::time_point at, double audio_end_ms);
 };
 
 /**
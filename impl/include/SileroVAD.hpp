@@ -2,6 +2,7 @@
 #define SILERO_VAD_HPP
 
 #include "VADInterface.hpp"
+#include "OrtRuntime.hpp"
 #include <onnxruntime_cxx_api.h>
 #include <memory>
 #include <vector>
@@ -38,10 +39,8 @@ public:
 private:
     Config config_;
     
-    // ONNX Runtime components
-    std::unique_ptr<Ort::Env> env_;
-    std::unique_ptr<Ort::Session> session_;
-    std::unique_ptr<Ort::SessionOptions> session_options_;
+    // Shared session from the OrtRuntime registry; LSTM state below is per instance
+    std::shared_ptr<Ort::Session> session_;
     
     // Model metadata
     std::vector<std::string> input_names_;
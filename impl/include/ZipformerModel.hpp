@@ -21,6 +21,7 @@ public:
     
     TranscriptionResult processChunk(const std::vector<std::vector<float>>& features, 
                                    uint64_t timestamp_ms) override;
+    using ModelInterface::processChunk;  // contiguous FeatureView overload
     
     void reset() override;
     
@@ -64,6 +65,7 @@ public:
     
     TranscriptionResult processChunk(const std::vector<std::vector<float>>& features, 
                                    uint64_t timestamp_ms) override;
+    using ModelInterface::processChunk;  // contiguous FeatureView overload
     
     void reset() override;
     
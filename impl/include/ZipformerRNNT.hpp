@@ -7,7 +7,14 @@
 #include <queue>
 #include <array>
 #include <algorithm>
+#include <stdexcept>
+#include <map>
+#include <mutex>
+#include <list>
+#include <unordered_map>
 #include "onnxruntime_cxx_api.h"
+#include "CacheManager.hpp"
+#include "OrtRuntime.hpp"
 
 namespace onnx_stt {
 
@@ -35,33 +42,33 @@ public:
         int beam_size = 4;
         float blank_penalty = 0.0f;
         int max_active_paths = 4;
+        int context_size = 2;            // decoder input: last emitted tokens, blank-padded
+        std::string decoding_method = "modified_beam_search";  // or "greedy_search"
+        int max_symbols_per_frame = 1;   // greedy_search: symbols emitted per encoder frame
+        int decoder_cache_size = 256;    // LRU entries of decoder output per stream
         
         // Performance
         int num_threads = 4;
+        bool cache_optimized_model = false;  // save/reuse optimized graphs next to the models
+        bool memory_map_model = false;       // map .ort models read-only, shared between PEs
+        bool quantized_encoder = false;      // INT8 encoder (<encoder>.int8.onnx); decoder/joiner stay FP32
+        bool fixed_shape_encoder = false;    // pin the encoder's free dimensions to the chunk shape
     };
     
     // Cache state for streaming
+    // The 35 caches (len, avg, key, val, val2, conv1, conv2 for each of the 5
+    // encoder stacks) live in one CacheManager arena, in encoder input order
     struct CacheState {
-        // Length caches
-        std::array<std::vector<int64_t>, 5> cached_len;
-        
-        // Average caches
-        std::array<std::vector<float>, 5> cached_avg;
-        
-        // Attention key/value caches
-        std::array<std::vector<float>, 5> cached_key;
-        std::array<std::vector<float>, 5> cached_val;
-        std::array<std::vector<float>, 5> cached_val2;
-        
-        // Convolution caches
-        std::array<std::vector<float>, 5> cached_conv1;
-        std::array<std::vector<float>, 5> cached_conv2;
+        std::unique_ptr<CacheManager> caches;
         
         // Initialize cache dimensions based on model
         void initialize(const Config& config);
         
-        // Get all cache tensors as ONNX values
-        std::vector<Ort::Value> toOnnxValues(Ort::MemoryInfo& memory_info);
+        // Zero all caches (start of a new utterance)
+        void reset();
+        
+        // All cache tensors as ONNX values (pre-built views, no allocation)
+        const std::vector<Ort::Value>& toOnnxValues() const;
         
         // Update caches from model outputs
         void updateFromOutputs(const std::vector<Ort::Value>& outputs);
@@ -70,7 +77,6 @@ public:
     // Hypothesis for beam search
     struct Hypothesis {
         std::vector<int> tokens;           // Token sequence
-        std::vector<float> decoder_state;  // Decoder hidden state
         float score = 0.0f;                // Log probability
         
         bool operator<(const Hypothesis& other) const {
@@ -86,12 +92,42 @@ public:
         bool is_final;
     };
     
+    /**
+     * Loaded encoder/decoder/joiner sessions and vocabulary. Immutable after
+     * load and shared by every stream decoding with the same model files.
+     */
+    struct SharedModel {
+        std::shared_ptr<Ort::Session> encoder;  // sessions from the OrtRuntime registry
+        std::shared_ptr<Ort::Session> decoder;
+        std::shared_ptr<Ort::Session> joiner;
+        std::string encoder_path;               // file loaded (FP32 or INT8 variant)
+        bool fixed_shape = false;               // encoder specialized to the chunk shape
+        std::vector<std::string> tokens;
+        int blank_id = 0;
+        
+        // Prediction network dimensions, read from the sessions at load
+        int64_t joiner_dim = 512;               // encoder frame / joiner input width
+        int64_t decoder_out_dim = 512;
+        int64_t context_size = 2;               // tokens per decoder input row
+        int64_t vocab_size = 0;                 // joiner output width
+        int64_t decoder_max_batch = 0;          // 0: dynamic batch; else fixed batch size
+        int64_t joiner_max_batch = 0;
+    };
+    
+    // Load a model, or return the one already loaded in this process for the
+    // same files (kept alive while any stream uses it)
+    static std::shared_ptr<const SharedModel> loadSharedModel(const Config& config);
+    
     explicit ZipformerRNNT(const Config& config);
+    ZipformerRNNT(const Config& config, std::shared_ptr<const SharedModel> model);
     ~ZipformerRNNT();
     
     // Initialize models
     bool initialize();
     
+    // New stream (own caches and hypotheses) sharing this instance's model
+    std::unique_ptr<ZipformerRNNT> createStream() const;
+    
     // Process audio chunk (streaming)
     Result processChunk(const std::vector<float>& features);
     
@@ -101,40 +137,89 @@ public:
     // Reset for new utterance
     void reset();
     
+    // Run num_chunks silent chunks through encoder, decoder and joiner, then
+    // reset, so lazy kernel initialization happens before the first real audio
+    bool warmUp(int num_chunks);
+    
+    // Decoder/joiner run counts and decoder cache hit rate
+    std::map<std::string, double> getStats() const;
+    
 private:
-    Config config_;
+    // Candidate expansion of one hypothesis by one token (blank: no new token)
+    struct Candidate {
+        float score;
+        int hyp;
+        int token;
+    };
     
-    // ONNX Runtime
-    Ort::Env env_;
-    Ort::SessionOptions session_options_;
-    Ort::MemoryInfo memory_info_;
+    // Decoder output for one context (keyed by a 64-bit hash of its
+    // context_size token ids), most recently used first
+    struct DecoderCacheEntry {
+        uint64_t key;
+        std::vector<float> output;
+    };
     
-    // Model sessions
-    std::unique_ptr<Ort::Session> encoder_;
-    std::unique_ptr<Ort::Session> decoder_;
-    std::unique_ptr<Ort::Session> joiner_;
+
+    Config config_;
     
-    // Vocabulary
-    std::vector<std::string> tokens_;
-    int blank_id_ = 0;
+    // Shared sessions and vocabulary
+    std::shared_ptr<const SharedModel> model_;
+    Ort::MemoryInfo memory_info_;
     
     // Streaming state
     CacheState cache_state_;
     std::vector<Hypothesis> hypotheses_;
     
+    // Encoder I/O assembled once: [x, caches...] views and the matching names
+    std::vector<float> encoder_features_;
+    std::vector<Ort::Value> encoder_inputs_;
+    std::vector<std::string> encoder_output_name_storage_;
+    std::vector<const char*> encoder_input_names_;
+    std::vector<const char*> encoder_output_names_;
+    
+    // Modified beam search state: decoder outputs are cached by context, and
+    // all hypotheses go through one decoder call (cache misses only) and one
+    // joiner call per encoder frame. Buffers are reused across frames.
+    std::list<DecoderCacheEntry> decoder_cache_;
+    std::unordered_map<uint64_t, std::list<DecoderCacheEntry>::iterator> decoder_cache_index_;
+    std::vector<float> decoder_out_batch_;      // [hyps, decoder_out_dim]
+    std::vector<float> joiner_encoder_batch_;   // [hyps, joiner_dim], frame repeated
+    std::vector<float> logits_batch_;           // [hyps, vocab_size]
+    std::vector<int64_t> decoder_input_batch_;  // [misses, context_size]
+    std::vector<float> decoder_miss_out_;       // [misses, decoder_out_dim]
+    std::vector<uint64_t> miss_keys_;
+    std::vector<std::pair<size_t, size_t>> miss_rows_;  // (hypothesis, miss)
+    std::vector<int> token_order_;
+    std::vector<Candidate> candidates_;
+    std::vector<Hypothesis> next_hypotheses_;
+    uint64_t decoder_runs_ = 0;
+    uint64_t joiner_runs_ = 0;
+    uint64_t decoder_cache_hits_ = 0;
+    uint64_t decoder_cache_misses_ = 0;
+    uint64_t frames_decoded_ = 0;
+    
     // Internal methods
     std::vector<float> runEncoder(const std::vector<float>& features);
-    std::vector<float> runDecoder(const std::vector<int>& tokens, 
-                                 const std::vector<float>& state);
-    std::vector<float> runJoiner(const std::vector<float>& encoder_out,
-                                const std::vector<float>& decoder_out);
+    
+    // Fill decoder_out_batch_ for every hypothesis, running the decoder once
+    // over the contexts not in the cache
+    void computeDecoderOutputs();
+    
+    // Joiner over all hypotheses for one encoder frame into logits_batch_
+    void runJoiner(const float* encoder_frame, size_t num_hyps);
     
     // Beam search
     void beamSearchStep(const std::vector<float>& encoder_out);
+    void searchFrame(const float* encoder_frame);
+    
+    // Greedy search on the best hypothesis only: one joiner call per frame
+    // when blank wins, one more per emitted symbol (max_symbols_per_frame)
+    void greedyFrame(const float* encoder_frame);
     std::string tokensToText(const std::vector<int>& tokens);
     
     // Helper methods
-    bool loadTokens(const std::string& path);
+    static bool loadTokens(const std::string& path, SharedModel& model);
+    void initializeEncoderIO();
     std::vector<int64_t> getEncoderCacheShape(int layer, const std::string& cache_type);
 };
 
@@ -146,132 +231,54 @@ inline void ZipformerRNNT::CacheState::initialize(const Config& config) {
     // Layer configurations
     const int layer_dims[] = {2, 4, 3, 2, 4};
     const int downsample_factors[] = {64, 32, 16, 8, 32};
+    const int64_t encoder_dim = config.encoder_dim;
+    const int64_t head_dim = 192;   // For keys
+    const int64_t value_dim = 96;   // For values
+    const int64_t kernel_size = 30;
+    
+    CacheManager::CacheConfig cache_config;
+    cache_config.cache_type = CacheManager::CacheConfig::CUSTOM_CACHE;
+    cache_config.num_layers = 5;
+    cache_config.hidden_size = config.encoder_dim;
+    
+    // Names in the model's input order: all stacks of one cache type, then the next type
+    auto add = [&cache_config](const std::string& type, int stack, std::vector<int64_t> shape,
+                               const char* dtype) {
+        std::string name = type + "_" + std::to_string(stack);
+        cache_config.cache_tensor_names.push_back(name);
+        cache_config.cache_shapes[name] = shape;
+        cache_config.cache_data_types[name] = dtype;
+    };
     
-    for (int i = 0; i < 5; ++i) {
-        int num_layers = layer_dims[i];
-        int downsample = downsample_factors[i];
-        
-        // Length caches: [num_layers, batch_size]
-        cached_len[i].resize(num_layers * 1, 0);
-        
-        // Average caches: [num_layers, batch_size, encoder_dim]
-        cached_avg[i].resize(num_layers * 1 * config.encoder_dim, 0.0f);
-        
-        // Attention caches
-        int head_dim = 192;  // For keys
-        int value_dim = 96;  // For values
-        
-        // Key cache: [num_layers, downsample, batch_size, head_dim]
-        cached_key[i].resize(num_layers * downsample * 1 * head_dim, 0.0f);
-        
-        // Value caches: [num_layers, downsample, batch_size, value_dim]
-        cached_val[i].resize(num_layers * downsample * 1 * value_dim, 0.0f);
-        cached_val2[i].resize(num_layers * downsample * 1 * value_dim, 0.0f);
-        
-        // Conv caches: [num_layers, batch_size, encoder_dim, kernel_size]
-        int kernel_size = 30;
-        cached_conv1[i].resize(num_layers * 1 * config.encoder_dim * kernel_size, 0.0f);
-        cached_conv2[i].resize(num_layers * 1 * config.encoder_dim * kernel_size, 0.0f);
+    // Length caches: [num_layers, batch_size]
+    for (int i = 0; i < 5; ++i) add("cached_len", i, {layer_dims[i], 1}, "int64");
+    // Average caches: [num_layers, batch_size, encoder_dim]
+    for (int i = 0; i < 5; ++i) add("cached_avg", i, {layer_dims[i], 1, encoder_dim}, "float32");
+    // Key cache: [num_layers, downsample, batch_size, head_dim]
+    for (int i = 0; i < 5; ++i) add("cached_key", i, {layer_dims[i], downsample_factors[i], 1, head_dim}, "float32");
+    // Value caches: [num_layers, downsample, batch_size, value_dim]
+    for (int i = 0; i < 5; ++i) add("cached_val", i, {layer_dims[i], downsample_factors[i], 1, value_dim}, "float32");
+    for (int i = 0; i < 5; ++i) add("cached_val2", i, {layer_dims[i], downsample_factors[i], 1, value_dim}, "float32");
+    // Conv caches: [num_layers, batch_size, encoder_dim, kernel_size]
+    for (int i = 0; i < 5; ++i) add("cached_conv1", i, {layer_dims[i], 1, encoder_dim, kernel_size}, "float32");
+    for (int i = 0; i < 5; ++i) add("cached_conv2", i, {layer_dims[i], 1, encoder_dim, kernel_size}, "float32");
+    
+    caches = std::make_unique<CacheManager>(cache_config);
+    if (!caches->initialize()) {
+        throw std::runtime_error("Failed to initialize Zipformer cache arena");
     }
 }
 
-inline std::vector<Ort::Value> ZipformerRNNT::CacheState::toOnnxValues(
-    Ort::MemoryInfo& memory_info) {
-    
-    std::vector<Ort::Value> values;
-    
-    // Create tensors for each cache in the correct order
-    // This must match the model's input order exactly
-    
-    const int layer_dims[] = {2, 4, 3, 2, 4};
-    const int downsample_factors[] = {64, 32, 16, 8, 32};
-    const int encoder_dim = 384;
-    
-    // Add cached_len tensors
-    for (int i = 0; i < 5; ++i) {
-        std::vector<int64_t> shape = {layer_dims[i], 1};
-        values.push_back(Ort::Value::CreateTensor<int64_t>(
-            memory_info,
-            cached_len[i].data(),
-            cached_len[i].size(),
-            shape.data(),
-            shape.size()
-        ));
-    }
-    
-    // Add cached_avg tensors
-    for (int i = 0; i < 5; ++i) {
-        std::vector<int64_t> shape = {layer_dims[i], 1, encoder_dim};
-        values.push_back(Ort::Value::CreateTensor<float>(
-            memory_info,
-            cached_avg[i].data(),
-            cached_avg[i].size(),
-            shape.data(),
-            shape.size()
-        ));
-    }
-    
-    // Add cached_key tensors
-    for (int i = 0; i < 5; ++i) {
-        std::vector<int64_t> shape = {layer_dims[i], downsample_factors[i], 1, 192};
-        values.push_back(Ort::Value::CreateTensor<float>(
-            memory_info,
-            cached_key[i].data(),
-            cached_key[i].size(),
-            shape.data(),
-            shape.size()
-        ));
-    }
-    
-    // Add cached_val tensors
-    for (int i = 0; i < 5; ++i) {
-        std::vector<int64_t> shape = {layer_dims[i], downsample_factors[i], 1, 96};
-        values.push_back(Ort::Value::CreateTensor<float>(
-            memory_info,
-            cached_val[i].data(),
-            cached_val[i].size(),
-            shape.data(),
-            shape.size()
-        ));
-    }
-    
-    // Add cached_val2 tensors
-    for (int i = 0; i < 5; ++i) {
-        std::vector<int64_t> shape = {layer_dims[i], downsample_factors[i], 1, 96};
-        values.push_back(Ort::Value::CreateTensor<float>(
-            memory_info,
-            cached_val2[i].data(),
-            cached_val2[i].size(),
-            shape.data(),
-            shape.size()
-        ));
-    }
-    
-    // Add cached_conv1 tensors
-    for (int i = 0; i < 5; ++i) {
-        std::vector<int64_t> shape = {layer_dims[i], 1, encoder_dim, 30};
-        values.push_back(Ort::Value::CreateTensor<float>(
-            memory_info,
-            cached_conv1[i].data(),
-            cached_conv1[i].size(),
-            shape.data(),
-            shape.size()
-        ));
+inline void ZipformerRNNT::CacheState::reset() {
+    if (caches) {
+        caches->reset();
     }
-    
-    // Add cached_conv2 tensors
-    for (int i = 0; i < 5; ++i) {
-        std::vector<int64_t> shape = {layer_dims[i], 1, encoder_dim, 30};
-        values.push_back(Ort::Value::CreateTensor<float>(
-            memory_info,
-            cached_conv2[i].data(),
-            cached_conv2[i].size(),
-            shape.data(),
-            shape.size()
-        ));
-    }
-    
-    return values;
+}
+
+inline const std::vector<Ort::Value>& ZipformerRNNT::CacheState::toOnnxValues() const {
+    // Views are built once by CacheManager::initialize() and alias the arena,
+    // so they always see the current cache contents
+    return caches->getInputCaches();
 }
 
 inline void ZipformerRNNT::CacheState::updateFromOutputs(
@@ -279,78 +286,8 @@ inline void ZipformerRNNT::CacheState::updateFromOutputs(
     
     // The encoder outputs new cache values in the same order as inputs
     // Starting from output index 1 (index 0 is the encoder output)
-    
-    // Skip the first output (encoder_out) and process cache updates
-    size_t output_idx = 1;
-    
-    // Update cached_len
-    for (int i = 0; i < 5; ++i) {
-        if (output_idx < outputs.size()) {
-            const int64_t* data = outputs[output_idx].GetTensorData<int64_t>();
-            size_t size = cached_len[i].size();
-            std::copy(data, data + size, cached_len[i].begin());
-            output_idx++;
-        }
-    }
-    
-    // Update cached_avg
-    for (int i = 0; i < 5; ++i) {
-        if (output_idx < outputs.size()) {
-            const float* data = outputs[output_idx].GetTensorData<float>();
-            size_t size = cached_avg[i].size();
-            std::copy(data, data + size, cached_avg[i].begin());
-            output_idx++;
-        }
-    }
-    
-    // Update cached_key
-    for (int i = 0; i < 5; ++i) {
-        if (output_idx < outputs.size()) {
-            const float* data = outputs[output_idx].GetTensorData<float>();
-            size_t size = cached_key[i].size();
-            std::copy(data, data + size, cached_key[i].begin());
-            output_idx++;
-        }
-    }
-    
-    // Update cached_val
-    for (int i = 0; i < 5; ++i) {
-        if (output_idx < outputs.size()) {
-            const float* data = outputs[output_idx].GetTensorData<float>();
-            size_t size = cached_val[i].size();
-            std::copy(data, data + size, cached_val[i].begin());
-            output_idx++;
-        }
-    }
-    
-    // Update cached_val2
-    for (int i = 0; i < 5; ++i) {
-        if (output_idx < outputs.size()) {
-            const float* data = outputs[output_idx].GetTensorData<float>();
-            size_t size = cached_val2[i].size();
-            std::copy(data, data + size, cached_val2[i].begin());
-            output_idx++;
-        }
-    }
-    
-    // Update cached_conv1
-    for (int i = 0; i < 5; ++i) {
-        if (output_idx < outputs.size()) {
-            const float* data = outputs[output_idx].GetTensorData<float>();
-            size_t size = cached_conv1[i].size();
-            std::copy(data, data + size, cached_conv1[i].begin());
-            output_idx++;
-        }
-    }
-    
-    // Update cached_conv2
-    for (int i = 0; i < 5; ++i) {
-        if (output_idx < outputs.size()) {
-            const float* data = outputs[output_idx].GetTensorData<float>();
-            size_t size = cached_conv2[i].size();
-            std::copy(data, data + size, cached_conv2[i].begin());
-            output_idx++;
-        }
+    if (outputs.size() > 1) {
+        caches->updateCaches(outputs.data() + 1, outputs.size() - 1);
     }
 }
 
@@ -31,17 +31,38 @@ public:
     }
     
     std::vector<std::vector<float>> computeFeatures(const std::vector<float>& audio) {
-        // Simple placeholder implementation
-        // In real implementation, this would compute log mel filterbank features
-        
-        int num_frames = (audio.size() - frame_length_samples_) / frame_shift_samples_ + 1;
+        int num_frames = numFrames(audio.size());
         if (num_frames <= 0) {
             return std::vector<std::vector<float>>();
         }
         
         // Return 2D vector where each inner vector is one frame
+        std::vector<float> flat(static_cast<size_t>(num_frames) * opts_.num_mel_bins);
+        computeFeatures(audio.data(), audio.size(), flat.data());
+        
         std::vector<std::vector<float>> features;
         features.reserve(num_frames);
+        for (int frame = 0; frame < num_frames; ++frame) {
+            auto begin = flat.begin() + static_cast<size_t>(frame) * opts_.num_mel_bins;
+            features.emplace_back(begin, begin + opts_.num_mel_bins);
+        }
+        
+        return features;
+    }
+    
+    // Number of frames computeFeatures() produces for num_samples of audio
+    int numFrames(size_t num_samples) const {
+        if (static_cast<int>(num_samples) < frame_length_samples_) {
+            return 0;
+        }
+        return (static_cast<int>(num_samples) - frame_length_samples_) / frame_shift_samples_ + 1;
+    }
+    
+    // Write numFrames(num_samples) x num_mel_bins features, row-major, into out
+    void computeFeatures(const float* audio, size_t num_samples, float* out) const {
+        // Simple placeholder implementation
+        // In real implementation, this would compute log mel filterbank features
+        int num_frames = numFrames(num_samples);
         
         // Fill with normalized audio energy as placeholder
         for (int frame = 0; frame < num_frames; ++frame) {
@@ -49,22 +70,18 @@ public:
             float energy = 0.0f;
             
             // Compute frame energy
-            for (int i = 0; i < frame_length_samples_ && start + i < static_cast<int>(audio.size()); ++i) {
+            for (int i = 0; i < frame_length_samples_ && start + i < static_cast<int>(num_samples); ++i) {
                 float sample = audio[start + i] * window_[i];
                 energy += sample * sample;
             }
             energy = std::log(energy + 1e-10f);
             
-            // Create feature vector for this frame
-            std::vector<float> frame_features(opts_.num_mel_bins);
+            // Write feature vector for this frame
+            float* frame_features = out + static_cast<size_t>(frame) * opts_.num_mel_bins;
             for (int mel = 0; mel < opts_.num_mel_bins; ++mel) {
                 frame_features[mel] = energy * 0.1f * (1.0f + 0.1f * mel);
             }
-            
-            features.push_back(frame_features);
         }
-        
-        return features;
     }
     
     int getFeatureDim() const { return opts_.num_mel_bins; }
@@ -0,0 +1,95 @@
+#include "AudioPreprocessor.hpp"
+#include <algorithm>
+
+namespace onnx_stt {
+
+namespace {
+
+// Block size for the pre-emphasis pass; the scratch block stays in L1
+const size_t kBlockSize = 256;
+
+// Counter-based uniform noise in [-1, 1): lowbias32 hash of (seed, index).
+// Pure function of its inputs, so the loops below vectorize and dither does not
+// depend on how the stream was chunked.
+inline float hashUniform(uint32_t seed, uint32_t index) {
+    uint32_t x = index + seed * 0x9E3779B9u;
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return static_cast<float>(static_cast<int32_t>(x)) * (1.0f / 2147483648.0f);
+}
+
+} // namespace
+
+AudioPreprocessor::AudioPreprocessor() : AudioPreprocessor(Options()) {}
+
+AudioPreprocessor::AudioPreprocessor(const Options& options)
+    : options_(options), sample_index_(0), last_sample_(0.0f) {}
+
+void AudioPreprocessor::reset() {
+    sample_index_ = 0;
+    last_sample_ = 0.0f;
+}
+
+void AudioPreprocessor::process(const int16_t* samples, size_t num_samples, float* output) {
+    processImpl(samples, num_samples, output, options_.scale);
+}
+
+void AudioPreprocessor::process(const float* samples, size_t num_samples, float* output) {
+    processImpl(samples, num_samples, output, 1.0f);
+}
+
+void AudioPreprocessor::process(const int16_t* samples, size_t num_samples, std::vector<float>& output) {
+    output.resize(num_samples);
+    process(samples, num_samples, output.data());
+}
+
+template <typename T>
+void AudioPreprocessor::processImpl(const T* samples, size_t num_samples, float* output, float scale) {
+    const float dither = options_.dither;
+    const float coeff = options_.preemph_coeff;
+    const uint32_t seed = options_.seed;
+    float block[kBlockSize];
+
+    for (size_t start = 0; start < num_samples; start += kBlockSize) {
+        const size_t len = std::min(kBlockSize, num_samples - start);
+        const T* src = samples + start;
+        const uint32_t base = static_cast<uint32_t>(sample_index_ + start);
+
+        // Without pre-emphasis the converted samples go straight to the output
+        float* dst = coeff != 0.0f ? block : output + start;
+
+        if (dither > 0.0f) {
+            for (size_t i = 0; i < len; ++i) {
+                dst[i] = static_cast<float>(src[i]) * scale +
+                         dither * hashUniform(seed, base + static_cast<uint32_t>(i));
+            }
+        } else {
+            for (size_t i = 0; i < len; ++i) {
+                dst[i] = static_cast<float>(src[i]) * scale;
+            }
+        }
+
+        if (coeff != 0.0f) {
+            float* out = output + start;
+            out[0] = block[0] - coeff * last_sample_;
+            for (size_t i = 1; i < len; ++i) {
+                out[i] = block[i] - coeff * block[i - 1];
+            }
+            last_sample_ = block[len - 1];
+        }
+    }
+
+    sample_index_ += num_samples;
+}
+
+void AudioPreprocessor::convertInt16ToFloat(const int16_t* samples, size_t num_samples, float* output,
+                                            float scale) {
+    for (size_t i = 0; i < num_samples; ++i) {
+        output[i] = static_cast<float>(samples[i]) * scale;
+    }
+}
+
+} // namespace onnx_stt
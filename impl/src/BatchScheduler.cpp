@@ -0,0 +1,309 @@
+#include "BatchScheduler.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace onnx_stt {
+
+BatchScheduler::BatchScheduler(std::shared_ptr<BatchModel> model, const Config& config)
+    : model_(std::move(model))
+    , config_(config)
+    , running_(false)
+    , next_stream_id_(0)
+    , pending_total_(0)
+    , batches_run_(0)
+    , chunks_batched_(0)
+    , batch_failures_(0)
+    , total_batch_us_(0) {
+    // The exported model may pin its batch dimension
+    if (model_) {
+        config_.max_batch_size = std::max(1, std::min(config_.max_batch_size, model_->getMaxBatchSize()));
+    }
+}
+
+BatchScheduler::~BatchScheduler() {
+    stop();
+}
+
+bool BatchScheduler::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!model_) {
+        std::cerr << "BatchScheduler: no model" << std::endl;
+        return false;
+    }
+    if (running_) {
+        return true;
+    }
+    running_ = true;
+    worker_ = std::thread(&BatchScheduler::workerLoop, this);
+    
+    std::cout << "BatchScheduler started: max_batch_size=" << config_.max_batch_size
+              << ", max_wait_ms=" << config_.max_wait_ms << std::endl;
+    return true;
+}
+
+void BatchScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+int BatchScheduler::openStream() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (static_cast<int>(streams_.size()) >= config_.max_streams) {
+        return -1;
+    }
+    int stream_id = next_stream_id_++;
+    std::unique_ptr<Stream> stream(new Stream());
+    stream->cache = model_->createStreamCache();
+    streams_[stream_id] = std::move(stream);
+    return stream_id;
+}
+
+void BatchScheduler::closeStream(int stream_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end()) {
+        return;
+    }
+    dropPending(*it->second);
+    if (it->second->in_flight) {
+        it->second->closed = true;
+    } else {
+        streams_.erase(it);
+    }
+}
+
+void BatchScheduler::resetStream(int stream_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end()) {
+        return;
+    }
+    Stream& stream = *it->second;
+    dropPending(stream);
+    // The worker owns the cache of an in-flight stream until the batch ends
+    if (stream.in_flight) {
+        stream.reset_pending = true;
+    } else {
+        model_->resetStreamCache(stream.cache);
+    }
+}
+
+void BatchScheduler::dropPending(Stream& stream) {
+    pending_total_ -= stream.pending.size();
+    stream.pending.clear();
+}
+
+bool BatchScheduler::submit(int stream_id, const FeatureView& features, uint64_t timestamp_ms,
+                            Callback callback, bool end_of_stream) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = streams_.find(stream_id);
+        if (!running_ || it == streams_.end() || it->second->closed) {
+            return false;
+        }
+        Stream& stream = *it->second;
+        if (static_cast<int>(stream.pending.size()) >= config_.max_pending_per_stream ||
+            static_cast<int>(pending_total_) >= config_.max_pending_total) {
+            stream.stats.chunks_rejected++;
+            return false;
+        }
+        
+        Request request;
+        request.stream_id = stream_id;
+        request.features.resize(features.numFrames(), features.numBins());
+        features.copyFramesByBins(request.features.data());
+        request.timestamp_ms = timestamp_ms;
+        request.end_of_stream = end_of_stream;
+        request.callback = std::move(callback);
+        request.submitted = Clock::now();
+        stream.pending.push_back(std::move(request));
+        pending_total_++;
+    }
+    cv_.notify_one();
+    return true;
+}
+
+BatchScheduler::StreamStats BatchScheduler::getStreamStats(int stream_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(stream_id);
+    return it == streams_.end() ? StreamStats() : it->second->stats;
+}
+
+std::map<std::string, double> BatchScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::string, double> stats;
+    
+    stats["open_streams"] = static_cast<double>(streams_.size());
+    stats["pending_chunks"] = static_cast<double>(pending_total_);
+    stats["batches_run"] = static_cast<double>(batches_run_);
+    stats["chunks_batched"] = static_cast<double>(chunks_batched_);
+    stats["batch_failures"] = static_cast<double>(batch_failures_);
+    stats["max_batch_size"] = static_cast<double>(config_.max_batch_size);
+    stats["max_wait_ms"] = static_cast<double>(config_.max_wait_ms);
+    
+    uint64_t rejected = 0, queue_us = 0, latency_us = 0, max_latency_us = 0, processed = 0;
+    for (const auto& entry : streams_) {
+        const StreamStats& s = entry.second->stats;
+        rejected += s.chunks_rejected;
+        queue_us += s.total_queue_us;
+        latency_us += s.total_latency_us;
+        max_latency_us = std::max(max_latency_us, s.max_latency_us);
+        processed += s.chunks_processed;
+    }
+    stats["chunks_rejected"] = static_cast<double>(rejected);
+    stats["max_latency_us"] = static_cast<double>(max_latency_us);
+    
+    if (batches_run_ > 0) {
+        stats["average_batch_size"] = static_cast<double>(chunks_batched_) / static_cast<double>(batches_run_);
+        stats["average_batch_us"] = static_cast<double>(total_batch_us_) / static_cast<double>(batches_run_);
+    }
+    if (processed > 0) {
+        stats["average_queue_us"] = static_cast<double>(queue_us) / static_cast<double>(processed);
+        stats["average_latency_us"] = static_cast<double>(latency_us) / static_cast<double>(processed);
+    }
+    return stats;
+}
+
+size_t BatchScheduler::readyStreams() const {
+    size_t ready = 0;
+    for (const auto& entry : streams_) {
+        if (!entry.second->pending.empty() && !entry.second->in_flight) {
+            ready++;
+        }
+    }
+    return ready;
+}
+
+bool BatchScheduler::oldestReady(Clock::time_point& oldest) const {
+    bool found = false;
+    for (const auto& entry : streams_) {
+        const Stream& stream = *entry.second;
+        if (stream.pending.empty() || stream.in_flight) {
+            continue;
+        }
+        if (!found || stream.pending.front().submitted < oldest) {
+            oldest = stream.pending.front().submitted;
+            found = true;
+        }
+    }
+    return found;
+}
+
+std::vector<std::pair<BatchScheduler::Stream*, BatchScheduler::Request>> BatchScheduler::takeBatch() {
+    // Oldest chunks first, one per stream
+    std::vector<Stream*> ready;
+    for (auto& entry : streams_) {
+        if (!entry.second->pending.empty() && !entry.second->in_flight) {
+            ready.push_back(entry.second.get());
+        }
+    }
+    std::sort(ready.begin(), ready.end(), [](const Stream* a, const Stream* b) {
+        return a->pending.front().submitted < b->pending.front().submitted;
+    });
+    if (ready.size() > static_cast<size_t>(config_.max_batch_size)) {
+        ready.resize(config_.max_batch_size);
+    }
+    
+    std::vector<std::pair<Stream*, Request>> batch;
+    batch.reserve(ready.size());
+    for (Stream* stream : ready) {
+        batch.emplace_back(stream, std::move(stream->pending.front()));
+        stream->pending.pop_front();
+        stream->in_flight = true;
+        pending_total_--;
+    }
+    return batch;
+}
+
+void BatchScheduler::workerLoop() {
+    const size_t max_batch = static_cast<size_t>(config_.max_batch_size);
+    std::vector<BatchEntry> entries;
+    std::vector<ModelInterface::TranscriptionResult> results;
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return !running_ || readyStreams() > 0; });
+        if (!running_ && readyStreams() == 0) {
+            break;
+        }
+        
+        // Fill the batch until it is full or the oldest chunk reaches its deadline;
+        // when stopping, drain without waiting
+        Clock::time_point oldest;
+        if (running_ && oldestReady(oldest)) {
+            auto deadline = oldest + std::chrono::milliseconds(config_.max_wait_ms);
+            cv_.wait_until(lock, deadline, [this, max_batch] {
+                return !running_ || readyStreams() >= max_batch;
+            });
+        }
+        
+        auto batch = takeBatch();
+        if (batch.empty()) {
+            continue;
+        }
+        lock.unlock();
+        
+        // Only this thread touches the model and the in-flight stream caches
+        auto batch_start = Clock::now();
+        entries.resize(batch.size());
+        results.assign(batch.size(), ModelInterface::TranscriptionResult());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            results[i].timestamp_ms = batch[i].second.timestamp_ms;
+            entries[i].features = batch[i].second.features.view();
+            entries[i].end_of_stream = batch[i].second.end_of_stream;
+            entries[i].cache = &batch[i].first->cache;
+            entries[i].result = &results[i];
+        }
+        bool ok = model_->processBatch(entries);
+        auto batch_end = Clock::now();
+        
+        for (size_t i = 0; i < batch.size(); ++i) {
+            results[i].latency_ms = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(batch_end - batch[i].second.submitted).count());
+            if (batch[i].second.callback) {
+                batch[i].second.callback(results[i]);
+            }
+        }
+        
+        lock.lock();
+        uint64_t batch_us = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(batch_end - batch_start).count());
+        batches_run_++;
+        chunks_batched_ += batch.size();
+        total_batch_us_ += batch_us;
+        if (!ok) {
+            batch_failures_++;
+        }
+        
+        for (auto& item : batch) {
+            Stream* stream = item.first;
+            const Request& request = item.second;
+            uint64_t queue_us = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(batch_start - request.submitted).count());
+            uint64_t latency_us = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(batch_end - request.submitted).count());
+            stream->stats.chunks_processed++;
+            stream->stats.total_queue_us += queue_us;
+            stream->stats.total_latency_us += latency_us;
+            stream->stats.max_latency_us = std::max(stream->stats.max_latency_us, latency_us);
+            stream->in_flight = false;
+            if (stream->closed) {
+                streams_.erase(request.stream_id);
+            } else if (stream->reset_pending) {
+                model_->resetStreamCache(stream->cache);
+                stream->reset_pending = false;
+            }
+        }
+    }
+}
+
+} // namespace onnx_stt
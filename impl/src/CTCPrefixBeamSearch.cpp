@@ -0,0 +1,361 @@
+#include "CTCPrefixBeamSearch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace onnx_stt {
+
+namespace {
+
+const float kNegInf = -std::numeric_limits<float>::infinity();
+
+// Trie size below which compaction is not worth a pass
+const size_t kMinCompactNodes = 4096;
+
+inline float logAdd(float a, float b) {
+    if (a < b) {
+        std::swap(a, b);
+    }
+    if (b == kNegInf) {
+        return a;
+    }
+    return a + std::log1p(std::exp(b - a));
+}
+
+inline float total(float blank, float non_blank) {
+    return logAdd(blank, non_blank);
+}
+
+#if defined(__AVX2__)
+// exp(x) for x <= 0 (Cephes polynomial, ~1 ulp over the softmax range)
+inline __m256 exp256(__m256 x) {
+    x = _mm256_max_ps(x, _mm256_set1_ps(-87.3f));
+    __m256 fx = _mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                                              _mm256_set1_ps(0.5f)));
+    x = _mm256_sub_ps(x, _mm256_mul_ps(fx, _mm256_set1_ps(0.693359375f)));
+    x = _mm256_sub_ps(x, _mm256_mul_ps(fx, _mm256_set1_ps(-2.12194440e-4f)));
+    __m256 y = _mm256_set1_ps(1.9875691500e-4f);
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.3981999507e-3f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(8.3334519073e-3f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(4.1665795894e-2f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.6666665459e-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(5.0000001201e-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, _mm256_mul_ps(x, x)), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+    __m256i pow2n = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(pow2n));
+}
+#endif
+
+float maxValue(const float* x, size_t n) {
+    size_t i = 0;
+    float best = kNegInf;
+#if defined(__AVX2__)
+    if (n >= 8) {
+        __m256 acc = _mm256_loadu_ps(x);
+        for (i = 8; i + 8 <= n; i += 8) {
+            acc = _mm256_max_ps(acc, _mm256_loadu_ps(x + i));
+        }
+        __m128 lo = _mm_max_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        lo = _mm_max_ps(lo, _mm_movehl_ps(lo, lo));
+        lo = _mm_max_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+        best = _mm_cvtss_f32(lo);
+    }
+#elif defined(__ARM_NEON)
+    if (n >= 4) {
+        float32x4_t acc = vld1q_f32(x);
+        for (i = 4; i + 4 <= n; i += 4) {
+            acc = vmaxq_f32(acc, vld1q_f32(x + i));
+        }
+        float32x2_t pair = vpmax_f32(vget_low_f32(acc), vget_high_f32(acc));
+        best = vget_lane_f32(vpmax_f32(pair, pair), 0);
+    }
+#endif
+    for (; i < n; ++i) {
+        best = std::max(best, x[i]);
+    }
+    return best;
+}
+
+// out = x - log(sum(exp(x)))
+void logSoftmax(const float* x, float* out, size_t n) {
+    const float max_score = maxValue(x, n);
+    size_t i = 0;
+    float sum = 0.0f;
+#if defined(__AVX2__)
+    const __m256 shift = _mm256_set1_ps(max_score);
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_add_ps(acc, exp256(_mm256_sub_ps(_mm256_loadu_ps(x + i), shift)));
+    }
+    __m128 lo = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+    sum = _mm_cvtss_f32(lo);
+#endif
+    for (; i < n; ++i) {
+        sum += std::exp(x[i] - max_score);
+    }
+
+    const float norm = max_score + std::log(sum);
+    i = 0;
+#if defined(__AVX2__)
+    const __m256 offset = _mm256_set1_ps(norm);
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_sub_ps(_mm256_loadu_ps(x + i), offset));
+    }
+#elif defined(__ARM_NEON)
+    const float32x4_t offset = vdupq_n_f32(norm);
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(out + i, vsubq_f32(vld1q_f32(x + i), offset));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = x[i] - norm;
+    }
+}
+
+// Indices of the scores at or above threshold; out holds n entries
+size_t selectAbove(const float* x, size_t n, float threshold, int* out) {
+    size_t i = 0;
+    size_t count = 0;
+#if defined(__AVX2__)
+    const __m256 limit = _mm256_set1_ps(threshold);
+    for (; i + 8 <= n; i += 8) {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(x + i), limit, _CMP_GE_OQ));
+        while (mask) {
+            out[count++] = static_cast<int>(i) + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+#elif defined(__ARM_NEON)
+    const float32x4_t limit = vdupq_n_f32(threshold);
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t hit = vcgeq_f32(vld1q_f32(x + i), limit);
+        uint32x2_t any = vorr_u32(vget_low_u32(hit), vget_high_u32(hit));
+        if (vget_lane_u32(vpmax_u32(any, any), 0) == 0) {
+            continue;
+        }
+        for (size_t j = i; j < i + 4; ++j) {
+            if (x[j] >= threshold) {
+                out[count++] = static_cast<int>(j);
+            }
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (x[i] >= threshold) {
+            out[count++] = static_cast<int>(i);
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+CTCPrefixBeamSearch::CTCPrefixBeamSearch(const Config& config)
+    : config_(config)
+    , compact_at_(kMinCompactNodes)
+    , frames_decoded_(0)
+    , frames_skipped_(0) {
+    config_.beam_size = std::max(1, config_.beam_size);
+    config_.max_candidates_per_frame = std::max(1, config_.max_candidates_per_frame);
+    reset();
+}
+
+void CTCPrefixBeamSearch::reset() {
+    nodes_.clear();
+    children_.clear();
+    nodes_.push_back({-1, -1, 0});  // root: empty prefix
+    beam_.clear();
+    beam_.push_back({0, 0.0f, kNegInf});
+    compact_at_ = kMinCompactNodes;
+}
+
+void CTCPrefixBeamSearch::compact() {
+    // Mark the beam prefixes and their ancestors (a parent's id is always
+    // below its child's, so one forward pass renumbers parents first)
+    remap_.assign(nodes_.size(), -1);
+    for (const auto& prefix : beam_) {
+        for (int node = prefix.node; node >= 0 && remap_[node] < 0; node = nodes_[node].parent) {
+            remap_[node] = 0;
+        }
+    }
+
+    size_t live = 0;
+    children_.clear();
+    for (size_t node = 0; node < nodes_.size(); ++node) {
+        if (remap_[node] < 0) {
+            continue;
+        }
+        Node kept = nodes_[node];
+        if (kept.parent >= 0) {
+            kept.parent = remap_[kept.parent];
+            const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(kept.parent)) << 32) |
+                                 static_cast<uint32_t>(kept.token);
+            children_.emplace(key, static_cast<int>(live));
+        }
+        remap_[node] = static_cast<int>(live);
+        nodes_[live++] = kept;
+    }
+    nodes_.resize(live);
+    for (auto& prefix : beam_) {
+        prefix.node = remap_[prefix.node];
+    }
+    compact_at_ = std::max(kMinCompactNodes, 2 * live);
+}
+
+int CTCPrefixBeamSearch::extend(int node, int token) {
+    const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(node)) << 32) |
+                         static_cast<uint32_t>(token);
+    auto it = children_.find(key);
+    if (it != children_.end()) {
+        return it->second;
+    }
+    const int child = static_cast<int>(nodes_.size());
+    nodes_.push_back({node, token, nodes_[node].depth + 1});
+    children_.emplace(key, child);
+    return child;
+}
+
+CTCPrefixBeamSearch::Prefix& CTCPrefixBeamSearch::nextPrefix(int node) {
+    auto it = next_index_.find(node);
+    if (it != next_index_.end()) {
+        return next_[it->second];
+    }
+    next_index_.emplace(node, next_.size());
+    next_.push_back({node, kNegInf, kNegInf});
+    return next_.back();
+}
+
+void CTCPrefixBeamSearch::advance(const float* scores, size_t frames, size_t vocab_size) {
+    if (config_.blank_id < 0 || static_cast<size_t>(config_.blank_id) >= vocab_size) {
+        std::cerr << "CTC beam search: blank id " << config_.blank_id << " outside "
+                  << vocab_size << " classes" << std::endl;
+        return;
+    }
+    candidates_.resize(vocab_size);
+    if (!config_.inputs_are_log_probs) {
+        log_probs_.resize(vocab_size);
+    }
+
+    for (size_t t = 0; t < frames; ++t) {
+        const float* row = scores + t * vocab_size;
+        if (!config_.inputs_are_log_probs) {
+            logSoftmax(row, log_probs_.data(), vocab_size);
+            row = log_probs_.data();
+        }
+        searchFrame(row, vocab_size);
+        ++frames_decoded_;
+    }
+}
+
+void CTCPrefixBeamSearch::searchFrame(const float* log_probs, size_t vocab_size) {
+    const int blank = config_.blank_id;
+    const float blank_log_prob = log_probs[blank];
+
+    // Blank-dominated frame: every prefix now ends in blank, nothing extends
+    if (config_.blank_skip_threshold > 0.0f && blank_log_prob > std::log(config_.blank_skip_threshold)) {
+        for (auto& prefix : beam_) {
+            prefix.blank = total(prefix.blank, prefix.non_blank) + blank_log_prob;
+            prefix.non_blank = kNegInf;
+        }
+        ++frames_skipped_;
+        return;
+    }
+
+    // Candidate tokens: within candidate_prune of the best, top-k of those
+    const float best = maxValue(log_probs, vocab_size);
+    size_t count = selectAbove(log_probs, vocab_size, best - config_.candidate_prune, candidates_.data());
+    count = std::remove(candidates_.begin(), candidates_.begin() + count, blank) - candidates_.begin();
+    const size_t top_k = static_cast<size_t>(config_.max_candidates_per_frame);
+    if (count > top_k) {
+        std::nth_element(candidates_.begin(), candidates_.begin() + (top_k - 1), candidates_.begin() + count,
+                         [log_probs](int a, int b) { return log_probs[a] > log_probs[b]; });
+        count = top_k;
+    }
+
+    next_.clear();
+    next_index_.clear();
+    next_.reserve(beam_.size() * (count + 1));
+    for (const auto& prefix : beam_) {
+        const float prefix_total = total(prefix.blank, prefix.non_blank);
+        Prefix& stay = nextPrefix(prefix.node);
+        stay.blank = logAdd(stay.blank, prefix_total + blank_log_prob);
+
+        const int last = nodes_[prefix.node].token;
+        for (size_t i = 0; i < count; ++i) {
+            const int token = candidates_[i];
+            const float score = log_probs[token];
+            if (token == last) {
+                // Repeat without a blank collapses into the same prefix; after
+                // a blank it is a new occurrence of the token
+                Prefix& same = nextPrefix(prefix.node);
+                same.non_blank = logAdd(same.non_blank, prefix.non_blank + score);
+                const int child = extend(prefix.node, token);
+                Prefix& extended = nextPrefix(child);
+                extended.non_blank = logAdd(extended.non_blank, prefix.blank + score);
+            } else {
+                const int child = extend(prefix.node, token);
+                Prefix& extended = nextPrefix(child);
+                extended.non_blank = logAdd(extended.non_blank, prefix_total + score);
+            }
+        }
+    }
+
+    auto better = [](const Prefix& a, const Prefix& b) {
+        return total(a.blank, a.non_blank) > total(b.blank, b.non_blank);
+    };
+    const size_t beam = std::min(next_.size(), static_cast<size_t>(config_.beam_size));
+    std::partial_sort(next_.begin(), next_.begin() + beam, next_.end(), better);
+    beam_.assign(next_.begin(), next_.begin() + beam);
+
+    if (nodes_.size() >= compact_at_) {
+        compact();
+    }
+}
+
+std::vector<int> CTCPrefixBeamSearch::bestTokens() const {
+    std::vector<int> tokens;
+    for (int node = beam_.front().node; node > 0; node = nodes_[node].parent) {
+        tokens.push_back(nodes_[node].token);
+    }
+    std::reverse(tokens.begin(), tokens.end());
+    return tokens;
+}
+
+std::vector<int> CTCPrefixBeamSearch::stableTokens(size_t from) const {
+    // Deepest common ancestor of the beam prefixes; walking up from the
+    // deeper side only covers the unstable tail
+    int shared = beam_.front().node;
+    for (size_t i = 1; i < beam_.size(); ++i) {
+        int node = beam_[i].node;
+        while (node != shared) {
+            if (nodes_[node].depth >= nodes_[shared].depth) {
+                node = nodes_[node].parent;
+            } else {
+                shared = nodes_[shared].parent;
+            }
+        }
+    }
+
+    std::vector<int> tokens;
+    for (int node = shared; node > 0 && static_cast<size_t>(nodes_[node].depth) > from;
+         node = nodes_[node].parent) {
+        tokens.push_back(nodes_[node].token);
+    }
+    std::reverse(tokens.begin(), tokens.end());
+    return tokens;
+}
+
+float CTCPrefixBeamSearch::bestScore() const {
+    return total(beam_.front().blank, beam_.front().non_blank);
+}
+
+} // namespace onnx_stt
@@ -1,10 +1,25 @@
 #include "CacheManager.hpp"
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
 namespace onnx_stt {
 
-CacheManager::CacheManager(const CacheConfig& config) : config_(config) {}
+namespace {
+
+// Slot alignment in the arena (one cache line; also satisfies AVX-512 loads)
+const size_t kArenaAlignment = 64;
+
+size_t alignUp(size_t value) {
+    return (value + kArenaAlignment - 1) & ~(kArenaAlignment - 1);
+}
+
+} // namespace
+
+CacheManager::CacheManager(const CacheConfig& config)
+    : config_(config)
+    , memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {}
 
 bool CacheManager::initialize() {
     try {
@@ -29,8 +44,10 @@ bool CacheManager::initialize() {
                 return false;
         }
         
-        std::cout << "Initialized " << cache_tensors_.size() + int_cache_tensors_.size() 
-                  << " cache tensors" << std::endl;
+        allocateArena();
+        
+        std::cout << "Initialized " << slots_.size() << " cache tensors ("
+                  << arena_bytes_ << " bytes)" << std::endl;
         return true;
         
     } catch (const std::exception& e) {
@@ -40,76 +57,93 @@ bool CacheManager::initialize() {
 }
 
 void CacheManager::reset() {
-    // Reset all float caches to zero
-    for (auto& cache_pair : cache_tensors_) {
-        std::fill(cache_pair.second.begin(), cache_pair.second.end(), 0.0f);
-    }
-    
-    // Reset all int caches to zero
-    for (auto& cache_pair : int_cache_tensors_) {
-        std::fill(cache_pair.second.begin(), cache_pair.second.end(), 0);
+    // Zero is the initial state for every cache, float or int64
+    if (arena_bytes_ > 0) {
+        std::memset(arena_, 0, arena_bytes_);
     }
 }
 
-std::vector<Ort::Value> CacheManager::getInputCaches(Ort::MemoryInfo& memory_info) {
-    std::vector<Ort::Value> input_caches;
-    
-    for (const auto& name : config_.cache_tensor_names) {
-        auto shape_it = config_.cache_shapes.find(name);
-        if (shape_it == config_.cache_shapes.end()) {
-            std::cerr << "Warning: No shape found for cache " << name << std::endl;
-            continue;
-        }
-        
-        const auto& shape = shape_it->second;
-        auto dtype_it = config_.cache_data_types.find(name);
-        std::string dtype = (dtype_it != config_.cache_data_types.end()) ? 
-                           dtype_it->second : "float32";
-        
-        if (dtype == "float32") {
-            auto& cache_data = getFloatCache(name);
-            input_caches.emplace_back(Ort::Value::CreateTensor<float>(
-                memory_info, cache_data.data(), cache_data.size(),
-                shape.data(), shape.size()));
-        } else if (dtype == "int64") {
-            auto& cache_data = getIntCache(name);
-            input_caches.emplace_back(Ort::Value::CreateTensor<int64_t>(
-                memory_info, cache_data.data(), cache_data.size(),
-                shape.data(), shape.size()));
+void CacheManager::appendInputViews(std::vector<Ort::Value>& values) const {
+    for (const auto& slot : slots_) {
+        if (slot.is_int64) {
+            values.emplace_back(Ort::Value::CreateTensor<int64_t>(
+                memory_info_, reinterpret_cast<int64_t*>(arena_ + slot.offset), slot.elements,
+                slot.shape.data(), slot.shape.size()));
+        } else {
+            values.emplace_back(Ort::Value::CreateTensor<float>(
+                memory_info_, reinterpret_cast<float*>(arena_ + slot.offset), slot.elements,
+                slot.shape.data(), slot.shape.size()));
         }
     }
-    
-    return input_caches;
 }
 
 void CacheManager::updateCaches(const std::vector<Ort::Value>& output_caches) {
-    if (output_caches.size() != config_.cache_tensor_names.size()) {
+    updateCaches(output_caches.data(), output_caches.size());
+}
+
+void CacheManager::updateCaches(const Ort::Value* output_caches, size_t count) {
+    if (count != slots_.size()) {
         std::cerr << "Warning: Output cache count mismatch" << std::endl;
         return;
     }
     
-    for (size_t i = 0; i < output_caches.size(); ++i) {
-        const auto& name = config_.cache_tensor_names[i];
-        const auto& output_cache = output_caches[i];
-        
+    for (size_t i = 0; i < count; ++i) {
+        const CacheSlot& slot = slots_[i];
+        size_t elements = std::min(slot.elements,
+                                   output_caches[i].GetTensorTypeAndShapeInfo().GetElementCount());
+        const void* data = slot.is_int64 ?
+            static_cast<const void*>(output_caches[i].GetTensorData<int64_t>()) :
+            static_cast<const void*>(output_caches[i].GetTensorData<float>());
+        std::memcpy(arena_ + slot.offset, data, elements * (slot.is_int64 ? sizeof(int64_t) : sizeof(float)));
+    }
+}
+
+int CacheManager::getSlot(const std::string& name) const {
+    const auto& names = config_.cache_tensor_names;
+    auto it = std::find(names.begin(), names.end(), name);
+    return it == names.end() ? -1 : static_cast<int>(it - names.begin());
+}
+
+float* CacheManager::getFloatData(int slot) {
+    return reinterpret_cast<float*>(arena_ + slots_[slot].offset);
+}
+
+int64_t* CacheManager::getIntData(int slot) {
+    return reinterpret_cast<int64_t*>(arena_ + slots_[slot].offset);
+}
+
+void CacheManager::addCache(const std::string& name, const std::vector<int64_t>& shape,
+                            const std::string& dtype) {
+    config_.cache_shapes[name] = shape;
+    config_.cache_data_types[name] = dtype;
+}
+
+void CacheManager::allocateArena() {
+    // Lay out every cache in name order, each slot starting on a cache line
+    slots_.clear();
+    size_t offset = 0;
+    for (const auto& name : config_.cache_tensor_names) {
+        CacheSlot slot;
+        slot.shape = config_.cache_shapes.at(name);
         auto dtype_it = config_.cache_data_types.find(name);
-        std::string dtype = (dtype_it != config_.cache_data_types.end()) ? 
-                           dtype_it->second : "float32";
-        
-        if (dtype == "float32") {
-            auto& cache_data = getFloatCache(name);
-            const float* output_data = output_cache.GetTensorData<float>();
-            size_t size = std::min(cache_data.size(), 
-                                  static_cast<size_t>(output_cache.GetTensorTypeAndShapeInfo().GetElementCount()));
-            std::copy(output_data, output_data + size, cache_data.begin());
-        } else if (dtype == "int64") {
-            auto& cache_data = getIntCache(name);
-            const int64_t* output_data = output_cache.GetTensorData<int64_t>();
-            size_t size = std::min(cache_data.size(), 
-                                  static_cast<size_t>(output_cache.GetTensorTypeAndShapeInfo().GetElementCount()));
-            std::copy(output_data, output_data + size, cache_data.begin());
+        slot.is_int64 = dtype_it != config_.cache_data_types.end() && dtype_it->second == "int64";
+        slot.elements = 1;
+        for (int64_t dim : slot.shape) {
+            slot.elements *= static_cast<size_t>(dim);
         }
+        slot.offset = offset;
+        offset = alignUp(offset + slot.elements * (slot.is_int64 ? sizeof(int64_t) : sizeof(float)));
+        slots_.push_back(slot);
     }
+    
+    arena_bytes_ = offset;
+    arena_storage_.assign(arena_bytes_ + kArenaAlignment, 0);
+    arena_ = reinterpret_cast<unsigned char*>(
+        alignUp(reinterpret_cast<uintptr_t>(arena_storage_.data())));
+    
+    input_values_.clear();
+    input_values_.reserve(slots_.size());
+    appendInputViews(input_values_);
 }
 
 void CacheManager::initializeZipformerCaches() {
@@ -120,6 +154,7 @@ void CacheManager::initializeZipformerCaches() {
     };
     
     int num_layers = config_.num_layers > 0 ? config_.num_layers : 5;
+    config_.cache_tensor_names.clear();
     
     for (int layer = 0; layer < num_layers; ++layer) {
         for (const auto& cache_type : cache_types) {
@@ -127,23 +162,14 @@ void CacheManager::initializeZipformerCaches() {
             config_.cache_tensor_names.push_back(cache_name);
             
             // Different cache types have different shapes
-            std::vector<int64_t> shape;
             if (cache_type == "cached_len") {
-                shape = {1, 1};  // [batch, 1]
-                config_.cache_data_types[cache_name] = "int64";
-                getIntCache(cache_name).resize(1, 0);
+                addCache(cache_name, {1, 1}, "int64");          // [batch, 1]
             } else if (cache_type == "cached_avg") {
-                shape = {1, 256};  // [batch, feature_dim]
-                config_.cache_data_types[cache_name] = "float32";
-                getFloatCache(cache_name).resize(256, 0.0f);
+                addCache(cache_name, {1, 256}, "float32");      // [batch, feature_dim]
             } else {
                 // Key, value, conv caches
-                shape = {1, 32, 256};  // [batch, sequence, feature_dim]
-                config_.cache_data_types[cache_name] = "float32";
-                getFloatCache(cache_name).resize(32 * 256, 0.0f);
+                addCache(cache_name, {1, 32, 256}, "float32");  // [batch, sequence, feature_dim]
             }
-            
-            config_.cache_shapes[cache_name] = shape;
         }
     }
 }
@@ -156,19 +182,13 @@ void CacheManager::initializeConformerCaches() {
     int num_layers = config_.num_layers > 0 ? config_.num_layers : 12;
     
     // Encoder output cache
-    config_.cache_shapes["encoder_out_cache"] = {1, 32, hidden_size};
-    config_.cache_data_types["encoder_out_cache"] = "float32";
-    getFloatCache("encoder_out_cache").resize(32 * hidden_size, 0.0f);
+    addCache("encoder_out_cache", {1, 32, hidden_size}, "float32");
     
     // CNN cache
-    config_.cache_shapes["cnn_cache"] = {1, num_layers, 32, hidden_size};
-    config_.cache_data_types["cnn_cache"] = "float32";
-    getFloatCache("cnn_cache").resize(num_layers * 32 * hidden_size, 0.0f);
+    addCache("cnn_cache", {1, num_layers, 32, hidden_size}, "float32");
     
     // Attention cache
-    config_.cache_shapes["att_cache"] = {1, num_layers, 32, hidden_size};
-    config_.cache_data_types["att_cache"] = "float32";
-    getFloatCache("att_cache").resize(num_layers * 32 * hidden_size, 0.0f);
+    addCache("att_cache", {1, num_layers, 32, hidden_size}, "float32");
 }
 
 void CacheManager::initializeWenetCaches() {
@@ -176,9 +196,7 @@ void CacheManager::initializeWenetCaches() {
     config_.cache_tensor_names = {"cache"};
     
     int hidden_size = config_.hidden_size > 0 ? config_.hidden_size : 512;
-    config_.cache_shapes["cache"] = {1, 32, hidden_size};
-    config_.cache_data_types["cache"] = "float32";
-    getFloatCache("cache").resize(32 * hidden_size, 0.0f);
+    addCache("cache", {1, 32, hidden_size}, "float32");
 }
 
 void CacheManager::initializeSpeechBrainCaches() {
@@ -186,16 +204,15 @@ void CacheManager::initializeSpeechBrainCaches() {
     config_.cache_tensor_names = {"h0"};
     
     int hidden_size = config_.hidden_size > 0 ? config_.hidden_size : 512;
-    config_.cache_shapes["h0"] = {1, hidden_size};
-    config_.cache_data_types["h0"] = "float32";
-    getFloatCache("h0").resize(hidden_size, 0.0f);
+    addCache("h0", {1, hidden_size}, "float32");
 }
 
 void CacheManager::initializeCustomCaches() {
-    // Initialize based on user-provided configuration
+    // Initialize based on user-provided configuration; caches without a shape
+    // are dropped so that slots stay aligned with the model's cache inputs
+    std::vector<std::string> names;
     for (const auto& name : config_.cache_tensor_names) {
-        auto shape_it = config_.cache_shapes.find(name);
-        if (shape_it == config_.cache_shapes.end()) {
+        if (config_.cache_shapes.find(name) == config_.cache_shapes.end()) {
             std::cerr << "Warning: No shape specified for cache " << name << std::endl;
             continue;
         }
@@ -203,27 +220,14 @@ void CacheManager::initializeCustomCaches() {
         auto dtype_it = config_.cache_data_types.find(name);
         std::string dtype = (dtype_it != config_.cache_data_types.end()) ? 
                            dtype_it->second : "float32";
-        
-        // Calculate total size
-        size_t total_size = 1;
-        for (int64_t dim : shape_it->second) {
-            total_size *= static_cast<size_t>(dim);
+        if (dtype != "float32" && dtype != "int64") {
+            std::cerr << "Warning: Unsupported data type " << dtype << " for cache " << name << std::endl;
+            continue;
         }
         
-        if (dtype == "float32") {
-            getFloatCache(name).resize(total_size, 0.0f);
-        } else if (dtype == "int64") {
-            getIntCache(name).resize(total_size, 0);
-        }
+        names.push_back(name);
     }
-}
-
-std::vector<float>& CacheManager::getFloatCache(const std::string& name) {
-    return cache_tensors_[name];
-}
-
-std::vector<int64_t>& CacheManager::getIntCache(const std::string& name) {
-    return int_cache_tensors_[name];
+    config_.cache_tensor_names = names;
 }
 
 // Factory methods
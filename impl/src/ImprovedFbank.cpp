@@ -2,17 +2,30 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
-#include <random>
 
 namespace improved_fbank {
 
-FbankComputer::FbankComputer(const Options& opts) : opts_(opts), cmvn_available_(false) {
+namespace {
+
+// Uniform dither with the same variance as N(0, dither^2)
+onnx_stt::AudioPreprocessor::Options ditherOptions(const FbankComputer::Options& opts) {
+    onnx_stt::AudioPreprocessor::Options dither_opts;
+    dither_opts.dither = opts.dither > 0.0f ? opts.dither * std::sqrt(3.0f) : 0.0f;
+    dither_opts.seed = opts.dither_seed;
+    return dither_opts;
+}
+
+} // namespace
+
+FbankComputer::FbankComputer(const Options& opts)
+    : opts_(opts), cmvn_available_(false), dither_(ditherOptions(opts)) {
     // Convert ms to samples
     frame_length_samples_ = (opts_.sample_rate * opts_.frame_length_ms) / 1000;
     frame_shift_samples_ = (opts_.sample_rate * opts_.frame_shift_ms) / 1000;
     
     initializeWindow();
     initializeMelFilterbank();
+    fft_ = onnx_stt::RealFFT::get(opts_.n_fft);
     
     std::cout << "ImprovedFbank initialized:" << std::endl;
     std::cout << "  Sample rate: " << opts_.sample_rate << " Hz" << std::endl;
@@ -31,6 +44,16 @@ void FbankComputer::initializeWindow() {
 }
 
 void FbankComputer::initializeMelFilterbank() {
+    // Banks depend only on these options, so identical computers share one instance
+    std::ostringstream key;
+    key << "improved:" << opts_.sample_rate << ":" << opts_.n_fft << ":" << opts_.num_mel_bins
+        << ":" << opts_.low_freq << ":" << opts_.high_freq;
+    mel_filterbank_ = onnx_stt::MelFilterbank::get(key.str(), [this]() {
+        return createDenseMelFilterbank();
+    });
+}
+
+std::vector<std::vector<float>> FbankComputer::createDenseMelFilterbank() {
     int num_fft_bins = opts_.n_fft / 2 + 1;
     
     // Convert frequencies to mel scale
@@ -56,10 +79,8 @@ void FbankComputer::initializeMelFilterbank() {
     }
     
     // Create mel filterbank matrix
-    mel_filterbank_.resize(opts_.num_mel_bins);
+    std::vector<std::vector<float>> mel_filterbank(opts_.num_mel_bins, std::vector<float>(num_fft_bins, 0.0f));
     for (int mel = 0; mel < opts_.num_mel_bins; ++mel) {
-        mel_filterbank_[mel].resize(num_fft_bins, 0.0f);
-        
         int left = bin_points[mel];
         int center = bin_points[mel + 1];
         int right = bin_points[mel + 2];
@@ -67,17 +88,19 @@ void FbankComputer::initializeMelFilterbank() {
         // Left slope
         for (int bin = left; bin < center; ++bin) {
             if (bin >= 0 && bin < num_fft_bins) {
-                mel_filterbank_[mel][bin] = static_cast<float>(bin - left) / (center - left);
+                mel_filterbank[mel][bin] = static_cast<float>(bin - left) / (center - left);
             }
         }
         
         // Right slope
         for (int bin = center; bin < right; ++bin) {
             if (bin >= 0 && bin < num_fft_bins) {
-                mel_filterbank_[mel][bin] = static_cast<float>(right - bin) / (right - center);
+                mel_filterbank[mel][bin] = static_cast<float>(right - bin) / (right - center);
             }
         }
     }
+    
+    return mel_filterbank;
 }
 
 float FbankComputer::melScale(float freq) {
@@ -89,62 +112,34 @@ float FbankComputer::invMelScale(float mel) {
 }
 
 std::vector<float> FbankComputer::computeFFT(const std::vector<float>& frame) {
-    // Simple magnitude spectrum computation
-    // In production, would use optimized FFT library (FFTW, etc.)
-    
-    int fft_size = opts_.n_fft;
+    int fft_size = fft_->size();
     std::vector<float> padded_frame(fft_size, 0.0f);
     
     // Copy and pad frame
     int copy_len = std::min(static_cast<int>(frame.size()), fft_size);
-    for (int i = 0; i < copy_len; ++i) {
-        padded_frame[i] = frame[i];
-    }
+    std::copy(frame.begin(), frame.begin() + copy_len, padded_frame.begin());
     
-    // Simple DFT (inefficient but correct for proof of concept)
-    std::vector<float> power_spectrum(fft_size / 2 + 1);
-    
-    for (int k = 0; k < fft_size / 2 + 1; ++k) {
-        float real = 0.0f, imag = 0.0f;
-        
-        for (int n = 0; n < fft_size; ++n) {
-            float angle = -2.0f * M_PI * k * n / fft_size;
-            real += padded_frame[n] * std::cos(angle);
-            imag += padded_frame[n] * std::sin(angle);
-        }
-        
-        power_spectrum[k] = real * real + imag * imag;
-    }
+    std::vector<float> power_spectrum(fft_->numBins());
+    fft_->powerSpectrum(padded_frame.data(), power_spectrum.data());
     
     return power_spectrum;
 }
 
 std::vector<float> FbankComputer::applyMelFilterbank(const std::vector<float>& power_spectrum) {
-    std::vector<float> mel_energies(opts_.num_mel_bins);
+    std::vector<float> mel_energies = mel_filterbank_->apply(power_spectrum);
     
-    for (int mel = 0; mel < opts_.num_mel_bins; ++mel) {
-        float energy = 0.0f;
-        for (size_t bin = 0; bin < power_spectrum.size() && bin < mel_filterbank_[mel].size(); ++bin) {
-            energy += power_spectrum[bin] * mel_filterbank_[mel][bin];
-        }
-        
+    if (opts_.apply_log) {
         // Apply log and ensure positive values
-        mel_energies[mel] = opts_.apply_log ? std::log(std::max(energy, 1e-10f)) : energy;
+        for (float& energy : mel_energies) {
+            energy = std::log(std::max(energy, 1e-10f));
+        }
     }
     
     return mel_energies;
 }
 
-void FbankComputer::applyDither(std::vector<float>& audio) {
-    if (opts_.dither <= 0.0f) return;
-    
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::normal_distribution<float> dist(0.0f, opts_.dither);
-    
-    for (float& sample : audio) {
-        sample += dist(gen);
-    }
+void FbankComputer::dither(const float* samples, size_t num_samples, float* output) {
+    dither_.process(samples, num_samples, output);
 }
 
 std::vector<std::vector<float>> FbankComputer::computeFeatures(const std::vector<float>& audio) {
@@ -152,9 +147,15 @@ std::vector<std::vector<float>> FbankComputer::computeFeatures(const std::vector
         return std::vector<std::vector<float>>();
     }
     
-    // Apply dither if specified
-    std::vector<float> dithered_audio = audio;
-    applyDither(dithered_audio);
+    std::vector<float> dithered_audio(audio.size());
+    dither(audio.data(), audio.size(), dithered_audio.data());
+    return computeDitheredFeatures(dithered_audio);
+}
+
+std::vector<std::vector<float>> FbankComputer::computeDitheredFeatures(const std::vector<float>& dithered_audio) {
+    if (dithered_audio.empty()) {
+        return std::vector<std::vector<float>>();
+    }
     
     // Calculate number of frames
     int num_frames = 0;
@@ -1,10 +1,12 @@
 #include "KaldiFbankFeatureExtractor.hpp"
 #include <iostream>
 #include <cmath>
+#include <cstring>
 
 KaldiFbankFeatureExtractor::KaldiFbankFeatureExtractor() {
     setupFbankOptions();
     fbank_ = std::make_unique<knf::OnlineFbank>(fbank_opts_);
+    stream_fbank_ = std::make_unique<knf::OnlineFbank>(fbank_opts_);
 }
 
 void KaldiFbankFeatureExtractor::setupFbankOptions() {
@@ -124,4 +126,66 @@ int KaldiFbankFeatureExtractor::getNumFrames(int audio_length) const {
     int num_frames = 1 + (padded_length - frame_length_samples) / frame_shift_samples;
     
     return num_frames;
-}
\ No newline at end of file
+}
+
+size_t KaldiFbankFeatureExtractor::acceptWaveform(const float* samples, size_t num_samples,
+                                                  onnx_stt::FeatureMatrix& frames) {
+    if (input_finished_) {
+        std::cerr << "Warning: acceptWaveform() after inputFinished(), call reset() first" << std::endl;
+        return 0;
+    }
+    
+    if (num_samples > 0) {
+        stream_fbank_->AcceptWaveform(fbank_opts_.frame_opts.samp_freq, samples,
+                                      static_cast<int32_t>(num_samples));
+    }
+    
+    return collectNewFrames(frames);
+}
+
+size_t KaldiFbankFeatureExtractor::acceptWaveform(const std::vector<float>& samples,
+                                                  onnx_stt::FeatureMatrix& frames) {
+    return acceptWaveform(samples.data(), samples.size(), frames);
+}
+
+size_t KaldiFbankFeatureExtractor::inputFinished(onnx_stt::FeatureMatrix& frames) {
+    if (input_finished_) {
+        return 0;
+    }
+    
+    stream_fbank_->InputFinished();
+    input_finished_ = true;
+    
+    return collectNewFrames(frames);
+}
+
+void KaldiFbankFeatureExtractor::reset() {
+    // OnlineFbank has no reset, so start a fresh one
+    stream_fbank_ = std::make_unique<knf::OnlineFbank>(fbank_opts_);
+    frames_emitted_ = 0;
+    input_finished_ = false;
+}
+
+size_t KaldiFbankFeatureExtractor::collectNewFrames(onnx_stt::FeatureMatrix& frames) {
+    int32_t num_ready = stream_fbank_->NumFramesReady();
+    int32_t num_new = num_ready - frames_emitted_;
+    int32_t feature_dim = stream_fbank_->Dim();
+    if (frames.empty()) {
+        frames.resize(0, static_cast<size_t>(feature_dim));
+        frames.setLayout(onnx_stt::FeatureLayout::FRAMES_BY_BINS);
+    }
+    if (num_new <= 0) {
+        return 0;
+    }
+    
+    // Frame indices are absolute; already emitted frames have been popped
+    for (int32_t t = 0; t < num_new; t++) {
+        frames.appendFrames(stream_fbank_->GetFrame(frames_emitted_ + t), 1);
+    }
+    
+    // Release emitted frames so long streams don't accumulate them
+    stream_fbank_->Pop(num_new);
+    frames_emitted_ = num_ready;
+    
+    return static_cast<size_t>(num_new);
+}
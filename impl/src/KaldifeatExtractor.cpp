@@ -1,8 +1,10 @@
 #include "KaldifeatExtractor.hpp"
+#include "AudioPreprocessor.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
 
 // Include kaldifeat headers if available
 #ifdef HAVE_KALDIFEAT
@@ -110,6 +112,12 @@ bool KaldifeatExtractor::initialize(const Config& config) {
 }
 
 std::vector<std::vector<float>> KaldifeatExtractor::computeFeatures(const std::vector<float>& audio) {
+    FeatureMatrix features;
+    computeFeatures(audio.data(), audio.size(), features);
+    return features.toNested();
+}
+
+void KaldifeatExtractor::computeFeatures(const float* audio, size_t num_samples, FeatureMatrix& out) {
     if (kaldifeat_available_) {
         // Use kaldifeat for high-quality feature extraction
 #ifdef HAVE_KALDIFEAT
@@ -119,8 +127,8 @@ std::vector<std::vector<float>> KaldifeatExtractor::computeFeatures(const std::v
             
             // Feed audio data to kaldifeat
             // Note: kaldifeat expects data in chunks, we'll process the entire audio
-            // Convert vector<float> to the format expected by kaldifeat
-            std::vector<float> audio_copy = audio;  // kaldifeat may modify the input
+            // Convert to the format expected by kaldifeat
+            std::vector<float> audio_copy(audio, audio + num_samples);  // kaldifeat may modify the input
             
             // Kaldifeat processes audio in frames, so we need to call AcceptWaveform
             kaldifeat_fbank_->AcceptWaveform(config_.sample_rate, audio_copy);
@@ -128,22 +136,21 @@ std::vector<std::vector<float>> KaldifeatExtractor::computeFeatures(const std::v
             // Signal end of input
             kaldifeat_fbank_->InputFinished();
             
-            // Extract features
-            std::vector<std::vector<float>> features;
+            // Extract features straight into the output rows
             int num_frames = kaldifeat_fbank_->NumFramesReady();
+            out.setLayout(FeatureLayout::FRAMES_BY_BINS);
+            out.resize(num_frames, kaldifeat_fbank_->Dim());
             
             for (int i = 0; i < num_frames; ++i) {
-                std::vector<float> frame_features(kaldifeat_fbank_->Dim());
-                kaldifeat_fbank_->GetFrame(i, frame_features.data());
-                features.push_back(std::move(frame_features));
+                kaldifeat_fbank_->GetFrame(i, out.frame(i));
             }
             
             // Apply CMVN if available
             if (cmvn_loaded_ && config_.apply_cmvn) {
-                applyCmvn(features);
+                applyCmvn(out);
             }
             
-            return features;
+            return;
             
         } catch (const std::exception& e) {
             std::cerr << "Error in kaldifeat feature extraction: " << e.what() << std::endl;
@@ -156,14 +163,14 @@ std::vector<std::vector<float>> KaldifeatExtractor::computeFeatures(const std::v
     // Use simple_fbank (either as fallback or primary)
     {
         // Use simple_fbank fallback
-        auto features = simple_fbank_->computeFeatures(audio);
+        out.setLayout(FeatureLayout::FRAMES_BY_BINS);
+        out.resize(simple_fbank_->numFrames(num_samples), simple_fbank_->getFeatureDim());
+        simple_fbank_->computeFeatures(audio, num_samples, out.data());
         
         // Apply CMVN if available
         if (cmvn_loaded_ && config_.apply_cmvn) {
-            applyCmvn(features);
+            applyCmvn(out);
         }
-        
-        return features;
     }
 }
 
@@ -227,11 +234,13 @@ bool KaldifeatExtractor::loadCmvnStats(const std::string& stats_path) {
     return false;
 }
 
-void KaldifeatExtractor::applyCmvn(std::vector<std::vector<float>>& features) {
+void KaldifeatExtractor::applyCmvn(FeatureMatrix& features) {
     if (cmvn_mean_.empty() || cmvn_var_.empty()) return;
     
-    for (auto& frame : features) {
-        for (size_t i = 0; i < frame.size() && i < cmvn_mean_.size(); ++i) {
+    size_t dim = std::min(features.numBins(), cmvn_mean_.size());
+    for (size_t f = 0; f < features.numFrames(); ++f) {
+        float* frame = features.frame(f);
+        for (size_t i = 0; i < dim; ++i) {
             frame[i] = (frame[i] - cmvn_mean_[i]) / cmvn_var_[i];
         }
     }
@@ -239,9 +248,7 @@ void KaldifeatExtractor::applyCmvn(std::vector<std::vector<float>>& features) {
 
 std::vector<float> KaldifeatExtractor::convertInt16ToFloat(const int16_t* samples, size_t num_samples) {
     std::vector<float> result(num_samples);
-    for (size_t i = 0; i < num_samples; ++i) {
-        result[i] = static_cast<float>(samples[i]) / 32768.0f;
-    }
+    AudioPreprocessor::convertInt16ToFloat(samples, num_samples, result.data());
     return result;
 }
 
@@ -266,6 +273,12 @@ std::vector<std::vector<float>> SimpleFbankExtractor::computeFeatures(const std:
     return fbank_->computeFeatures(audio);
 }
 
+void SimpleFbankExtractor::computeFeatures(const float* audio, size_t num_samples, FeatureMatrix& out) {
+    out.setLayout(FeatureLayout::FRAMES_BY_BINS);
+    out.resize(fbank_->numFrames(num_samples), fbank_->getFeatureDim());
+    fbank_->computeFeatures(audio, num_samples, out.data());
+}
+
 std::vector<std::vector<float>> SimpleFbankExtractor::computeFeatures(const int16_t* samples, size_t num_samples) {
     auto audio_float = convertInt16ToFloat(samples, num_samples);
     return computeFeatures(audio_float);
@@ -273,9 +286,7 @@ std::vector<std::vector<float>> SimpleFbankExtractor::computeFeatures(const int1
 
 std::vector<float> SimpleFbankExtractor::convertInt16ToFloat(const int16_t* samples, size_t num_samples) {
     std::vector<float> result(num_samples);
-    for (size_t i = 0; i < num_samples; ++i) {
-        result[i] = static_cast<float>(samples[i]) / 32768.0f;
-    }
+    AudioPreprocessor::convertInt16ToFloat(samples, num_samples, result.data());
     return result;
 }
 
@@ -1,10 +1,16 @@
 #include "ProvenFeatureExtractor.hpp"
+#include "RealFFT.hpp"
 #include <algorithm>
-#include <complex>
 #include <iostream>
 #include <cmath>
+#include <string>
 
 ProvenFeatureExtractor::ProvenFeatureExtractor() {
+    // NeMo dither (1e-05) with a fixed seed, so features are reproducible
+    onnx_stt::AudioPreprocessor::Options dither_opts;
+    dither_opts.dither = 1e-05f;
+    dither_opts.seed = 42;
+    dither_ = onnx_stt::AudioPreprocessor(dither_opts);
 }
 
 std::vector<float> ProvenFeatureExtractor::extractMelSpectrogram(
@@ -19,15 +25,9 @@ std::vector<float> ProvenFeatureExtractor::extractMelSpectrogram(
         return {};
     }
     
-    // Apply dithering like NeMo (dither: 1e-05)
-    std::vector<float> dithered_audio = audio_data;
-    const float dither_value = 1e-05f;
-    srand(42); // Fixed seed for reproducibility
-    for (size_t i = 0; i < dithered_audio.size(); i++) {
-        // Add small random noise for dithering
-        float noise = ((rand() / float(RAND_MAX)) - 0.5f) * 2.0f * dither_value;
-        dithered_audio[i] += noise;
-    }
+    // Apply dithering like NeMo (dither: 1e-05), continuing the stream's sequence
+    std::vector<float> dithered_audio(audio_data.size());
+    dither_.process(audio_data.data(), audio_data.size(), dithered_audio.data());
     
     try {
         // Use exact librosa/NeMo parameters
@@ -46,7 +46,7 @@ std::vector<float> ProvenFeatureExtractor::extractMelSpectrogram(
         std::cout << "Processing " << num_frames << " frames with librosa-based method" << std::endl;
         
         // Create mel filterbank (same as librosa)
-        auto mel_basis = createMelFilterbank(n_mels, n_fft, sample_rate);
+        auto mel_basis = getMelFilterbank(n_mels, n_fft, sample_rate);
         
         std::vector<float> mel_features;
         mel_features.reserve(num_frames * n_mels);
@@ -65,7 +65,7 @@ std::vector<float> ProvenFeatureExtractor::extractMelSpectrogram(
             auto power_spectrum = computeLibrosaFFT(windowed_frame);
             
             // Apply mel filterbank
-            auto mel_frame = applyMelFilterbank(power_spectrum, mel_basis);
+            auto mel_frame = applyMelFilterbank(power_spectrum, *mel_basis);
             
             // Add to output
             mel_features.insert(mel_features.end(), mel_frame.begin(), mel_frame.end());
@@ -127,26 +127,9 @@ std::vector<float> ProvenFeatureExtractor::applyWindow(
 }
 
 std::vector<float> ProvenFeatureExtractor::computeLibrosaFFT(const std::vector<float>& windowed_frame) {
+    // Shared 512-point plan, cached per size like ProvenFeatureExtractor.cpp
     const int N_FFT = 512;
-    int fft_size = N_FFT / 2 + 1;  // Only positive frequencies
-    
-    std::vector<float> power_spectrum(fft_size);
-    
-    // Compute DFT for positive frequencies only
-    for (int k = 0; k < fft_size; k++) {
-        std::complex<float> sum(0.0f, 0.0f);
-        
-        for (int n = 0; n < N_FFT; n++) {
-            float angle = -2.0f * PI * k * n / N_FFT;
-            std::complex<float> exp_term(std::cos(angle), std::sin(angle));
-            sum += windowed_frame[n] * exp_term;
-        }
-        
-        // Power spectrum = |X(k)|^2
-        power_spectrum[k] = std::norm(sum);
-    }
-    
-    return power_spectrum;
+    return onnx_stt::RealFFT::get(N_FFT)->powerSpectrum(windowed_frame);
 }
 
 std::vector<std::vector<float>> ProvenFeatureExtractor::createMelFilterbank(
@@ -213,25 +196,26 @@ std::vector<std::vector<float>> ProvenFeatureExtractor::createMelFilterbank(
     return mel_basis;
 }
 
+std::shared_ptr<const onnx_stt::MelFilterbank> ProvenFeatureExtractor::getMelFilterbank(
+    int n_mels, int n_fft, int sample_rate) {
+    // Different filter layout from ProvenFeatureExtractor.cpp (fmax = sr/2, rounded bins)
+    std::string key = "librosa:" + std::to_string(n_mels) + ":" + std::to_string(n_fft) +
+                      ":" + std::to_string(sample_rate);
+    return onnx_stt::MelFilterbank::get(key, [&]() {
+        return createMelFilterbank(n_mels, n_fft, sample_rate);
+    });
+}
+
 std::vector<float> ProvenFeatureExtractor::applyMelFilterbank(
     const std::vector<float>& power_spectrum,
-    const std::vector<std::vector<float>>& mel_basis) {
-    
-    int n_mels = mel_basis.size();
-    std::vector<float> mel_features(n_mels);
+    const onnx_stt::MelFilterbank& mel_basis) {
     
     // Apply mel filterbank: mel_spec = mel_basis @ power_spectrum
-    for (int m = 0; m < n_mels; m++) {
-        float filter_output = 0.0f;
-        
-        for (size_t bin = 0; bin < power_spectrum.size(); bin++) {
-            if (bin < mel_basis[m].size()) {
-                filter_output += mel_basis[m][bin] * power_spectrum[bin];
-            }
-        }
-        
-        // Apply log transform
-        mel_features[m] = std::log(filter_output + 1e-10f);
+    std::vector<float> mel_features = mel_basis.apply(power_spectrum);
+    
+    // Apply log transform
+    for (float& value : mel_features) {
+        value = std::log(value + 1e-10f);
     }
     
     return mel_features;
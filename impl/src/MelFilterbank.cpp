@@ -0,0 +1,154 @@
+#include "MelFilterbank.hpp"
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace onnx_stt {
+
+const int MelFilterbank::kBlock;
+
+MelFilterbank::MelFilterbank(const std::vector<std::vector<float>>& dense)
+    : num_bins_(dense.empty() ? 0 : static_cast<int>(dense[0].size())) {
+    starts_.reserve(dense.size());
+    lengths_.reserve(dense.size());
+    offsets_.reserve(dense.size());
+
+    for (const auto& filter : dense) {
+        int first = 0;
+        int last = static_cast<int>(filter.size()) - 1;
+        while (first <= last && filter[first] == 0.0f) {
+            ++first;
+        }
+        while (last >= first && filter[last] == 0.0f) {
+            --last;
+        }
+
+        int length = last >= first ? last - first + 1 : 0;
+        starts_.push_back(length > 0 ? first : 0);
+        lengths_.push_back(length);
+        offsets_.push_back(static_cast<int>(weights_.size()));
+        weights_.insert(weights_.end(), filter.begin() + first, filter.begin() + first + length);
+    }
+
+    // Blocks of kBlock neighbouring filters over the union of their bins,
+    // bin-major with zeros where a filter does not reach
+    for (int block = 0; block * kBlock < numFilters(); ++block) {
+        int first = num_bins_;
+        int last = 0;
+        for (int m = block * kBlock; m < std::min(numFilters(), (block + 1) * kBlock); ++m) {
+            if (lengths_[m] > 0) {
+                first = std::min(first, starts_[m]);
+                last = std::max(last, starts_[m] + lengths_[m]);
+            }
+        }
+        int length = last > first ? last - first : 0;
+        block_starts_.push_back(length > 0 ? first : 0);
+        block_lengths_.push_back(length);
+        block_offsets_.push_back(static_cast<int>(block_weights_.size()));
+        block_weights_.resize(block_weights_.size() + static_cast<size_t>(length) * kBlock, 0.0f);
+        float* weights = block_weights_.data() + block_offsets_.back();
+        for (int lane = 0; lane < kBlock && block * kBlock + lane < numFilters(); ++lane) {
+            int m = block * kBlock + lane;
+            for (int k = 0; k < lengths_[m]; ++k) {
+                weights[(starts_[m] - first + k) * kBlock + lane] = weights_[offsets_[m] + k];
+            }
+        }
+    }
+}
+
+std::shared_ptr<const MelFilterbank> MelFilterbank::get(
+    const std::string& key,
+    const std::function<std::vector<std::vector<float>>()>& build_dense) {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const MelFilterbank>> banks;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = banks.find(key);
+    if (it != banks.end()) {
+        return it->second;
+    }
+
+    auto bank = std::make_shared<const MelFilterbank>(build_dense());
+    banks[key] = bank;
+    return bank;
+}
+
+void MelFilterbank::apply(const float* power, float* out) const {
+    const int num_filters = numFilters();
+#if defined(__AVX2__) || defined(__ARM_NEON)
+    // Vectorized across filters: each bin of a block is one broadcast
+    // multiply-add into kBlock per-filter sums, with no horizontal reduction
+    for (size_t block = 0; block < block_starts_.size(); ++block) {
+        const float* w = block_weights_.data() + block_offsets_[block];
+        const float* x = power + block_starts_[block];
+        const int n = block_lengths_[block];
+        float sums[kBlock];
+#if defined(__AVX2__)
+        __m256 acc = _mm256_setzero_ps();
+        for (int k = 0; k < n; ++k) {
+#if defined(__FMA__)
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(w + k * kBlock), _mm256_set1_ps(x[k]), acc);
+#else
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(w + k * kBlock), _mm256_set1_ps(x[k])));
+#endif
+        }
+        _mm256_storeu_ps(sums, acc);
+#else
+        float32x4_t lo = vdupq_n_f32(0.0f);
+        float32x4_t hi = vdupq_n_f32(0.0f);
+        for (int k = 0; k < n; ++k) {
+            lo = vmlaq_n_f32(lo, vld1q_f32(w + k * kBlock), x[k]);
+            hi = vmlaq_n_f32(hi, vld1q_f32(w + k * kBlock + 4), x[k]);
+        }
+        vst1q_f32(sums, lo);
+        vst1q_f32(sums + 4, hi);
+#endif
+        const int first = static_cast<int>(block) * kBlock;
+        std::copy(sums, sums + std::min(kBlock, num_filters - first), out + first);
+    }
+#else
+    // Scalar: one filter at a time over only the bins it covers (the blocks'
+    // zero padding costs more than it saves without vector lanes)
+    const float* weights = weights_.data();
+    for (int m = 0; m < num_filters; ++m) {
+        const float* w = weights + offsets_[m];
+        const float* x = power + starts_[m];
+        float sum = 0.0f;
+        for (int k = 0; k < lengths_[m]; ++k) {
+            sum += w[k] * x[k];
+        }
+        out[m] = sum;
+    }
+#endif
+}
+
+std::vector<float> MelFilterbank::apply(const std::vector<float>& power) const {
+    std::vector<float> out(numFilters(), 0.0f);
+    if (static_cast<int>(power.size()) < num_bins_) {
+        // Short spectrum: fall back to a zero-extended copy so filters never read past the end
+        std::vector<float> padded(power);
+        padded.resize(num_bins_, 0.0f);
+        apply(padded.data(), out.data());
+    } else {
+        apply(power.data(), out.data());
+    }
+    return out;
+}
+
+std::vector<std::vector<float>> MelFilterbank::toDense() const {
+    std::vector<std::vector<float>> dense(numFilters(), std::vector<float>(num_bins_, 0.0f));
+    for (int m = 0; m < numFilters(); ++m) {
+        for (int k = 0; k < lengths_[m]; ++k) {
+            dense[m][starts_[m] + k] = weights_[offsets_[m] + k];
+        }
+    }
+    return dense;
+}
+
+} // namespace onnx_stt
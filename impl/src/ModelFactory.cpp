@@ -31,7 +31,14 @@ std::unique_ptr<ModelInterface> createNeMoModel(const ModelInterface::ModelConfi
     NeMoCacheAwareConformer::NeMoConfig nemo_config;
     nemo_config.model_path = config.encoder_path;  // NeMo uses single model file
     nemo_config.num_threads = config.num_threads;
+    nemo_config.cache_optimized_model = config.cache_optimized_model;
+    nemo_config.memory_map_model = config.memory_map_model;
+    nemo_config.quantized_encoder = config.quantized_encoder;
+    nemo_config.fixed_shape_encoder = config.fixed_shape_encoder;
+    nemo_config.blank_skip_threshold = config.blank_skip_threshold;
     nemo_config.chunk_frames = config.chunk_frames;
+    nemo_config.first_chunk_frames = config.first_chunk_frames;
+    nemo_config.chunk_ramp = config.chunk_ramp;
     nemo_config.feature_dim = config.feature_dim;
     nemo_config.batch_size = 1;
     
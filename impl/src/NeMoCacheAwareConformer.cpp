@@ -4,35 +4,104 @@
 #include <chrono>
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace onnx_stt {
 
+namespace {
+
+bool contains(const std::string& name, const char* part) {
+    return name.find(part) != std::string::npos;
+}
+
+// Model shape with the dynamic batch dimension set to batch and any other
+// dynamic dimension taken from the configured default shape
+std::vector<int64_t> resolveShape(std::vector<int64_t> model_shape, const std::vector<int64_t>& defaults,
+                                  int batch_axis, int64_t batch) {
+    if (model_shape.size() != defaults.size()) {
+        return defaults;
+    }
+    for (size_t i = 0; i < model_shape.size(); ++i) {
+        if (model_shape[i] < 0) {
+            model_shape[i] = static_cast<int>(i) == batch_axis ? batch : defaults[i];
+        }
+    }
+    return model_shape;
+}
+
+// Mel frames of the previous chunk the encoder's pre-encode stage needs again
+size_t preEncodeFrames(const NeMoCacheAwareConformer::NeMoConfig& config) {
+    return static_cast<size_t>(config.pre_encode_cache_frames >= 0 ?
+        config.pre_encode_cache_frames : config.subsampling_factor + 1);
+}
+
+// New frames per chunk: what fits in input_frames after the pre-encode
+// context, rounded down to a multiple of the subsampling factor
+size_t stepFrames(const NeMoCacheAwareConformer::NeMoConfig& config, size_t input_frames) {
+    size_t context = preEncodeFrames(config);
+    size_t factor = static_cast<size_t>(std::max(config.subsampling_factor, 1));
+    return input_frames > context ? (input_frames - context) / factor * factor : 0;
+}
+
+void appendText(std::string& text, const std::string& piece) {
+    if (!text.empty() && !piece.empty()) {
+        text += " ";
+    }
+    text += piece;
+}
+
+} // namespace
+
 NeMoCacheAwareConformer::NeMoCacheAwareConformer(const NeMoConfig& config)
+    : NeMoCacheAwareConformer(config, nullptr) {}
+
+NeMoCacheAwareConformer::NeMoCacheAwareConformer(const NeMoConfig& config,
+                                                 std::shared_ptr<const SharedModel> model)
     : config_(config)
+    , model_(std::move(model))
     , memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
+    , input_frames_(0)
+    , cache_slot_(0)
     , cache_initialized_(false)
+    , logits_bound_(false)
     , total_chunks_processed_(0)
     , total_processing_time_ms_(0)
     , cache_updates_(0)
-    , vocab_loaded_(false) {
-    
-    // Initialize ONNX Runtime environment
-    env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "NeMoCacheAwareConformer");
-    
-    // Setup input/output names for NeMo CTC model (no cache)
-    input_names_ = {
-        "audio_signal"        // Features input: [batch, time, features]
-    };
-    
-    output_names_ = {
-        "log_probs"           // CTC log probabilities: [batch, time, num_classes]
-    };
+    , last_chunk_latency_us_(0)
+    , total_chunk_latency_us_(0)
+    , ort_output_allocations_(0)
+    , cache_bytes_copied_(0)
+    , ctc_frames_(0)
+    , ctc_frames_skipped_(0)
+    , ctc_decode_us_(0)
+    , padded_frames_(0)
+    , stream_frames_(0)
+    , first_token_seen_(false)
+    , first_token_ms_(-1.0)
+    , first_token_audio_ms_(-1.0) {
 }
 
 NeMoCacheAwareConformer::~NeMoCacheAwareConformer() {
     // Cleanup handled by unique_ptr destructors
 }
 
+std::shared_ptr<const NeMoCacheAwareConformer::SharedModel> NeMoCacheAwareConformer::loadSharedModel(
+    const NeMoConfig& config) {
+    auto model = std::make_shared<SharedModel>();
+    if (!initializeONNXSession(config, *model)) {
+        return nullptr;
+    }
+    
+    // Load vocabulary if path provided
+    if (!config.vocab_path.empty()) {
+        if (!loadVocabulary(config.vocab_path, *model)) {
+            std::cerr << "Warning: Failed to load vocabulary from " << config.vocab_path << std::endl;
+            std::cerr << "Token decoding will output token IDs instead of text" << std::endl;
+        }
+    }
+    return model;
+}
+
 bool NeMoCacheAwareConformer::initialize(const ModelConfig& config) {
     model_config_ = config;
     
@@ -42,9 +111,13 @@ bool NeMoCacheAwareConformer::initialize(const ModelConfig& config) {
     std::cout << "Attention context: [" << config_.att_context_size_left 
               << "," << config_.att_context_size_right << "]" << std::endl;
     
-    if (!initializeONNXSession()) {
-        std::cerr << "Failed to initialize ONNX session" << std::endl;
-        return false;
+    // Streams created from a loaded model share it and skip straight to their own state
+    if (!model_) {
+        model_ = loadSharedModel(config_);
+        if (!model_) {
+            std::cerr << "Failed to initialize ONNX session" << std::endl;
+            return false;
+        }
     }
     
     if (!initializeCacheTensors()) {
@@ -52,45 +125,84 @@ bool NeMoCacheAwareConformer::initialize(const ModelConfig& config) {
         return false;
     }
     
-    // Load vocabulary if path provided
-    if (!config_.vocab_path.empty()) {
-        if (!loadVocabulary(config_.vocab_path)) {
-            std::cerr << "Warning: Failed to load vocabulary from " << config_.vocab_path << std::endl;
-            std::cerr << "Token decoding will output token IDs instead of text" << std::endl;
-        }
+    if (config_.use_io_binding && !initializeIoBindings()) {
+        std::cerr << "Failed to initialize IoBinding" << std::endl;
+        return false;
     }
     
     std::cout << "NeMo Cache-Aware Conformer initialized successfully" << std::endl;
     return true;
 }
 
-bool NeMoCacheAwareConformer::initializeONNXSession() {
+std::unique_ptr<ModelInterface> NeMoCacheAwareConformer::createStream() const {
+    if (!model_) {
+        return nullptr;
+    }
+    std::unique_ptr<NeMoCacheAwareConformer> stream(new NeMoCacheAwareConformer(config_, model_));
+    if (!stream->initialize(model_config_)) {
+        return nullptr;
+    }
+    return std::unique_ptr<ModelInterface>(std::move(stream));
+}
+
+bool NeMoCacheAwareConformer::initializeONNXSession(const NeMoConfig& config, SharedModel& model) {
     try {
         // Check if model file exists
-        std::ifstream model_file(config_.model_path);
+        std::ifstream model_file(config.model_path);
         if (!model_file.good()) {
-            std::cerr << "Model file not found: " << config_.model_path << std::endl;
+            std::cerr << "Model file not found: " << config.model_path << std::endl;
             return false;
         }
         
-        // Configure session options
-        Ort::SessionOptions session_options;
-        session_options.SetIntraOpNumThreads(config_.num_threads);
-        session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+        // Shared session on the process-wide thread pools
+        OrtRuntime::SessionConfig session_config;
+        session_config.intra_op_threads = config.num_threads;
+        session_config.cache_optimized_model = config.cache_optimized_model;
+        session_config.memory_map = config.memory_map_model;
+        const std::string model_path = OrtRuntime::selectModel(config.model_path, config.quantized_encoder);
+        model.session = OrtRuntime::instance().getSession(model_path, session_config);
         
-        // Create session
-        session_ = std::make_unique<Ort::Session>(*env_, config_.model_path.c_str(), session_options);
+        // Fixed-shape mode: every chunk is one pre-encode context plus one step, so
+        // pin the audio input's free dimensions to that shape and reload. The
+        // registry keeps one specialized session per shape; the dynamic one is dropped.
+        if (config.fixed_shape_encoder) {
+            const int64_t window = static_cast<int64_t>(
+                preEncodeFrames(config) + stepFrames(config, static_cast<size_t>(config.chunk_frames)));
+            Ort::AllocatorWithDefaultOptions name_allocator;
+            for (size_t i = 0; i < model.session->GetInputCount(); ++i) {
+                std::string name = model.session->GetInputNameAllocated(i, name_allocator).get();
+                if (name != "audio_signal" && name != "processed_signal") {
+                    continue;
+                }
+                session_config.free_dimension_overrides = OrtRuntime::fixedShapeOverrides(
+                    *model.session, i, {config.batch_size, window, config.feature_dim});
+                break;
+            }
+            if (session_config.free_dimension_overrides.empty()) {
+                std::cout << "Model has no named free dimensions; keeping the dynamic-shape session" << std::endl;
+            } else {
+                model.session = OrtRuntime::instance().getSession(model_path, session_config);
+                model.fixed_shape = true;
+                for (const auto& dim : session_config.free_dimension_overrides) {
+                    std::cout << "Pinned dimension " << dim.first << " = " << dim.second << std::endl;
+                }
+            }
+        }
         
         // Verify model inputs/outputs
-        size_t num_inputs = session_->GetInputCount();
-        size_t num_outputs = session_->GetOutputCount();
+        size_t num_inputs = model.session->GetInputCount();
+        size_t num_outputs = model.session->GetOutputCount();
         
         std::cout << "Model loaded: " << num_inputs << " inputs, " << num_outputs << " outputs" << std::endl;
         
-        // Print input/output info for debugging
+        // Read input/output names once; the const char* arrays point into the storage
+        Ort::AllocatorWithDefaultOptions allocator;
+        model.input_name_storage.clear();
+        model.output_name_storage.clear();
         for (size_t i = 0; i < num_inputs; ++i) {
-            auto input_name = session_->GetInputNameAllocated(i, Ort::AllocatorWithDefaultOptions());
-            auto input_shape = session_->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape();
+            auto input_name = model.session->GetInputNameAllocated(i, allocator);
+            model.input_name_storage.push_back(input_name.get());
+            auto input_shape = model.session->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape();
             std::cout << "Input " << i << ": " << input_name.get() << " shape: [";
             for (size_t j = 0; j < input_shape.size(); ++j) {
                 std::cout << input_shape[j];
@@ -98,6 +210,96 @@ bool NeMoCacheAwareConformer::initializeONNXSession() {
             }
             std::cout << "]" << std::endl;
         }
+        for (size_t i = 0; i < num_outputs; ++i) {
+            auto output_name = model.session->GetOutputNameAllocated(i, allocator);
+            model.output_name_storage.push_back(output_name.get());
+        }
+        
+        model.input_names.clear();
+        model.output_names.clear();
+        for (const auto& name : model.input_name_storage) model.input_names.push_back(name.c_str());
+        for (const auto& name : model.output_name_storage) model.output_names.push_back(name.c_str());
+        
+        // Classify inputs: features, length and the cache-aware streaming state
+        for (size_t i = 0; i < model.input_name_storage.size(); ++i) {
+            const std::string& name = model.input_name_storage[i];
+            int index = static_cast<int>(i);
+            if (name == "audio_signal" || name == "processed_signal") {
+                model.audio_input_index = index;
+            } else if (name == "length" || name == "processed_signal_length") {
+                model.length_input_index = index;
+            } else if (contains(name, "cache_last_channel_len")) {
+                model.channel_len_input_index = index;
+            } else if (contains(name, "cache_last_channel")) {
+                model.channel_cache_input_index = index;
+            } else if (contains(name, "cache_last_time")) {
+                model.time_cache_input_index = index;
+            } else {
+                std::cerr << "Unsupported model input: " << name << std::endl;
+                return false;
+            }
+        }
+        if (model.audio_input_index < 0) {
+            std::cerr << "Model has no audio_signal input" << std::endl;
+            return false;
+        }
+        auto audio_shape = model.session->GetInputTypeInfo(model.audio_input_index).GetTensorTypeAndShapeInfo().GetShape();
+        model.model_batch_dim = audio_shape.empty() ? 1 : audio_shape[0];
+        model.model_time_dim = audio_shape.size() > 1 ? audio_shape[1] : -1;
+        
+        // Classify outputs: logits plus the updated cache (encoded lengths are not used)
+        for (size_t i = 0; i < model.output_name_storage.size(); ++i) {
+            const std::string& name = model.output_name_storage[i];
+            int index = static_cast<int>(i);
+            if (contains(name, "cache_last_channel") && contains(name, "len")) {
+                model.channel_len_output_index = index;
+            } else if (contains(name, "cache_last_channel")) {
+                model.channel_cache_output_index = index;
+            } else if (contains(name, "cache_last_time")) {
+                model.time_cache_output_index = index;
+            } else if (model.logits_output_index < 0 && !contains(name, "length")) {
+                model.logits_output_index = index;
+            }
+        }
+        if (model.logits_output_index < 0) {
+            std::cerr << "Model has no logits output" << std::endl;
+            return false;
+        }
+        
+        if ((model.channel_cache_input_index < 0) != (model.time_cache_input_index < 0)) {
+            std::cerr << "Model has only one of cache_last_channel/cache_last_time" << std::endl;
+            return false;
+        }
+        
+        // Models exported without cache support run stateless
+        if (model.channel_cache_input_index < 0) {
+            std::cout << "Model has no cache inputs; running without streaming cache" << std::endl;
+            return true;
+        }
+        
+        auto model_channel_shape =
+            model.session->GetInputTypeInfo(model.channel_cache_input_index).GetTensorTypeAndShapeInfo().GetShape();
+        
+        // The batch axis is the first dynamic one (newer exports put it first);
+        // the configured layout has it second
+        model.cache_batch_axis = 1;
+        for (size_t i = 0; i < model_channel_shape.size(); ++i) {
+            if (model_channel_shape[i] < 0) {
+                model.cache_batch_axis = static_cast<int>(i);
+                break;
+            }
+        }
+        
+        // cache_last_channel: [layers, batch, cache_size, hidden]
+        model.channel_cache_shape = resolveShape(model_channel_shape,
+            {config.num_cache_layers, config.batch_size, config.last_channel_cache_size, config.hidden_size},
+            model.cache_batch_axis, config.batch_size);
+        
+        // cache_last_time: [layers, batch, hidden, cache_size]
+        model.time_cache_shape = resolveShape(
+            model.session->GetInputTypeInfo(model.time_cache_input_index).GetTensorTypeAndShapeInfo().GetShape(),
+            {config.num_cache_layers, config.batch_size, config.hidden_size, config.last_time_cache_size},
+            model.cache_batch_axis, config.batch_size);
         
         return true;
         
@@ -112,15 +314,59 @@ bool NeMoCacheAwareConformer::initializeONNXSession() {
 
 bool NeMoCacheAwareConformer::initializeCacheTensors() {
     try {
-        // Initialize cache_last_channel: [layers, batch, cache_size, hidden]
-        size_t channel_cache_size = config_.num_cache_layers * config_.batch_size * 
-                                   config_.last_channel_cache_size * config_.hidden_size;
-        cache_last_channel_.resize(channel_cache_size, 0.0f);
+        // Chunk geometry: an export with a fixed time dimension sets the window,
+        // otherwise chunk_frames does; either way the step is subsampling-aligned
+        size_t context = preEncodeFrames(config_);
+        size_t step = stepFrames(config_, model_->model_time_dim > 0 ?
+            static_cast<size_t>(model_->model_time_dim) : static_cast<size_t>(config_.chunk_frames));
+        if (step == 0) {
+            throw std::runtime_error("Chunk of " + std::to_string(config_.chunk_frames) +
+                                     " frames leaves no room after " + std::to_string(context) +
+                                     " pre-encode cache frames");
+        }
+        feature_ring_ = FeatureRing(static_cast<size_t>(config_.feature_dim), context, step,
+                                    static_cast<size_t>(config_.subsampling_factor), config_.feature_pad_value);
+        input_frames_ = model_->model_time_dim > 0 ? static_cast<size_t>(model_->model_time_dim) : context + step;
+        std::cout << "Chunking: " << step << " new frames + " << context << " pre-encode cache frames ("
+                  << input_frames_ << " encoder input frames)" << std::endl;
         
-        // Initialize cache_last_time: [layers, batch, hidden, cache_size]  
-        size_t time_cache_size = config_.num_cache_layers * config_.batch_size *
-                                config_.hidden_size * config_.last_time_cache_size;
-        cache_last_time_.resize(time_cache_size, 0.0f);
+        // Shorter first chunks: first_chunk_frames, then chunk_ramp steps growing
+        // evenly to the full step, all rounded down to the subsampling factor
+        size_t factor = static_cast<size_t>(std::max(config_.subsampling_factor, 1));
+        size_t first = static_cast<size_t>(std::max(config_.first_chunk_frames, 0)) / factor * factor;
+        std::vector<size_t> ramp;
+        if (first > 0 && first < step) {
+            int ramp_chunks = std::max(config_.chunk_ramp, 0);
+            for (int i = 0; i <= ramp_chunks; ++i) {
+                size_t frames = first + (step - first) * static_cast<size_t>(i) / static_cast<size_t>(ramp_chunks + 1);
+                ramp.push_back(frames / factor * factor);
+            }
+            std::cout << "First chunks: ";
+            for (size_t frames : ramp) {
+                std::cout << frames << " ";
+            }
+            std::cout << "new frames" << std::endl;
+        }
+        feature_ring_.setRamp(ramp);
+        
+        // Persistent input buffers, allocated once so IoBinding can bind them
+        audio_signal_buffer_.assign(config_.batch_size * input_frames_ * config_.feature_dim, 0.0f);
+        length_buffer_.assign(config_.batch_size, static_cast<int64_t>(input_frames_));
+        
+        // Models exported without cache support run stateless
+        if (model_->channel_cache_shape.empty()) {
+            cache_initialized_ = true;
+            return true;
+        }
+        
+        size_t channel_cache_size = elementCount(model_->channel_cache_shape);
+        size_t time_cache_size = elementCount(model_->time_cache_shape);
+        for (int slot = 0; slot < 2; ++slot) {
+            cache_last_channel_[slot].assign(channel_cache_size, 0.0f);
+            cache_last_time_[slot].assign(time_cache_size, 0.0f);
+            cache_last_channel_len_[slot].assign(config_.batch_size, 0);
+        }
+        cache_slot_ = 0;
         
         cache_initialized_ = true;
         
@@ -136,7 +382,370 @@ bool NeMoCacheAwareConformer::initializeCacheTensors() {
     }
 }
 
-bool NeMoCacheAwareConformer::loadVocabulary(const std::string& vocab_path) {
+bool NeMoCacheAwareConformer::initializeIoBindings() {
+    try {
+        const int64_t audio_shape[3] = {config_.batch_size, static_cast<int64_t>(input_frames_),
+                                        config_.feature_dim};
+        const int64_t batch_shape[1] = {config_.batch_size};
+        bool has_cache = !model_->channel_cache_shape.empty();
+        
+        // Binding p reads the cache from slot p and writes the update to slot 1-p,
+        // so advancing a chunk is a swap of cache_slot_ with no copy or rebinding
+        for (int slot = 0; slot < 2; ++slot) {
+            int next = 1 - slot;
+            io_bindings_[slot] = std::make_unique<Ort::IoBinding>(*model_->session);
+            Ort::IoBinding& binding = *io_bindings_[slot];
+            
+            binding.BindInput(model_->input_names[model_->audio_input_index], Ort::Value::CreateTensor<float>(
+                memory_info_, audio_signal_buffer_.data(), audio_signal_buffer_.size(), audio_shape, 3));
+            if (model_->length_input_index >= 0) {
+                binding.BindInput(model_->input_names[model_->length_input_index], Ort::Value::CreateTensor<int64_t>(
+                    memory_info_, length_buffer_.data(), length_buffer_.size(), batch_shape, 1));
+            }
+            
+            binding.BindOutput(model_->output_names[model_->logits_output_index], memory_info_);
+            
+            if (!has_cache) {
+                continue;
+            }
+            
+            binding.BindInput(model_->input_names[model_->channel_cache_input_index], Ort::Value::CreateTensor<float>(
+                memory_info_, cache_last_channel_[slot].data(), cache_last_channel_[slot].size(),
+                model_->channel_cache_shape.data(), model_->channel_cache_shape.size()));
+            binding.BindInput(model_->input_names[model_->time_cache_input_index], Ort::Value::CreateTensor<float>(
+                memory_info_, cache_last_time_[slot].data(), cache_last_time_[slot].size(),
+                model_->time_cache_shape.data(), model_->time_cache_shape.size()));
+            if (model_->channel_len_input_index >= 0) {
+                binding.BindInput(model_->input_names[model_->channel_len_input_index], Ort::Value::CreateTensor<int64_t>(
+                    memory_info_, cache_last_channel_len_[slot].data(), cache_last_channel_len_[slot].size(),
+                    batch_shape, 1));
+            }
+            
+            if (model_->channel_cache_output_index >= 0) {
+                binding.BindOutput(model_->output_names[model_->channel_cache_output_index], Ort::Value::CreateTensor<float>(
+                    memory_info_, cache_last_channel_[next].data(), cache_last_channel_[next].size(),
+                    model_->channel_cache_shape.data(), model_->channel_cache_shape.size()));
+            }
+            if (model_->time_cache_output_index >= 0) {
+                binding.BindOutput(model_->output_names[model_->time_cache_output_index], Ort::Value::CreateTensor<float>(
+                    memory_info_, cache_last_time_[next].data(), cache_last_time_[next].size(),
+                    model_->time_cache_shape.data(), model_->time_cache_shape.size()));
+            }
+            if (model_->channel_len_output_index >= 0) {
+                binding.BindOutput(model_->output_names[model_->channel_len_output_index], Ort::Value::CreateTensor<int64_t>(
+                    memory_info_, cache_last_channel_len_[next].data(), cache_last_channel_len_[next].size(),
+                    batch_shape, 1));
+            }
+        }
+        
+        logits_bound_ = false;
+        std::cout << "IoBinding enabled (" << (has_cache ? "ping-pong cache buffers" : "no cache")
+                  << ")" << std::endl;
+        return true;
+        
+    } catch (const Ort::Exception& e) {
+        std::cerr << "ONNX Runtime error: " << e.what() << std::endl;
+        return false;
+    } catch (const std::exception& e) {
+        std::cerr << "Error initializing IoBinding: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void NeMoCacheAwareConformer::bindLogitsOutput() {
+    // Output shape is fixed by the fixed input size, so one buffer serves every chunk
+    for (int slot = 0; slot < 2; ++slot) {
+        io_bindings_[slot]->BindOutput(model_->output_names[model_->logits_output_index], Ort::Value::CreateTensor<float>(
+            memory_info_, logits_buffer_.data(), logits_buffer_.size(), logits_shape_.data(), logits_shape_.size()));
+    }
+    logits_bound_ = true;
+}
+
+bool NeMoCacheAwareConformer::runWithIoBinding(const float*& logits, std::vector<int64_t>& logits_shape) {
+    Ort::IoBinding& binding = *io_bindings_[cache_slot_];
+    model_->session->Run(Ort::RunOptions{nullptr}, binding);
+    
+    if (!logits_bound_) {
+        // First chunk: ORT allocated the logits; adopt their shape for a persistent buffer
+        // (logits are bound first, so they are output value 0)
+        std::vector<Ort::Value> outputs = binding.GetOutputValues();
+        ort_output_allocations_++;
+        if (outputs.empty()) {
+            return false;
+        }
+        logits_shape_ = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
+        const float* data = outputs[0].GetTensorData<float>();
+        logits_buffer_.assign(data, data + elementCount(logits_shape_));
+        bindLogitsOutput();
+    }
+    
+    if (!model_->channel_cache_shape.empty()) {
+        // The other slot now holds the updated cache
+        cache_slot_ = 1 - cache_slot_;
+        cache_updates_++;
+    }
+    
+    logits = logits_buffer_.data();
+    logits_shape = logits_shape_;
+    return true;
+}
+
+std::vector<Ort::Value> NeMoCacheAwareConformer::prepareInputs(int slot, size_t time_frames) {
+    const int64_t audio_shape[3] = {config_.batch_size, static_cast<int64_t>(time_frames),
+                                    config_.feature_dim};
+    const size_t audio_elements = static_cast<size_t>(config_.batch_size) * time_frames * config_.feature_dim;
+    const int64_t batch_shape[1] = {config_.batch_size};
+    
+    std::vector<Ort::Value> inputs;
+    for (size_t i = 0; i < model_->input_names.size(); ++i) {
+        int index = static_cast<int>(i);
+        if (index == model_->audio_input_index) {
+            inputs.push_back(Ort::Value::CreateTensor<float>(
+                memory_info_, audio_signal_buffer_.data(), audio_elements, audio_shape, 3));
+        } else if (index == model_->length_input_index) {
+            inputs.push_back(Ort::Value::CreateTensor<int64_t>(
+                memory_info_, length_buffer_.data(), length_buffer_.size(), batch_shape, 1));
+        } else if (index == model_->channel_cache_input_index) {
+            inputs.push_back(Ort::Value::CreateTensor<float>(
+                memory_info_, cache_last_channel_[slot].data(), cache_last_channel_[slot].size(),
+                model_->channel_cache_shape.data(), model_->channel_cache_shape.size()));
+        } else if (index == model_->time_cache_input_index) {
+            inputs.push_back(Ort::Value::CreateTensor<float>(
+                memory_info_, cache_last_time_[slot].data(), cache_last_time_[slot].size(),
+                model_->time_cache_shape.data(), model_->time_cache_shape.size()));
+        } else {
+            inputs.push_back(Ort::Value::CreateTensor<int64_t>(
+                memory_info_, cache_last_channel_len_[slot].data(), cache_last_channel_len_[slot].size(),
+                batch_shape, 1));
+        }
+    }
+    return inputs;
+}
+
+int NeMoCacheAwareConformer::getMaxBatchSize() const {
+    return model_->model_batch_dim > 0 ? static_cast<int>(model_->model_batch_dim) : std::numeric_limits<int>::max();
+}
+
+NeMoCacheAwareConformer::StreamCache NeMoCacheAwareConformer::createStreamCache() const {
+    StreamCache cache;
+    if (!model_->channel_cache_shape.empty()) {
+        cache.cache_last_channel.assign(elementCount(withBatch(model_->channel_cache_shape, model_->cache_batch_axis, 1)), 0.0f);
+        cache.cache_last_time.assign(elementCount(withBatch(model_->time_cache_shape, model_->cache_batch_axis, 1)), 0.0f);
+        cache.cache_last_channel_len.assign(1, 0);
+    }
+    // Same chunking (context, step, ramp) as this instance's own stream
+    cache.ring = feature_ring_;
+    cache.ring.reset();
+    return cache;
+}
+
+void NeMoCacheAwareConformer::resetStreamCache(StreamCache& cache) const {
+    std::fill(cache.cache_last_channel.begin(), cache.cache_last_channel.end(), 0.0f);
+    std::fill(cache.cache_last_time.begin(), cache.cache_last_time.end(), 0.0f);
+    std::fill(cache.cache_last_channel_len.begin(), cache.cache_last_channel_len.end(), 0);
+    cache.ring.reset();
+}
+
+bool NeMoCacheAwareConformer::processBatch(std::vector<BatchEntry>& entries) {
+    if (entries.empty()) {
+        return true;
+    }
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    try {
+        if (!cache_initialized_) {
+            throw std::runtime_error("Cache tensors not initialized");
+        }
+        if (static_cast<int>(entries.size()) > getMaxBatchSize()) {
+            throw std::runtime_error("Batch of " + std::to_string(entries.size()) +
+                                     " exceeds the model's batch dimension");
+        }
+        for (size_t b = 0; b < entries.size(); ++b) {
+            if (!entries[b].features.empty() &&
+                entries[b].features.numBins() != static_cast<size_t>(config_.feature_dim)) {
+                throw std::runtime_error("Feature dimension mismatch in batch entry " + std::to_string(b));
+            }
+        }
+        
+        // Buffer every stream's frames; a chunk longer than one window is split
+        // over several rounds, and a remainder waits for the stream's next chunk
+        for (auto& entry : entries) {
+            entry.result->text.clear();
+            entry.result->confidence = 0.0f;
+            entry.result->is_final = true;
+            if (!entry.features.empty()) {
+                entry.cache->ring.push(entry.features);
+            }
+        }
+        
+        std::vector<size_t> round;
+        while (true) {
+            round.clear();
+            for (size_t b = 0; b < entries.size(); ++b) {
+                const FeatureRing& ring = entries[b].cache->ring;
+                if (ring.ready() || (entries[b].end_of_stream && ring.pendingFrames() > 0)) {
+                    round.push_back(b);
+                }
+            }
+            if (round.empty()) {
+                break;
+            }
+            runBatchRound(entries, round);
+        }
+        
+        // The next chunk of an ended stream starts with fresh context
+        for (auto& entry : entries) {
+            if (entry.end_of_stream) {
+                entry.cache->ring.reset();
+            }
+        }
+        
+        uint64_t batch_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start_time).count());
+        for (auto& entry : entries) {
+            entry.result->latency_ms = batch_us / 1000;
+        }
+        total_processing_time_ms_ += batch_us / 1000;
+        last_chunk_latency_us_ = batch_us;
+        return true;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error in processBatch: " << e.what() << std::endl;
+        for (auto& entry : entries) {
+            entry.result->text = "";
+            entry.result->confidence = 0.0f;
+            entry.result->is_final = false;
+        }
+        return false;
+    }
+}
+
+void NeMoCacheAwareConformer::runBatchRound(std::vector<BatchEntry>& entries, const std::vector<size_t>& round) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    const int64_t batch = static_cast<int64_t>(round.size());
+    const size_t feature_dim = static_cast<size_t>(config_.feature_dim);
+    const size_t frame_block = input_frames_ * feature_dim;
+    const bool has_cache = !model_->channel_cache_shape.empty();
+    
+    // Gather one window per stream: [batch, input_frames_, features], each
+    // padded on its own past its window and masked by the length input
+    batch_audio_.resize(batch * frame_block);
+    batch_length_.resize(batch);
+    for (int64_t b = 0; b < batch; ++b) {
+        FeatureRing& ring = entries[round[b]].cache->ring;
+        float* dst = batch_audio_.data() + b * frame_block;
+        size_t window_frames;
+        if (ring.ready()) {
+            window_frames = ring.pop(dst);
+        } else {
+            window_frames = ring.popFinal(dst);
+            padded_frames_ += ring.paddedFrames();
+        }
+        std::fill(dst + window_frames * feature_dim, dst + frame_block, config_.feature_pad_value);
+        batch_length_[b] = static_cast<int64_t>(window_frames);
+    }
+    
+    // Gather caches along the batch axis
+    std::vector<int64_t> channel_shape, time_shape;
+    const int64_t batch_shape[1] = {batch};
+    if (has_cache) {
+        channel_shape = withBatch(model_->channel_cache_shape, model_->cache_batch_axis, batch);
+        time_shape = withBatch(model_->time_cache_shape, model_->cache_batch_axis, batch);
+        std::vector<const float*> channel_in, time_in;
+        std::vector<const int64_t*> len_in;
+        for (size_t index : round) {
+            channel_in.push_back(entries[index].cache->cache_last_channel.data());
+            time_in.push_back(entries[index].cache->cache_last_time.data());
+            len_in.push_back(entries[index].cache->cache_last_channel_len.data());
+        }
+        batch_channel_cache_.resize(elementCount(channel_shape));
+        batch_time_cache_.resize(elementCount(time_shape));
+        batch_channel_len_.resize(batch);
+        gatherBatch(channel_in, channel_shape, model_->cache_batch_axis, batch_channel_cache_.data());
+        gatherBatch(time_in, time_shape, model_->cache_batch_axis, batch_time_cache_.data());
+        gatherBatch(len_in, {batch}, 0, batch_channel_len_.data());
+    }
+    
+    const int64_t audio_shape[3] = {batch, static_cast<int64_t>(input_frames_), config_.feature_dim};
+    std::vector<Ort::Value> inputs;
+    for (size_t i = 0; i < model_->input_names.size(); ++i) {
+        int index = static_cast<int>(i);
+        if (index == model_->audio_input_index) {
+            inputs.push_back(Ort::Value::CreateTensor<float>(
+                memory_info_, batch_audio_.data(), batch_audio_.size(), audio_shape, 3));
+        } else if (index == model_->length_input_index) {
+            inputs.push_back(Ort::Value::CreateTensor<int64_t>(
+                memory_info_, batch_length_.data(), batch_length_.size(), batch_shape, 1));
+        } else if (index == model_->channel_cache_input_index) {
+            inputs.push_back(Ort::Value::CreateTensor<float>(
+                memory_info_, batch_channel_cache_.data(), batch_channel_cache_.size(),
+                channel_shape.data(), channel_shape.size()));
+        } else if (index == model_->time_cache_input_index) {
+            inputs.push_back(Ort::Value::CreateTensor<float>(
+                memory_info_, batch_time_cache_.data(), batch_time_cache_.size(),
+                time_shape.data(), time_shape.size()));
+        } else {
+            inputs.push_back(Ort::Value::CreateTensor<int64_t>(
+                memory_info_, batch_channel_len_.data(), batch_channel_len_.size(), batch_shape, 1));
+        }
+    }
+    
+    auto outputs = model_->session->Run(
+        Ort::RunOptions{nullptr},
+        model_->input_names.data(), inputs.data(), inputs.size(),
+        model_->output_names.data(), model_->output_names.size());
+    ort_output_allocations_ += outputs.size();
+    
+    // Scatter updated caches back to their streams
+    if (has_cache && model_->channel_cache_output_index >= 0 && model_->time_cache_output_index >= 0) {
+        std::vector<float*> channel_out, time_out;
+        std::vector<int64_t*> len_out;
+        for (size_t index : round) {
+            channel_out.push_back(entries[index].cache->cache_last_channel.data());
+            time_out.push_back(entries[index].cache->cache_last_time.data());
+            len_out.push_back(entries[index].cache->cache_last_channel_len.data());
+        }
+        scatterBatch(outputs[model_->channel_cache_output_index].GetTensorData<float>(),
+                     channel_shape, model_->cache_batch_axis, channel_out);
+        scatterBatch(outputs[model_->time_cache_output_index].GetTensorData<float>(),
+                     time_shape, model_->cache_batch_axis, time_out);
+        if (model_->channel_len_output_index >= 0) {
+            scatterBatch(outputs[model_->channel_len_output_index].GetTensorData<int64_t>(),
+                         {batch}, 0, len_out);
+        }
+        cache_bytes_copied_ += 2 * (batch_channel_cache_.size() + batch_time_cache_.size()) * sizeof(float);
+        cache_updates_++;
+    }
+    
+    // Decode each stream's slice of the [batch, seq_len, num_classes] logits,
+    // leaving out the output frames of the padding past its window
+    auto& log_probs_tensor = outputs[model_->logits_output_index];
+    auto log_probs_shape = log_probs_tensor.GetTensorTypeAndShapeInfo().GetShape();
+    if (log_probs_shape.size() < 3 || log_probs_shape[0] != batch) {
+        throw std::runtime_error("Unexpected logits shape from NeMo model");
+    }
+    const float* log_probs_data = log_probs_tensor.GetTensorData<float>();
+    const int64_t seq_len_out = log_probs_shape[1];
+    const int64_t num_classes = log_probs_shape[2];
+    const int64_t factor = std::max(config_.subsampling_factor, 1);
+    
+    for (int64_t b = 0; b < batch; ++b) {
+        int64_t padding_out = (static_cast<int64_t>(input_frames_) - batch_length_[b]) / factor;
+        int64_t valid_out = std::max<int64_t>(seq_len_out - padding_out, 0);
+        TranscriptionResult& result = *entries[round[b]].result;
+        appendText(result.text, decodeCTCTokens(log_probs_data + b * seq_len_out * num_classes,
+                                                valid_out, num_classes));
+        result.confidence = 0.85f;  // Placeholder confidence
+    }
+    
+    uint64_t round_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start_time).count());
+    total_chunks_processed_ += batch;
+    total_chunk_latency_us_ += round_us;
+}
+
+bool NeMoCacheAwareConformer::loadVocabulary(const std::string& vocab_path, SharedModel& model) {
     try {
         std::ifstream vocab_file(vocab_path);
         if (!vocab_file.is_open()) {
@@ -144,7 +753,7 @@ bool NeMoCacheAwareConformer::loadVocabulary(const std::string& vocab_path) {
             return false;
         }
         
-        vocabulary_.clear();
+        model.vocabulary.clear();
         std::string line;
         
         while (std::getline(vocab_file, line)) {
@@ -152,22 +761,22 @@ bool NeMoCacheAwareConformer::loadVocabulary(const std::string& vocab_path) {
             // Extract just the token part
             size_t tab_pos = line.find('\t');
             if (tab_pos != std::string::npos) {
-                vocabulary_.push_back(line.substr(tab_pos + 1));
+                model.vocabulary.push_back(line.substr(tab_pos + 1));
             } else {
-                vocabulary_.push_back(line);
+                model.vocabulary.push_back(line);
             }
         }
         
         vocab_file.close();
-        vocab_loaded_ = true;
+        model.vocab_loaded = true;
         
-        std::cout << "Loaded vocabulary with " << vocabulary_.size() << " tokens from " << vocab_path << std::endl;
+        std::cout << "Loaded vocabulary with " << model.vocabulary.size() << " tokens from " << vocab_path << std::endl;
         
         // Print first few tokens for verification
-        if (vocabulary_.size() >= 10) {
+        if (model.vocabulary.size() >= 10) {
             std::cout << "First 10 tokens: ";
             for (size_t i = 0; i < 10; ++i) {
-                std::cout << "[" << i << "]=" << vocabulary_[i] << " ";
+                std::cout << "[" << i << "]=" << model.vocabulary[i] << " ";
             }
             std::cout << std::endl;
         }
@@ -182,6 +791,13 @@ bool NeMoCacheAwareConformer::loadVocabulary(const std::string& vocab_path) {
 
 ModelInterface::TranscriptionResult NeMoCacheAwareConformer::processChunk(const std::vector<std::vector<float>>& features,
                                                                      uint64_t timestamp_ms) {
+    // Legacy adapter: pack the nested frames once and use the contiguous path
+    FeatureMatrix matrix = FeatureMatrix::fromNested(features);
+    return processChunk(matrix.view(), timestamp_ms);
+}
+
+ModelInterface::TranscriptionResult NeMoCacheAwareConformer::processChunk(const FeatureView& features,
+                                                                     uint64_t timestamp_ms) {
     auto start_time = std::chrono::high_resolution_clock::now();
     
     ModelInterface::TranscriptionResult result;
@@ -194,152 +810,174 @@ ModelInterface::TranscriptionResult NeMoCacheAwareConformer::processChunk(const
             throw std::runtime_error("Cache tensors not initialized");
         }
         
-        if (features.empty() || features[0].empty()) {
+        if (features.empty()) {
             throw std::runtime_error("Empty features provided");
         }
         
-        // Prepare input tensors
-        
-        // 1. Audio signal tensor: [batch, time, features] = [1, time_frames, 80]
-        size_t batch_size = 1;
-        size_t feature_dim = features[0].size();
-        size_t time_frames = features.size();
-        
-        // NeMo model expects exactly 160 input frames (40 after subsampling factor 4)
-        // This matches the hardcoded attention reshape {40,4,44}
-        size_t required_frames = 160;  // Fixed size for this specific model
-        
-        std::cout << "Processing chunk: " << time_frames << " frames";
-        if (time_frames != required_frames) {
-            std::cout << " (padding to " << required_frames << " for model compatibility)";
+        if (features.numBins() != static_cast<size_t>(config_.feature_dim)) {
+            throw std::runtime_error("Feature dimension mismatch: got " + std::to_string(features.numBins()) +
+                                     ", model expects " + std::to_string(config_.feature_dim));
         }
-        std::cout << std::endl;
-        
-        // Pad or truncate features to exactly 160 frames
-        std::vector<std::vector<float>> padded_features;
-        padded_features.reserve(required_frames);
         
-        for (size_t i = 0; i < required_frames; ++i) {
-            if (i < time_frames) {
-                // Use original feature
-                padded_features.push_back(features[i]);
-            } else {
-                // Pad with zero vector
-                padded_features.push_back(std::vector<float>(feature_dim, 0.0f));
-            }
+        if (stream_frames_ == 0) {
+            stream_start_ = std::chrono::steady_clock::now();
         }
-        time_frames = required_frames;
-        
-        // Flatten features for ONNX (keep [time, features] format as [batch, time, features])
-        std::vector<float> audio_signal_data;
-        audio_signal_data.reserve(batch_size * time_frames * feature_dim);
-        
-        // Debug: Check feature statistics
-        float min_feat = std::numeric_limits<float>::max();
-        float max_feat = std::numeric_limits<float>::lowest();
-        float sum_feat = 0.0f;
+        stream_frames_ += features.numFrames();
         
-        for (size_t time = 0; time < time_frames; ++time) {
-            for (size_t feat = 0; feat < feature_dim; ++feat) {
-                float val = padded_features[time][feat];
-                audio_signal_data.push_back(val);
-                min_feat = std::min(min_feat, val);
-                max_feat = std::max(max_feat, val);
-                sum_feat += val;
-            }
+        // Buffer the frames and encode every complete subsampling-aligned chunk;
+        // a remainder waits for the next call (or flush() at end of stream)
+        feature_ring_.push(features);
+        bool encoded = false;
+        while (feature_ring_.ready()) {
+            size_t window_frames = feature_ring_.pop(audio_signal_buffer_.data());
+            appendText(result.text, encodeWindow(window_frames));
+            encoded = true;
         }
+        noteText(result.text);
+        result.confidence = encoded ? 0.85f : 0.0f;  // Placeholder confidence
         
-        float avg_feat = sum_feat / (time_frames * feature_dim);
-        std::cout << "Feature stats: min=" << min_feat << ", max=" << max_feat 
-                  << ", avg=" << avg_feat << std::endl;
-        
-        std::vector<int64_t> audio_signal_shape = {static_cast<int64_t>(batch_size), 
-                                                  static_cast<int64_t>(time_frames),
-                                                  static_cast<int64_t>(feature_dim)};
-        auto audio_signal_tensor = Ort::Value::CreateTensor<float>(
-            memory_info_, audio_signal_data.data(), audio_signal_data.size(),
-            audio_signal_shape.data(), audio_signal_shape.size());
-        
-        // Prepare input vector (NeMo CTC model only needs audio_signal)
-        std::vector<Ort::Value> input_tensors;
-        input_tensors.push_back(std::move(audio_signal_tensor));
+    } catch (const std::exception& e) {
+        std::cerr << "Error in processChunk: " << e.what() << std::endl;
+        result.text = "";
+        result.confidence = 0.0f;
+        result.is_final = false;
+    }
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    result.latency_ms = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+    return result;
+}
+
+ModelInterface::TranscriptionResult NeMoCacheAwareConformer::flush(uint64_t timestamp_ms) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    ModelInterface::TranscriptionResult result;
+    result.timestamp_ms = timestamp_ms;
+    result.is_final = true;
+    result.confidence = 0.0f;
+    
+    try {
+        if (!cache_initialized_) {
+            throw std::runtime_error("Cache tensors not initialized");
+        }
         
-        // Run inference
-        auto output_tensors = session_->Run(
-            Ort::RunOptions{nullptr},
-            input_names_.data(), input_tensors.data(), input_tensors.size(),
-            output_names_.data(), output_names_.size());
-        
-        // Process outputs
-        if (output_tensors.size() >= 1) {
-            // Extract log_probs output: [batch, seq_len, num_classes]
-            auto& log_probs_tensor = output_tensors[0];
-            float* log_probs_data = log_probs_tensor.GetTensorMutableData<float>();
-            auto log_probs_shape = log_probs_tensor.GetTensorTypeAndShapeInfo().GetShape();
-            
-            // Shape should be [1, seq_len//4, 128] due to subsampling in our model
-            int64_t seq_len_out = log_probs_shape[1]; 
-            int64_t num_classes = log_probs_shape[2];
-            
-            // Decode CTC output (simplified - argmax for now)
-            result.text = decodeCTCTokens(log_probs_data, seq_len_out, num_classes);
+        size_t window_frames = feature_ring_.popFinal(audio_signal_buffer_.data());
+        if (window_frames > 0) {
+            padded_frames_ += feature_ring_.paddedFrames();
+            result.text = encodeWindow(window_frames);
             result.confidence = 0.85f;  // Placeholder confidence
-            
-        } else {
-            throw std::runtime_error("No output tensors from NeMo model");
+            noteText(result.text);
         }
         
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-        result.latency_ms = static_cast<uint64_t>(duration.count());
-        
-        updateStats(duration.count());
+        // The next frame starts a new stream
+        stream_frames_ = 0;
+        first_token_seen_ = false;
         
     } catch (const std::exception& e) {
-        std::cerr << "Error in processChunk: " << e.what() << std::endl;
+        std::cerr << "Error in flush: " << e.what() << std::endl;
         result.text = "";
-        result.confidence = 0.0f;
         result.is_final = false;
-        
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-        result.latency_ms = static_cast<uint64_t>(duration.count());
     }
     
+    auto end_time = std::chrono::high_resolution_clock::now();
+    result.latency_ms = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
     return result;
 }
 
+void NeMoCacheAwareConformer::noteText(const std::string& text) {
+    if (first_token_seen_ || text.empty()) {
+        return;
+    }
+    first_token_seen_ = true;
+    first_token_ms_ = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - stream_start_).count();
+    first_token_audio_ms_ = static_cast<double>(stream_frames_) * 10.0;  // 10 ms frame shift
+}
+
+std::string NeMoCacheAwareConformer::encodeWindow(size_t window_frames) {
+    // The window is already in the persistent [batch, time, features] input
+    // buffer. A ramp chunk on a dynamic-shape export runs at its own length
+    // through plain Run() (the bindings and logits buffer are sized for full
+    // chunks); otherwise any tail past the window is masked by the length input.
+    auto start_time = std::chrono::high_resolution_clock::now();
+    const bool exact_shape = window_frames < input_frames_ && model_->model_time_dim < 0;
+    
+    const size_t feature_dim = static_cast<size_t>(config_.feature_dim);
+    std::fill(audio_signal_buffer_.begin() + window_frames * feature_dim, audio_signal_buffer_.end(),
+              config_.feature_pad_value);
+    std::fill(length_buffer_.begin(), length_buffer_.end(), static_cast<int64_t>(window_frames));
+    
+    // Run inference
+    const float* log_probs_data = nullptr;
+    std::vector<int64_t> log_probs_shape;
+    std::vector<Ort::Value> output_tensors;  // keeps ORT-allocated outputs alive (plain Run)
+    
+    if (config_.use_io_binding && !exact_shape) {
+        if (!runWithIoBinding(log_probs_data, log_probs_shape)) {
+            throw std::runtime_error("No output tensors from NeMo model");
+        }
+    } else {
+        std::vector<Ort::Value> input_tensors = prepareInputs(cache_slot_, exact_shape ? window_frames : input_frames_);
+        output_tensors = model_->session->Run(
+            Ort::RunOptions{nullptr},
+            model_->input_names.data(), input_tensors.data(), input_tensors.size(),
+            model_->output_names.data(), model_->output_names.size());
+        ort_output_allocations_ += output_tensors.size();
+        
+        if (static_cast<int>(output_tensors.size()) > model_->logits_output_index) {
+            updateCacheFromOutputs(output_tensors);
+            auto& log_probs_tensor = output_tensors[model_->logits_output_index];
+            log_probs_data = log_probs_tensor.GetTensorData<float>();
+            log_probs_shape = log_probs_tensor.GetTensorTypeAndShapeInfo().GetShape();
+        }
+    }
+    
+    if (log_probs_data == nullptr || log_probs_shape.size() < 3) {
+        throw std::runtime_error("No output tensors from NeMo model");
+    }
+    
+    // log_probs: [batch, seq_len, num_classes], seq_len = window / subsampling
+    std::string text = decodeCTCTokens(log_probs_data, log_probs_shape[1], log_probs_shape[2]);
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    last_chunk_latency_us_ = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count());
+    total_chunk_latency_us_ += last_chunk_latency_us_;
+    updateStats(last_chunk_latency_us_ / 1000);
+    return text;
+}
+
 void NeMoCacheAwareConformer::updateCacheFromOutputs(std::vector<Ort::Value>& outputs) {
+    // Plain Run() path: copy the updated cache back into the current slot
     try {
-        if (outputs.size() >= 4) {
-            // Update cache_last_channel from output[2]
-            auto& new_channel_cache = outputs[2];
-            float* new_channel_data = new_channel_cache.GetTensorMutableData<float>();
-            auto channel_shape = new_channel_cache.GetTensorTypeAndShapeInfo().GetShape();
+        if (model_->channel_cache_output_index >= 0 && model_->time_cache_output_index >= 0) {
+            std::vector<float>& channel_cache = cache_last_channel_[cache_slot_];
+            std::vector<float>& time_cache = cache_last_time_[cache_slot_];
             
-            size_t channel_cache_elements = 1;
-            for (auto dim : channel_shape) {
-                channel_cache_elements *= static_cast<size_t>(dim);
-            }
+            auto& new_channel_cache = outputs[model_->channel_cache_output_index];
+            const float* new_channel_data = new_channel_cache.GetTensorData<float>();
+            size_t channel_cache_elements = elementCount(new_channel_cache.GetTensorTypeAndShapeInfo().GetShape());
             
-            if (channel_cache_elements <= cache_last_channel_.size()) {
-                std::copy(new_channel_data, new_channel_data + channel_cache_elements, 
-                         cache_last_channel_.begin());
+            if (channel_cache_elements <= channel_cache.size()) {
+                std::copy(new_channel_data, new_channel_data + channel_cache_elements, channel_cache.begin());
+                cache_bytes_copied_ += channel_cache_elements * sizeof(float);
             }
             
-            // Update cache_last_time from output[3]
-            auto& new_time_cache = outputs[3];
-            float* new_time_data = new_time_cache.GetTensorMutableData<float>();
-            auto time_shape = new_time_cache.GetTensorTypeAndShapeInfo().GetShape();
+            auto& new_time_cache = outputs[model_->time_cache_output_index];
+            const float* new_time_data = new_time_cache.GetTensorData<float>();
+            size_t time_cache_elements = elementCount(new_time_cache.GetTensorTypeAndShapeInfo().GetShape());
             
-            size_t time_cache_elements = 1;
-            for (auto dim : time_shape) {
-                time_cache_elements *= static_cast<size_t>(dim);
+            if (time_cache_elements <= time_cache.size()) {
+                std::copy(new_time_data, new_time_data + time_cache_elements, time_cache.begin());
+                cache_bytes_copied_ += time_cache_elements * sizeof(float);
             }
             
-            if (time_cache_elements <= cache_last_time_.size()) {
-                std::copy(new_time_data, new_time_data + time_cache_elements,
-                         cache_last_time_.begin());
+            if (model_->channel_len_output_index >= 0) {
+                const int64_t* new_len = outputs[model_->channel_len_output_index].GetTensorData<int64_t>();
+                std::copy(new_len, new_len + cache_last_channel_len_[cache_slot_].size(),
+                          cache_last_channel_len_[cache_slot_].begin());
             }
             
             cache_updates_++;
@@ -352,15 +990,25 @@ void NeMoCacheAwareConformer::updateCacheFromOutputs(std::vector<Ort::Value>& ou
 std::string NeMoCacheAwareConformer::decodeCTCTokens(const float* log_probs, int64_t seq_len, int64_t num_classes) {
     // Simple CTC decoding using argmax (greedy decoding)
     // In production, would use beam search CTC decoding
+    auto decode_start = std::chrono::steady_clock::now();
     
     std::vector<int> token_ids;
-    std::vector<float> max_probs;
+    
+    // Blank-dominated frames (log P(blank) above the threshold) skip the scan
+    const float skip_log_prob = config_.blank_skip_threshold > 0.0f ?
+        std::log(config_.blank_skip_threshold) : std::numeric_limits<float>::infinity();
     
     // Find best token for each time step
     for (int64_t t = 0; t < seq_len; ++t) {
         float max_prob = -std::numeric_limits<float>::infinity();
         int best_token = 0;
         
+        if (log_probs[t * num_classes] > skip_log_prob) {
+            token_ids.push_back(0);
+            ++ctc_frames_skipped_;
+            continue;
+        }
+        
         for (int64_t c = 0; c < num_classes; ++c) {
             float prob = log_probs[t * num_classes + c];
             if (prob > max_prob) {
@@ -370,17 +1018,6 @@ std::string NeMoCacheAwareConformer::decodeCTCTokens(const float* log_probs, int
         }
         
         token_ids.push_back(best_token);
-        max_probs.push_back(max_prob);
-    }
-    
-    // Debug: Print raw tokens for first few time steps
-    if (seq_len > 0) {
-        std::cout << "Raw CTC tokens: ";
-        for (int64_t t = 0; t < std::min(seq_len, static_cast<int64_t>(10)); ++t) {
-            std::cout << token_ids[t] << "(" << max_probs[t] << ") ";
-        }
-        if (seq_len > 10) std::cout << "...";
-        std::cout << std::endl;
     }
     
     // Simple CTC collapse - remove consecutive duplicates and blanks (token 0)
@@ -397,11 +1034,11 @@ std::string NeMoCacheAwareConformer::decodeCTCTokens(const float* log_probs, int
     // Convert token IDs to text using vocabulary
     std::string result;
     
-    if (vocab_loaded_ && !vocabulary_.empty()) {
+    if (model_->vocab_loaded && !model_->vocabulary.empty()) {
         // Use vocabulary to decode tokens
         for (int token_id : collapsed_tokens) {
-            if (token_id >= 0 && token_id < static_cast<int>(vocabulary_.size())) {
-                std::string token = vocabulary_[token_id];
+            if (token_id >= 0 && token_id < static_cast<int>(model_->vocabulary.size())) {
+                std::string token = model_->vocabulary[token_id];
                 
                 // Handle subword tokens (starting with ##)
                 if (token.substr(0, 2) == "##") {
@@ -426,6 +1063,9 @@ std::string NeMoCacheAwareConformer::decodeCTCTokens(const float* log_probs, int
         result += "]";
     }
     
+    ctc_frames_ += static_cast<uint64_t>(seq_len);
+    ctc_decode_us_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - decode_start).count());
     return result;
 }
 
@@ -444,14 +1084,31 @@ std::string NeMoCacheAwareConformer::decodeTokens(const float* /* logits */, siz
 }
 
 void NeMoCacheAwareConformer::reset() {
-    // Reset cache tensors to zero
-    std::fill(cache_last_channel_.begin(), cache_last_channel_.end(), 0.0f);
-    std::fill(cache_last_time_.begin(), cache_last_time_.end(), 0.0f);
+    // Reset both cache slots to zero (buffers stay bound)
+    for (int slot = 0; slot < 2; ++slot) {
+        std::fill(cache_last_channel_[slot].begin(), cache_last_channel_[slot].end(), 0.0f);
+        std::fill(cache_last_time_[slot].begin(), cache_last_time_[slot].end(), 0.0f);
+        std::fill(cache_last_channel_len_[slot].begin(), cache_last_channel_len_[slot].end(), 0);
+    }
+    cache_slot_ = 0;
+    feature_ring_.reset();
+    stream_frames_ = 0;
+    first_token_seen_ = false;
+    first_token_ms_ = -1.0;
+    first_token_audio_ms_ = -1.0;
     
     // Reset statistics
     total_chunks_processed_ = 0;
     total_processing_time_ms_ = 0;
     cache_updates_ = 0;
+    last_chunk_latency_us_ = 0;
+    total_chunk_latency_us_ = 0;
+    ort_output_allocations_ = 0;
+    cache_bytes_copied_ = 0;
+    padded_frames_ = 0;
+    ctc_frames_ = 0;
+    ctc_frames_skipped_ = 0;
+    ctc_decode_us_ = 0;
     
     std::cout << "NeMo Cache-Aware Conformer cache reset" << std::endl;
 }
@@ -472,9 +1129,37 @@ std::map<std::string, double> NeMoCacheAwareConformer::getStats() const {
     
     stats["model_type"] = 1.0; // Indicator for NeMo model
     stats["chunk_frames"] = static_cast<double>(config_.chunk_frames);
+    stats["chunk_step_frames"] = static_cast<double>(feature_ring_.stepFrames());
+    stats["pre_encode_cache_frames"] = static_cast<double>(feature_ring_.contextFrames());
+    stats["encoder_input_frames"] = static_cast<double>(input_frames_);
+    stats["pending_frames"] = static_cast<double>(feature_ring_.pendingFrames());
+    stats["padded_frames"] = static_cast<double>(padded_frames_);
+    stats["first_chunk_frames"] = static_cast<double>(
+        feature_ring_.ramp().empty() ? feature_ring_.stepFrames() : feature_ring_.ramp().front());
+    stats["time_to_first_token_ms"] = first_token_ms_;
+    stats["first_token_audio_ms"] = first_token_audio_ms_;
     stats["feature_dim"] = static_cast<double>(config_.feature_dim);
-    stats["cache_channel_size"] = static_cast<double>(cache_last_channel_.size());
-    stats["cache_time_size"] = static_cast<double>(cache_last_time_.size());
+    stats["cache_channel_size"] = static_cast<double>(cache_last_channel_[0].size());
+    stats["cache_time_size"] = static_cast<double>(cache_last_time_[0].size());
+    
+    // Per-chunk cost: latency plus ORT output allocations and cache copies
+    // (both stay at zero in IoBinding mode after the first chunk)
+    stats["io_binding"] = config_.use_io_binding ? 1.0 : 0.0;
+    stats["fixed_shape_encoder"] = model_ && model_->fixed_shape ? 1.0 : 0.0;
+    stats["last_chunk_latency_us"] = static_cast<double>(last_chunk_latency_us_);
+    stats["average_chunk_latency_us"] = total_chunks_processed_ > 0 ?
+        static_cast<double>(total_chunk_latency_us_) / static_cast<double>(total_chunks_processed_) : 0.0;
+    stats["ort_output_allocations"] = static_cast<double>(ort_output_allocations_);
+    stats["cache_bytes_copied"] = static_cast<double>(cache_bytes_copied_);
+    stats["ctc_frames"] = static_cast<double>(ctc_frames_);
+    stats["ctc_frames_blank_skipped"] = static_cast<double>(ctc_frames_skipped_);
+    stats["ctc_decode_us"] = static_cast<double>(ctc_decode_us_);
+    if (total_chunks_processed_ > 0) {
+        stats["ort_output_allocations_per_chunk"] = static_cast<double>(ort_output_allocations_) /
+                                                    static_cast<double>(total_chunks_processed_);
+        stats["cache_bytes_copied_per_chunk"] = static_cast<double>(cache_bytes_copied_) /
+                                                static_cast<double>(total_chunks_processed_);
+    }
     
     return stats;
 }
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <chrono>
 #include <cmath>
+#include <algorithm>
 
 namespace onnx_stt {
 
@@ -33,6 +34,12 @@ bool OnnxSTTImpl::initialize() {
         zipformer_config.num_threads = config_.num_threads;
         zipformer_config.chunk_size = 39;  // Zipformer expects 39 frames
         zipformer_config.beam_size = config_.beam_size;
+        zipformer_config.decoding_method = config_.decoding_method;
+        zipformer_config.max_symbols_per_frame = config_.max_symbols_per_frame;
+        zipformer_config.cache_optimized_model = config_.cache_optimized_model;
+        zipformer_config.memory_map_model = config_.memory_map_model;
+        zipformer_config.quantized_encoder = config_.quantized_encoder;
+        zipformer_config.fixed_shape_encoder = config_.fixed_shape_encoder;
         
         // Create and initialize ZipformerRNNT
         zipformer_ = std::make_unique<ZipformerRNNT>(zipformer_config);
@@ -41,6 +48,12 @@ bool OnnxSTTImpl::initialize() {
             return false;
         }
         
+        // Warm up with whole encoder chunks (10 ms frames)
+        if (config_.warmup_ms > 0) {
+            int chunk_ms = zipformer_config.chunk_size * 10;
+            zipformer_->warmUp((config_.warmup_ms + chunk_ms - 1) / chunk_ms);
+        }
+        
         // Initialize feature extraction (kaldifeat)
         simple_fbank::FbankComputer::Options fbank_opts;
         fbank_opts.sample_rate = config_.sample_rate;
@@ -72,16 +85,10 @@ OnnxSTTImpl::TranscriptionResult OnnxSTTImpl::processAudioChunk(
     try {
         // Stage 1: Voice Activity Detection (optional - for now process all audio)
         
-        // Stage 2: Convert int16 to float and buffer
-        std::vector<float> float_samples(num_samples);
-        for (size_t i = 0; i < num_samples; ++i) {
-            float_samples[i] = samples[i] / 32768.0f;
-        }
-        
-        // Add to audio buffer
-        audio_buffer_.insert(audio_buffer_.end(), 
-                           float_samples.begin(), 
-                           float_samples.end());
+        // Stage 2: Convert int16 to float directly into the tail of the audio buffer
+        size_t buffered = audio_buffer_.size();
+        audio_buffer_.resize(buffered + num_samples);
+        preprocessor_.process(samples, num_samples, audio_buffer_.data() + buffered);
         
         // Update stats
         stats_.total_audio_ms += (num_samples * 1000) / config_.sample_rate;
@@ -96,24 +103,16 @@ OnnxSTTImpl::TranscriptionResult OnnxSTTImpl::processAudioChunk(
             audio_buffer_.erase(audio_buffer_.begin(), 
                               audio_buffer_.begin() + samples_per_chunk);
             
-            // Stage 3: Feature extraction using kaldifeat
-            auto features_2d = fbank_->computeFeatures(chunk);
-            
-            // Flatten features for ZipformerRNNT (expects 1D vector)
-            std::vector<float> features_flat;
-            for (const auto& frame : features_2d) {
-                features_flat.insert(features_flat.end(), frame.begin(), frame.end());
-            }
-            
+            // Stage 3: Feature extraction straight into the flat [frames, 80] buffer
+            // ZipformerRNNT consumes (feature_buffer_ keeps its capacity across chunks)
             // Ensure we have exactly 39 frames worth of features (39 * 80 = 3120 floats)
             const size_t expected_size = 39 * 80;
-            if (features_flat.size() < expected_size) {
-                // Pad with zeros if needed
-                features_flat.resize(expected_size, 0.0f);
-            }
+            size_t feature_size = static_cast<size_t>(fbank_->numFrames(chunk.size())) * fbank_->getFeatureDim();
+            feature_buffer_.assign(std::max(feature_size, expected_size), 0.0f);
+            fbank_->computeFeatures(chunk.data(), chunk.size(), feature_buffer_.data());
             
             // Stage 4: Speech recognition using ZipformerRNNT
-            auto zipformer_result = zipformer_->processChunk(features_flat);
+            auto zipformer_result = zipformer_->processChunk(feature_buffer_);
             
             // Update result
             result.text = zipformer_result.text;
@@ -147,17 +146,14 @@ void OnnxSTTImpl::reset() {
     }
     audio_buffer_.clear();
     feature_buffer_.clear();
+    preprocessor_.reset();
     stats_ = Stats{};
 }
 
 std::vector<float> OnnxSTTImpl::extractFeatures(const std::vector<float>& audio) {
     // This is handled by fbank_ in processAudioChunk
-    // The FbankComputer returns 2D features, we need to flatten for compatibility
-    auto features_2d = fbank_->computeFeatures(audio);
-    std::vector<float> features_flat;
-    for (const auto& frame : features_2d) {
-        features_flat.insert(features_flat.end(), frame.begin(), frame.end());
-    }
+    std::vector<float> features_flat(static_cast<size_t>(fbank_->numFrames(audio.size())) * fbank_->getFeatureDim());
+    fbank_->computeFeatures(audio.data(), audio.size(), features_flat.data());
     return features_flat;
 }
 
@@ -22,8 +22,15 @@ public:
         implConfig.frame_shift_ms = config.frame_shift_ms;
         implConfig.beam_size = config.beam_size;
         implConfig.blank_id = config.blank_id;
+        implConfig.decoding_method = config.decoding_method;
+        implConfig.max_symbols_per_frame = config.max_symbols_per_frame;
         implConfig.num_threads = config.num_threads;
         implConfig.use_gpu = config.use_gpu;
+        implConfig.cache_optimized_model = config.cache_optimized_model;
+        implConfig.memory_map_model = config.memory_map_model;
+        implConfig.quantized_encoder = config.quantized_encoder;
+        implConfig.fixed_shape_encoder = config.fixed_shape_encoder;
+        implConfig.warmup_ms = config.warmup_ms;
         
         impl_ = std::make_unique<OnnxSTTImpl>(implConfig);
     }
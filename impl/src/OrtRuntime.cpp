@@ -0,0 +1,526 @@
+#include "OrtRuntime.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <cerrno>
+#include <fcntl.h>
+#include <onnxruntime_session_options_config_keys.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace onnx_stt {
+
+namespace {
+
+std::mutex g_config_mutex;
+OrtRuntime::Config g_config;
+bool g_created = false;
+
+Ort::ThreadingOptions makeThreadingOptions(const OrtRuntime::Config& config) {
+    Ort::ThreadingOptions options;
+    options.SetGlobalIntraOpNumThreads(config.intra_op_threads);
+    options.SetGlobalInterOpNumThreads(config.inter_op_threads);
+    options.SetGlobalSpinControl(config.allow_spinning ? 1 : 0);
+    return options;
+}
+
+// FNV-1a over 64-bit words; only has to tell model revisions apart, and reads
+// a few hundred MB in well under the time graph optimization takes
+bool hashFile(const std::string& path, uint64_t& hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    const uint64_t prime = 0x100000001B3ull;
+    hash = 0xCBF29CE484222325ull;
+    std::vector<char> block(1 << 20);
+    while (file) {
+        file.read(block.data(), block.size());
+        size_t count = static_cast<size_t>(file.gcount());
+        size_t words = count / 8;
+        for (size_t i = 0; i < words; ++i) {
+            uint64_t word;
+            std::memcpy(&word, block.data() + i * 8, 8);
+            hash = (hash ^ word) * prime;
+        }
+        for (size_t i = words * 8; i < count; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(block[i])) * prime;
+        }
+    }
+    return true;
+}
+
+bool fileExists(const std::string& path) {
+    return std::ifstream(path).good();
+}
+
+bool isOrtFormat(const std::string& path) {
+    return path.size() > 4 && path.compare(path.size() - 4, 4, ".ort") == 0;
+}
+
+// Read-only shared mapping of a whole file; pages come from the page cache and
+// are shared by every process mapping the same file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) : data_(nullptr), size_(0) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            throw std::runtime_error("cannot stat " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("cannot map " + path + ": " + std::strerror(errno));
+        }
+        data_ = data;
+    }
+    ~MappedFile() { munmap(data_, size_); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const void* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    void* data_;
+    size_t size_;
+};
+
+} // namespace
+
+std::string OrtRuntime::SessionConfig::key() const {
+    std::ostringstream key;
+    key << "opt" << static_cast<int>(optimization_level);
+    if (cache_optimized_model) {
+        key << "|cached";
+    }
+    if (memory_map) {
+        key << "|mmap";
+    }
+    for (const auto& dim : free_dimension_overrides) {
+        key << "|" << dim.first << "=" << dim.second;
+    }
+    if (use_global_threads) {
+        key << "|global";
+    } else {
+        key << "|intra" << intra_op_threads;
+    }
+    return key.str();
+}
+
+bool OrtRuntime::configure(const Config& config) {
+    std::lock_guard<std::mutex> lock(g_config_mutex);
+    if (g_created) {
+        return false;
+    }
+    g_config = config;
+    return true;
+}
+
+OrtRuntime& OrtRuntime::instance() {
+    // Never destroyed: sessions may still be referenced from other static
+    // objects during exit, and they must not outlive the Env
+    static OrtRuntime* runtime = [] {
+        std::lock_guard<std::mutex> lock(g_config_mutex);
+        g_created = true;
+        return new OrtRuntime(g_config);
+    }();
+    return *runtime;
+}
+
+OrtRuntime::OrtRuntime(const Config& config)
+    : config_(config)
+    , env_(makeThreadingOptions(config), ORT_LOGGING_LEVEL_WARNING, "onnx_stt")
+    , prepacked_weights_(nullptr)
+    , sessions_created_(0)
+    , sessions_reused_(0)
+    , optimized_cache_hits_(0)
+    , optimized_cache_writes_(0)
+    , total_load_ms_(0) {
+    Ort::ThrowOnError(Ort::GetApi().CreatePrepackedWeightsContainer(&prepacked_weights_));
+
+    std::cout << "ONNX Runtime environment created: global intra-op threads "
+              << config_.intra_op_threads << ", inter-op threads " << config_.inter_op_threads << std::endl;
+}
+
+OrtRuntime::~OrtRuntime() {
+    if (prepacked_weights_) {
+        Ort::GetApi().ReleasePrepackedWeightsContainer(prepacked_weights_);
+    }
+}
+
+std::shared_ptr<Ort::Session> OrtRuntime::getSession(const std::string& model_path,
+                                                     const SessionConfig& options) {
+    const std::string key = model_path + "|" + options.key();
+
+    std::promise<std::shared_ptr<Ort::Session>> promise;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        Entry& entry = sessions_[key];
+        auto session = entry.session.lock();
+        if (session) {
+            ++sessions_reused_;
+            return session;
+        }
+        if (entry.loading.valid()) {
+            // Another thread is loading this model; share its result
+            auto loading = entry.loading;
+            ++sessions_reused_;
+            lock.unlock();
+            return loading.get();
+        }
+        entry.loading = promise.get_future().share();
+    }
+
+    // Load without the lock so other models load at the same time
+    LoadTiming timing;
+    timing.model_path = model_path;
+    std::shared_ptr<Ort::Session> session;
+    std::exception_ptr error;
+    try {
+        session = createSession(model_path, options, timing);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = sessions_[key];
+        entry.loading = std::shared_future<std::shared_ptr<Ort::Session>>();
+        if (session) {
+            entry.session = session;
+            ++sessions_created_;
+            if (timing.optimized_cache_hit) {
+                ++optimized_cache_hits_;
+            }
+            if (timing.optimized_cache_written) {
+                ++optimized_cache_writes_;
+            }
+            total_load_ms_ += timing.read_ms + timing.create_ms;
+            load_timings_.push_back(timing);
+        }
+    }
+
+    if (error) {
+        promise.set_exception(error);
+        std::rethrow_exception(error);
+    }
+    promise.set_value(session);
+
+    std::cout << "Loaded ONNX session: " << model_path << " (read " << timing.read_ms
+              << " ms, create " << timing.create_ms << " ms)" << std::endl;
+    return session;
+}
+
+std::vector<std::shared_ptr<Ort::Session>> OrtRuntime::loadSessions(const std::vector<SessionRequest>& requests) {
+    std::vector<std::future<std::shared_ptr<Ort::Session>>> loads;
+    loads.reserve(requests.size());
+    for (const auto& request : requests) {
+        loads.push_back(std::async(std::launch::async, [this, &request] {
+            return getSession(request.model_path, request.options);
+        }));
+    }
+
+    // Collect every result before rethrowing, so no load outlives the call
+    std::vector<std::shared_ptr<Ort::Session>> sessions;
+    sessions.reserve(requests.size());
+    std::exception_ptr error;
+    for (auto& load : loads) {
+        try {
+            sessions.push_back(load.get());
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+            sessions.push_back(nullptr);
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return sessions;
+}
+
+void OrtRuntime::recordFirstRun(const std::string& model_path, double first_run_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = load_timings_.rbegin(); it != load_timings_.rend(); ++it) {
+        if (it->model_path == model_path) {
+            if (it->first_run_ms < 0) {
+                it->first_run_ms = first_run_ms;
+                std::cout << "First run: " << model_path << " (" << first_run_ms << " ms)" << std::endl;
+            }
+            return;
+        }
+    }
+}
+
+std::vector<OrtRuntime::LoadTiming> OrtRuntime::getLoadTimings() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return load_timings_;
+}
+
+std::shared_ptr<Ort::Session> OrtRuntime::createSession(const std::string& model_path,
+                                                        const SessionConfig& options,
+                                                        LoadTiming& timing) {
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    auto makeOptions = [&options](GraphOptimizationLevel level) {
+        Ort::SessionOptions session_options;
+        session_options.SetGraphOptimizationLevel(level);
+        if (options.use_global_threads) {
+            session_options.DisablePerSessionThreads();
+        } else {
+            session_options.SetIntraOpNumThreads(options.intra_op_threads);
+        }
+        if (options.memory_map) {
+            // Prepacked weights are private heap copies; kernels read the
+            // shared mapped initializers instead
+            session_options.AddConfigEntry(kOrtSessionOptionsConfigDisablePrepacking, "1");
+        }
+        for (const auto& dim : options.free_dimension_overrides) {
+            // Not wrapped by the C++ API in this ORT version
+            Ort::ThrowOnError(Ort::GetApi().AddFreeDimensionOverrideByName(session_options, dim.first.c_str(),
+                                                                           dim.second));
+        }
+        return session_options;
+    };
+
+    // Read phase: only hashing for the optimized model cache reads the file
+    // up front. Otherwise ORT's own load (or mapping) is the only read, and it
+    // is timed as part of session creation
+    auto read_start = Clock::now();
+    std::string cached_path;
+    if (options.cache_optimized_model) {
+        cached_path = optimizedModelPath(model_path, options);
+    }
+    timing.read_ms = elapsedMs(read_start);
+
+    auto create_start = Clock::now();
+
+    if (!cached_path.empty()) {
+        // Already optimized: load without running the optimizers again
+        if (fileExists(cached_path)) {
+            try {
+                Ort::SessionOptions session_options = makeOptions(GraphOptimizationLevel::ORT_DISABLE_ALL);
+                auto session = openSession(cached_path, session_options, options.memory_map, timing);
+                timing.create_ms = elapsedMs(create_start);
+                timing.optimized_cache_hit = true;
+                std::cout << "Using optimized model cache: " << cached_path << std::endl;
+                return session;
+            } catch (const std::exception& e) {
+                std::cerr << "Ignoring unusable optimized model " << cached_path << ": " << e.what() << std::endl;
+            }
+        }
+
+        // Write to a private name and rename, so PEs starting together never
+        // read a partially written file
+        std::string temp_path = cached_path + ".tmp" + std::to_string(getpid());
+        try {
+            Ort::SessionOptions session_options = makeOptions(options.optimization_level);
+            session_options.SetOptimizedModelFilePath(temp_path.c_str());
+            if (options.memory_map) {
+                session_options.AddConfigEntry(kOrtSessionOptionsConfigSaveModelFormat, "ORT");
+            }
+            auto session = std::make_shared<Ort::Session>(env_, model_path.c_str(), session_options,
+                                                          prepacked_weights_);
+            if (std::rename(temp_path.c_str(), cached_path.c_str()) == 0) {
+                timing.optimized_cache_written = true;
+                std::cout << "Saved optimized model cache: " << cached_path << std::endl;
+                if (options.memory_map) {
+                    // Reopen from the mapping so this PE shares its pages too
+                    Ort::SessionOptions mapped_options = makeOptions(GraphOptimizationLevel::ORT_DISABLE_ALL);
+                    session = openSession(cached_path, mapped_options, true, timing);
+                }
+            } else {
+                std::remove(temp_path.c_str());
+            }
+            timing.create_ms = elapsedMs(create_start);
+            return session;
+        } catch (const std::exception& e) {
+            // e.g. read-only model directory; fall back to a plain load
+            std::remove(temp_path.c_str());
+            std::cerr << "Could not save optimized model " << cached_path << ": " << e.what() << std::endl;
+        }
+    }
+
+    Ort::SessionOptions session_options = makeOptions(options.optimization_level);
+    auto session = openSession(model_path, session_options, options.memory_map, timing);
+    timing.create_ms = elapsedMs(create_start);
+    return session;
+}
+
+std::shared_ptr<Ort::Session> OrtRuntime::openSession(const std::string& path,
+                                                      Ort::SessionOptions& session_options,
+                                                      bool memory_map,
+                                                      LoadTiming& timing) {
+    if (!memory_map || !isOrtFormat(path)) {
+        // ONNX protobuf initializers are always copied; ORT maps page-aligned
+        // external data files itself
+        return std::make_shared<Ort::Session>(env_, path.c_str(), session_options, prepacked_weights_);
+    }
+
+    // Initializers point into the mapping, so the mapping lives as long as the session
+    auto mapping = std::make_shared<MappedFile>(path);
+    session_options.AddConfigEntry(kOrtSessionOptionsConfigUseORTModelBytesDirectly, "1");
+    session_options.AddConfigEntry(kOrtSessionOptionsConfigUseORTModelBytesForInitializers, "1");
+    auto session = new Ort::Session(env_, mapping->data(), mapping->size(), session_options, prepacked_weights_);
+    timing.mapped_bytes = mapping->size();
+    std::cout << "Memory-mapped model: " << path << " (" << mapping->size() / (1024 * 1024) << " MiB)" << std::endl;
+    return std::shared_ptr<Ort::Session>(session, [mapping](Ort::Session* s) { delete s; });
+}
+
+std::string OrtRuntime::optimizedModelPath(const std::string& model_path,
+                                           const SessionConfig& options) {
+    uint64_t hash = 0;
+    if (!hashFile(model_path, hash)) {
+        return "";
+    }
+
+    // Optimized graphs may use kernels specific to this ORT build and level
+    const uint64_t prime = 0x100000001B3ull;
+    for (char c : Ort::GetVersionString()) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * prime;
+    }
+    hash = (hash ^ static_cast<uint64_t>(options.optimization_level)) * prime;
+
+    // Pinned dimensions are baked into the optimized graph
+    for (const auto& dim : options.free_dimension_overrides) {
+        for (char c : dim.first) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * prime;
+        }
+        hash = (hash ^ static_cast<uint64_t>(dim.second)) * prime;
+    }
+
+    std::ostringstream path;
+    std::string base = model_path;
+    if (base.size() > 5 && base.compare(base.size() - 5, 5, ".onnx") == 0) {
+        base.resize(base.size() - 5);
+    }
+    path << base << "." << std::hex << std::setw(16) << std::setfill('0') << hash << (options.memory_map ? ".opt.ort" : ".opt.onnx");
+    return path.str();
+}
+
+std::vector<std::string> OrtRuntime::symbolicDimensions(Ort::Session& session, size_t input_index) {
+    auto info = session.GetInputTypeInfo(input_index).GetTensorTypeAndShapeInfo();
+    std::vector<const char*> names(info.GetDimensionsCount(), nullptr);
+    info.GetSymbolicDimensions(names.data(), names.size());
+    std::vector<std::string> dims;
+    for (const char* name : names) {
+        dims.push_back(name ? name : "");
+    }
+    return dims;
+}
+
+std::map<std::string, int64_t> OrtRuntime::fixedShapeOverrides(Ort::Session& session, size_t input_index,
+                                                               const std::vector<int64_t>& shape) {
+    std::map<std::string, int64_t> overrides;
+    auto dims = symbolicDimensions(session, input_index);
+    auto model_shape = session.GetInputTypeInfo(input_index).GetTensorTypeAndShapeInfo().GetShape();
+    for (size_t axis = 1; axis < dims.size() && axis < shape.size(); ++axis) {
+        if (model_shape[axis] < 0 && !dims[axis].empty()) {
+            overrides[dims[axis]] = shape[axis];
+        }
+    }
+    return overrides;
+}
+
+std::string OrtRuntime::quantizedModelPath(const std::string& model_path) {
+    std::string base = model_path;
+    if (base.size() > 5 && base.compare(base.size() - 5, 5, ".onnx") == 0) {
+        base.resize(base.size() - 5);
+    }
+    return base + ".int8.onnx";
+}
+
+std::string OrtRuntime::selectModel(const std::string& model_path, bool quantized) {
+    if (!quantized) {
+        return model_path;
+    }
+    std::string quantized_path = quantizedModelPath(model_path);
+    if (!fileExists(quantized_path)) {
+        std::cerr << "INT8 model " << quantized_path << " not found (see quantize_encoder.py); using "
+                  << model_path << std::endl;
+        return model_path;
+    }
+    std::cout << "Using INT8 model: " << quantized_path << std::endl;
+    return quantized_path;
+}
+
+std::map<std::string, double> OrtRuntime::getStats() const {
+    std::map<std::string, double> stats = getProcessStats();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t live = 0;
+    for (const auto& entry : sessions_) {
+        if (!entry.second.session.expired()) {
+            ++live;
+        }
+    }
+    stats["sessions_live"] = static_cast<double>(live);
+    stats["sessions_created"] = static_cast<double>(sessions_created_);
+    stats["sessions_reused"] = static_cast<double>(sessions_reused_);
+    stats["optimized_cache_hits"] = static_cast<double>(optimized_cache_hits_);
+    stats["optimized_cache_writes"] = static_cast<double>(optimized_cache_writes_);
+    stats["total_session_load_ms"] = total_load_ms_;
+    double read_ms = 0.0;
+    double create_ms = 0.0;
+    for (const auto& timing : load_timings_) {
+        read_ms += timing.read_ms;
+        create_ms += timing.create_ms;
+    }
+    stats["total_session_read_ms"] = read_ms;
+    double mapped_mb = 0.0;
+    for (const auto& timing : load_timings_) {
+        mapped_mb += timing.mapped_bytes / (1024.0 * 1024.0);
+    }
+    stats["memory_mapped_mb"] = mapped_mb;
+    stats["total_session_create_ms"] = create_ms;
+    stats["global_intra_op_threads"] = config_.intra_op_threads;
+    stats["global_inter_op_threads"] = config_.inter_op_threads;
+    return stats;
+}
+
+std::map<std::string, double> OrtRuntime::getProcessStats() {
+    std::map<std::string, double> stats;
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        double value = 0.0;
+        if (!(fields >> name >> value)) {
+            continue;
+        }
+        if (name == "Threads:") {
+            stats["process_threads"] = value;
+        } else if (name == "VmRSS:") {
+            stats["process_rss_mb"] = value / 1024.0;  // reported in kB
+        } else if (name == "VmHWM:") {
+            stats["process_peak_rss_mb"] = value / 1024.0;
+        } else if (name == "RssAnon:") {
+            stats["process_rss_anon_mb"] = value / 1024.0;  // private to this process
+        } else if (name == "RssFile:") {
+            stats["process_rss_file_mb"] = value / 1024.0;  // file pages, shareable
+        }
+    }
+    return stats;
+}
+
+} // namespace onnx_stt
@@ -1,13 +1,25 @@
 #include "ProvenFeatureExtractor.hpp"
+#include "RealFFT.hpp"
+#include "AudioPreprocessor.hpp"
+#include <string>
 #include <iostream>
 #include <cstring>
 #include <cstdlib>
 
-ProvenFeatureExtractor::ProvenFeatureExtractor() {
-    // Initialize random seed for dithering
-    srand(42);
+namespace {
+
+// NeMo dither (1e-5) with a fixed seed, so features are reproducible run to run
+onnx_stt::AudioPreprocessor::Options ditherOptions() {
+    onnx_stt::AudioPreprocessor::Options dither_opts;
+    dither_opts.dither = 0.00001f;
+    dither_opts.seed = 42;
+    return dither_opts;
 }
 
+} // namespace
+
+ProvenFeatureExtractor::ProvenFeatureExtractor() : dither_(ditherOptions()) {}
+
 std::vector<float> ProvenFeatureExtractor::extractMelSpectrogram(
     const std::vector<float>& audio_data,
     int sample_rate,
@@ -15,15 +27,6 @@ std::vector<float> ProvenFeatureExtractor::extractMelSpectrogram(
     int frame_length,
     int frame_shift) {
     
-    // Apply dithering like NeMo does
-    const float dither_value = 0.00001f;
-    std::vector<float> dithered_audio = audio_data;
-    
-    for (size_t i = 0; i < dithered_audio.size(); i++) {
-        float noise = ((rand() / float(RAND_MAX)) - 0.5f) * 2.0f * dither_value;
-        dithered_audio[i] += noise;
-    }
-    
     // Use exact librosa/NeMo parameters
     const int n_fft = 512;
     const int hop_length = 160;
@@ -31,22 +34,10 @@ std::vector<float> ProvenFeatureExtractor::extractMelSpectrogram(
     
     // CRITICAL FIX: Apply center padding like librosa does
     const int pad_length = n_fft / 2;  // 256 samples
-    std::vector<float> padded_audio;
+    std::vector<float> padded_audio(audio_data.size() + 2 * pad_length, 0.0f);
     
-    // Pad beginning with zeros
-    for (int i = 0; i < pad_length; i++) {
-        padded_audio.push_back(0.0f);
-    }
-    
-    // Copy original audio
-    for (float sample : dithered_audio) {
-        padded_audio.push_back(sample);
-    }
-    
-    // Pad end with zeros  
-    for (int i = 0; i < pad_length; i++) {
-        padded_audio.push_back(0.0f);
-    }
+    // Apply dithering like NeMo does, writing straight into the padded buffer
+    dither_.process(audio_data.data(), audio_data.size(), padded_audio.data() + pad_length);
     
     // Calculate number of frames (should now match librosa)
     int num_frames = 1 + (padded_audio.size() - win_length) / hop_length;
@@ -55,8 +46,8 @@ std::vector<float> ProvenFeatureExtractor::extractMelSpectrogram(
     std::cout << "Padded audio: " << padded_audio.size() << " samples" << std::endl;
     std::cout << "Processing " << num_frames << " frames with librosa-based method" << std::endl;
     
-    // Create mel filterbank once
-    auto mel_basis = createMelFilterbank(n_mels, n_fft, sample_rate);
+    // Banded mel filterbank, built once per configuration and shared across calls
+    auto mel_basis = getMelFilterbank(n_mels, n_fft, sample_rate);
     
     // Process all frames
     std::vector<float> all_mel_features;
@@ -71,17 +62,11 @@ std::vector<float> ProvenFeatureExtractor::extractMelSpectrogram(
         // Apply window
         auto windowed_frame = applyWindow(frame, win_length);
         
-        // Compute FFT
-        auto fft_result = computeLibrosaFFT(windowed_frame);
-        
         // Power spectrum
-        std::vector<float> power_spectrum(n_fft / 2 + 1);
-        for (int i = 0; i <= n_fft / 2; i++) {
-            power_spectrum[i] = fft_result[i];
-        }
+        auto power_spectrum = computeLibrosaFFT(windowed_frame);
         
         // Apply mel filterbank
-        auto mel_frame = applyMelFilterbank(power_spectrum, mel_basis);
+        auto mel_frame = applyMelFilterbank(power_spectrum, *mel_basis);
         
         // Append to output
         all_mel_features.insert(all_mel_features.end(), mel_frame.begin(), mel_frame.end());
@@ -131,23 +116,9 @@ std::vector<float> ProvenFeatureExtractor::applyWindow(const std::vector<float>&
 }
 
 std::vector<float> ProvenFeatureExtractor::computeLibrosaFFT(const std::vector<float>& windowed_frame) {
-    int n_fft = windowed_frame.size();
-    std::vector<float> power_spectrum(n_fft / 2 + 1);
-    
-    // Simple DFT for now - in production use FFTW or similar
-    for (int k = 0; k <= n_fft / 2; k++) {
-        float real = 0.0f, imag = 0.0f;
-        
-        for (int n = 0; n < n_fft; n++) {
-            float angle = -2.0f * PI * k * n / n_fft;
-            real += windowed_frame[n] * cos(angle);
-            imag += windowed_frame[n] * sin(angle);
-        }
-        
-        power_spectrum[k] = real * real + imag * imag;
-    }
-    
-    return power_spectrum;
+    // Plans are cached per size, so this only builds twiddles on the first frame
+    auto fft = onnx_stt::RealFFT::get(static_cast<int>(windowed_frame.size()));
+    return fft->powerSpectrum(windowed_frame);
 }
 
 float ProvenFeatureExtractor::hzToMel(float hz) {
@@ -212,22 +183,24 @@ std::vector<std::vector<float>> ProvenFeatureExtractor::createMelFilterbank(int
     return mel_basis;
 }
 
+std::shared_ptr<const onnx_stt::MelFilterbank> ProvenFeatureExtractor::getMelFilterbank(
+    int n_mels, int n_fft, int sample_rate) {
+    std::string key = "proven:" + std::to_string(n_mels) + ":" + std::to_string(n_fft) +
+                      ":" + std::to_string(sample_rate);
+    return onnx_stt::MelFilterbank::get(key, [&]() {
+        return createMelFilterbank(n_mels, n_fft, sample_rate);
+    });
+}
+
 std::vector<float> ProvenFeatureExtractor::applyMelFilterbank(
     const std::vector<float>& power_spectrum,
-    const std::vector<std::vector<float>>& mel_basis) {
+    const onnx_stt::MelFilterbank& mel_basis) {
     
-    int n_mels = mel_basis.size();
-    std::vector<float> mel_features(n_mels);
+    auto mel_features = mel_basis.apply(power_spectrum);
     
-    for (int m = 0; m < n_mels; m++) {
-        float filter_output = 0.0f;
-        
-        for (size_t bin = 0; bin < power_spectrum.size() && bin < mel_basis[m].size(); bin++) {
-            filter_output += mel_basis[m][bin] * power_spectrum[bin];
-        }
-        
-        // Apply log transform
-        mel_features[m] = std::log(filter_output + 1e-10f);
+    // Apply log transform
+    for (float& value : mel_features) {
+        value = std::log(value + 1e-10f);
     }
     
     return mel_features;
@@ -247,6 +220,6 @@ std::vector<float> ProvenFeatureExtractor::computeMelFilterbank(
     int n_mels, 
     int sample_rate) {
     
-    auto mel_basis = createMelFilterbank(n_mels, power_spectrum.size() * 2 - 2, sample_rate);
-    return applyMelFilterbank(power_spectrum, mel_basis);
+    auto mel_basis = getMelFilterbank(n_mels, power_spectrum.size() * 2 - 2, sample_rate);
+    return applyMelFilterbank(power_spectrum, *mel_basis);
 }
\ No newline at end of file
@@ -4,16 +4,22 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
 #include <sndfile.h>
 #include <unordered_map>
 
-ProvenNeMoSTT::ProvenNeMoSTT() : initialized_(false) {
+ProvenNeMoSTT::ProvenNeMoSTT() : encoder_dim_(512), state_layers_(1), state_hidden_(640), blank_id_(1024),
+                                 encoded_frames_(0), encoder_channel_major_(true), last_token_(1024),
+                                 text_emitted_(false), max_symbols_per_frame_(10),
+                                 ctc_output_index_(-1), blank_skip_threshold_(0.0f),
+                                 frames_decoded_(0), frames_skipped_(0), decoder_calls_(0), decode_us_(0),
+                                 segment_samples_(0), overlap_samples_(0), cut_at_silence_(true),
+                                 segments_encoded_(0), silence_cuts_(0), max_segment_frames_(0),
+                                 initialized_(false), cache_optimized_model_(false), memory_map_model_(false),
+                                 quantized_encoder_(false) {
     try {
-        ort_env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "ProvenNeMoSTT");
-        session_options_ = std::make_unique<Ort::SessionOptions>();
-        session_options_->SetIntraOpNumThreads(1);
-        session_options_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
         memory_info_ = std::make_unique<Ort::MemoryInfo>(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault));
         
         feature_extractor_ = std::make_unique<ProvenFeatureExtractor>();
@@ -30,11 +36,19 @@ bool ProvenNeMoSTT::initialize(const std::string& encoder_path,
     try {
         std::cout << "Loading proven working ONNX models..." << std::endl;
         
-        // Load encoder model
-        encoder_session_ = std::make_unique<Ort::Session>(*ort_env_, encoder_path.c_str(), *session_options_);
+        // Sessions on the process-wide thread pools, shared with other instances
+        onnx_stt::OrtRuntime::SessionConfig session_config;
+        session_config.cache_optimized_model = cache_optimized_model_;
+        session_config.memory_map = memory_map_model_;
         
-        // Load decoder model  
-        decoder_session_ = std::make_unique<Ort::Session>(*ort_env_, decoder_path.c_str(), *session_options_);
+        // Load encoder and decoder models in parallel
+        encoder_path_ = onnx_stt::OrtRuntime::selectModel(encoder_path, quantized_encoder_);
+        auto sessions = onnx_stt::OrtRuntime::instance().loadSessions({
+            {encoder_path_, session_config},
+            {decoder_path, session_config}});
+        encoder_session_ = sessions[0];
+        decoder_session_ = sessions[1];
+        decoder_path_ = decoder_path;
         
         // Get input/output names for encoder
         Ort::AllocatorWithDefaultOptions allocator;
@@ -51,6 +65,13 @@ bool ProvenNeMoSTT::initialize(const std::string& encoder_path,
         for (size_t i = 0; i < encoder_output_count; i++) {
             auto output_name = encoder_session_->GetOutputNameAllocated(i, allocator);
             encoder_output_names_.push_back(std::string(output_name.get()));
+            
+            // CTC head of a hybrid model exported alongside the encoder output
+            const std::string& name = encoder_output_names_.back();
+            if (i > 0 && (name.find("log_prob") != std::string::npos || name.find("logprob") != std::string::npos ||
+                          name.find("ctc") != std::string::npos)) {
+                ctc_output_index_ = static_cast<int>(i);
+            }
         }
         
         // Decoder input/output names
@@ -94,6 +115,28 @@ bool ProvenNeMoSTT::initialize(const std::string& encoder_path,
             std::cerr << "Warning: Could not load vocabulary file: " << real_vocab_path << std::endl;
         }
         
+        // decoder_joint inputs: encoder_outputs [B, dim, T], targets, target_length,
+        // input_states_1/2 [layers, B, hidden]; outputs: logits, prednet_lengths,
+        // output_states_1/2
+        if (decoder_input_names_.size() < 5 || decoder_output_names_.size() < 4) {
+            std::cerr << "Error: decoder_joint model needs 5 inputs and 4 outputs" << std::endl;
+            return false;
+        }
+        auto encoder_outputs_shape = decoder_session_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        auto state_shape = decoder_session_->GetInputTypeInfo(3).GetTensorTypeAndShapeInfo().GetShape();
+        auto logits_shape = decoder_session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        if (encoder_outputs_shape.size() == 3 && encoder_outputs_shape[1] > 0) {
+            encoder_dim_ = static_cast<size_t>(encoder_outputs_shape[1]);
+        }
+        if (state_shape.size() == 3) {
+            state_layers_ = state_shape[0] > 0 ? static_cast<size_t>(state_shape[0]) : state_layers_;
+            state_hidden_ = state_shape[2] > 0 ? static_cast<size_t>(state_shape[2]) : state_hidden_;
+        }
+        if (!logits_shape.empty() && logits_shape.back() > 0) {
+            blank_id_ = static_cast<int32_t>(logits_shape.back() - 1);
+        }
+        resetDecoderState();
+        
         std::cout << "✓ Encoder loaded: " << encoder_input_names_.size() << " inputs, " 
                   << encoder_output_names_.size() << " outputs" << std::endl;
         std::cout << "✓ Decoder loaded: " << decoder_input_names_.size() << " inputs, " 
@@ -116,6 +159,43 @@ std::string ProvenNeMoSTT::transcribe(const std::string& audio_file_path) {
     try {
         std::cout << "Transcribing: " << audio_file_path << std::endl;
         
+        // Long-form: read and downmix one segment at a time
+        if (segment_samples_ > 0) {
+            SF_INFO sfinfo;
+            memset(&sfinfo, 0, sizeof(sfinfo));
+            SNDFILE* file = sf_open(audio_file_path.c_str(), SFM_READ, &sfinfo);
+            if (!file) {
+                std::cerr << "Error opening audio file: " << audio_file_path << std::endl;
+                return "Error: Failed to load audio file";
+            }
+            if (sfinfo.samplerate != SAMPLE_RATE) {
+                std::cout << "Note: " << sfinfo.samplerate << " Hz audio is not resampled" << std::endl;
+            }
+            std::vector<float> interleaved;
+            auto read = [&](size_t begin, size_t count, std::vector<float>& out) {
+                interleaved.resize(count * sfinfo.channels);
+                if (sf_seek(file, static_cast<sf_count_t>(begin), SEEK_SET) < 0 ||
+                    sf_readf_float(file, interleaved.data(), static_cast<sf_count_t>(count)) !=
+                        static_cast<sf_count_t>(count)) {
+                    std::cerr << "Error reading audio data at sample " << begin << std::endl;
+                    return false;
+                }
+                out.assign(count, 0.0f);
+                for (size_t i = 0; i < count; ++i) {
+                    for (int ch = 0; ch < sfinfo.channels; ++ch) {
+                        out[i] += interleaved[i * sfinfo.channels + ch];
+                    }
+                    out[i] /= sfinfo.channels;
+                }
+                return true;
+            };
+            std::cout << "✓ Long-form: " << sfinfo.frames << " samples" << std::endl;
+            resetDecoderState();
+            std::string transcript = recognizeLongForm(static_cast<size_t>(sfinfo.frames), read);
+            sf_close(file);
+            return transcript;
+        }
+        
         // Load audio file
         auto audio_data = loadAudioFile(audio_file_path, SAMPLE_RATE);
         if (audio_data.empty()) {
@@ -132,11 +212,178 @@ std::string ProvenNeMoSTT::transcribe(const std::string& audio_file_path) {
     }
 }
 
+bool ProvenNeMoSTT::warmUp(int duration_ms) {
+    if (!initialized_ || duration_ms <= 0) {
+        return false;
+    }
+    
+    try {
+        std::vector<float> silence(static_cast<size_t>(SAMPLE_RATE) * duration_ms / 1000, 0.0f);
+        auto features = extractFeatures(silence, SAMPLE_RATE);
+        if (features.empty()) {
+            return false;
+        }
+        
+        // First inference of each model, reported with its load timings
+        onnx_stt::OrtRuntime& runtime = onnx_stt::OrtRuntime::instance();
+        auto start = std::chrono::steady_clock::now();
+        auto encoded = runEncoder(features);
+        auto encoded_at = std::chrono::steady_clock::now();
+        runDecoder(encoded);
+        auto decoded_at = std::chrono::steady_clock::now();
+        resetDecoderState();
+        runtime.recordFirstRun(encoder_path_, std::chrono::duration<double, std::milli>(encoded_at - start).count());
+        runtime.recordFirstRun(decoder_path_, std::chrono::duration<double, std::milli>(decoded_at - encoded_at).count());
+        std::cout << "✓ Warm-up done (" << duration_ms << " ms of silence)" << std::endl;
+        return true;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Warm-up failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 std::string ProvenNeMoSTT::transcribe(const std::vector<float>& audio_data, int sample_rate) {
     if (!initialized_) {
         return "Error: Models not initialized";
     }
-    
+    resetDecoderState();
+    if (segment_samples_ > 0 && sample_rate == SAMPLE_RATE && audio_data.size() > segment_samples_) {
+        auto read = [&audio_data](size_t begin, size_t count, std::vector<float>& out) {
+            out.assign(audio_data.begin() + begin, audio_data.begin() + begin + count);
+            return true;
+        };
+        return recognizeLongForm(audio_data.size(), read);
+    }
+    return recognize(audio_data, sample_rate);
+}
+
+void ProvenNeMoSTT::setLongForm(int segment_ms, int overlap_ms, bool cut_at_silence) {
+    segment_samples_ = segment_ms > 0 ? static_cast<size_t>(segment_ms) * SAMPLE_RATE / 1000 : 0;
+    // At most half a segment, so every segment moves the stream forward
+    overlap_samples_ = std::min(static_cast<size_t>(std::max(overlap_ms, 0)) * SAMPLE_RATE / 1000,
+                                segment_samples_ / 2);
+    cut_at_silence_ = cut_at_silence;
+}
+
+std::string ProvenNeMoSTT::recognizeLongForm(size_t total_samples, const SampleReader& read) {
+    try {
+        // Segment s covers [start, end) of the input but only decodes the
+        // encoder frames centred in [owned_from, owned_to): the overlap with
+        // the next segment is split at its midpoint, so each stretch of audio
+        // is decoded once, by the segment that sees the most context around it
+        std::vector<int64_t> tokens;
+        std::vector<float> segment;
+        size_t start = 0;
+        size_t owned_from = 0;
+        while (start < total_samples) {
+            size_t end = std::min(total_samples, start + segment_samples_);
+            if (total_samples - end < static_cast<size_t>(SAMPLE_RATE)) {
+                end = total_samples;  // no segment shorter than a second at the end
+            }
+            if (!read(start, end - start, segment)) {
+                return "Error: Failed to load audio file";
+            }
+            
+            size_t next_start = end;
+            size_t owned_to = end;
+            if (end < total_samples) {
+                size_t cut = cut_at_silence_ ? findSilence(segment, segment.size() - overlap_samples_)
+                                             : std::string::npos;
+                if (cut != std::string::npos) {
+                    segment.resize(cut);
+                    end = start + cut;
+                    next_start = end;
+                    owned_to = end;
+                    ++silence_cuts_;
+                } else {
+                    next_start = end - overlap_samples_;
+                    owned_to = next_start + overlap_samples_ / 2;
+                }
+            }
+            
+            auto features = extractFeatures(segment, SAMPLE_RATE);
+            if (features.empty()) {
+                return "Error: Feature extraction failed";
+            }
+            auto encoder_output = runEncoder(features);
+            if (encoder_output.empty() || encoded_frames_ == 0) {
+                return "Error: Encoder inference failed";
+            }
+            
+            // Encoder frame f is centred at start + (f + 0.5) * samples_per_frame
+            const double samples_per_frame = static_cast<double>(segment.size()) / encoded_frames_;
+            auto frameAt = [&](size_t sample) {
+                double f = std::ceil((sample - start) / samples_per_frame - 0.5);
+                return std::min(encoded_frames_, static_cast<size_t>(std::max(f, 0.0)));
+            };
+            const size_t first = frameAt(owned_from);
+            const size_t last = end == total_samples ? encoded_frames_ : frameAt(owned_to);
+            if (!decodeFrames(encoder_output, first, last, tokens)) {
+                return "Error: Decoder inference failed";
+            }
+            
+            ++segments_encoded_;
+            max_segment_frames_ = std::max(max_segment_frames_, encoded_frames_);
+            owned_from = owned_to;
+            start = next_start;
+        }
+        
+        std::cout << "✓ Long-form: " << segments_encoded_ << " segments, " << tokens.size() << " tokens" << std::endl;
+        return tokens.empty() ? "" : decodeTokens(tokens);
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error in long-form transcription: " << e.what() << std::endl;
+        return "Error: Transcription pipeline failed";
+    }
+}
+
+size_t ProvenNeMoSTT::findSilence(const std::vector<float>& audio, size_t from) const {
+    // Quietest 10 ms frame in [from, end); npos unless below SILENCE_RMS
+    size_t best = std::string::npos;
+    double best_energy = static_cast<double>(SILENCE_RMS) * SILENCE_RMS;
+    for (size_t i = from; i + FRAME_SHIFT <= audio.size(); i += FRAME_SHIFT) {
+        double energy = 0.0;
+        for (size_t j = i; j < i + FRAME_SHIFT; ++j) {
+            energy += static_cast<double>(audio[j]) * audio[j];
+        }
+        energy /= FRAME_SHIFT;
+        if (energy < best_energy) {
+            best_energy = energy;
+            best = i + FRAME_SHIFT / 2;
+        }
+    }
+    return best;
+}
+
+std::string ProvenNeMoSTT::transcribeChunk(const std::vector<float>& audio_data, int sample_rate) {
+    if (!initialized_) {
+        return "Error: Models not initialized";
+    }
+    try {
+        // Per-chunk path: no feature dump or progress output, and the decoder
+        // state carries over from the previous chunk
+        auto features = extractFeatures(audio_data, sample_rate);
+        if (features.empty()) {
+            return "Error: Feature extraction failed";
+        }
+        auto encoder_output = runEncoder(features);
+        if (encoder_output.empty() || encoded_frames_ == 0) {
+            return "Error: Encoder inference failed";
+        }
+        std::vector<int64_t> tokens;
+        if (!decodeFrames(encoder_output, 0, encoded_frames_, tokens)) {
+            return "Error: Decoder inference failed";
+        }
+        return tokens.empty() ? "" : decodeTokens(tokens);
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error in chunk transcription: " << e.what() << std::endl;
+        return "Error: Transcription pipeline failed";
+    }
+}
+
+std::string ProvenNeMoSTT::recognize(const std::vector<float>& audio_data, int sample_rate) {
     try {
         // Extract features (mel spectrograms)
         auto features = extractFeatures(audio_data, sample_rate);
@@ -278,11 +525,35 @@ std::vector<float> ProvenNeMoSTT::runEncoder(const std::vector<float>& features)
         const float* output_data = output_tensors[0].GetTensorData<float>();
         auto output_shape = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
         
+        // NeMo exports [batch, dim, frames]; also accept [batch, frames, dim]
+        if (output_shape.size() == 3) {
+            encoder_channel_major_ = static_cast<size_t>(output_shape[1]) == encoder_dim_;
+            encoded_frames_ = static_cast<size_t>(encoder_channel_major_ ? output_shape[2] : output_shape[1]);
+        } else {
+            encoded_frames_ = 0;
+        }
+        
         size_t output_size = 1;
         for (auto dim : output_shape) {
             output_size *= dim;
         }
         
+        // Blank-dominated frames from the CTC head's log-probs [1, frames, vocab + 1]
+        // (blank last); the transducer does not need to look at them
+        blank_frames_.clear();
+        if (ctc_output_index_ >= 0 && blank_skip_threshold_ > 0.0f) {
+            auto ctc_shape = output_tensors[ctc_output_index_].GetTensorTypeAndShapeInfo().GetShape();
+            if (ctc_shape.size() == 3 && static_cast<size_t>(ctc_shape[1]) == encoded_frames_) {
+                const float* ctc_data = output_tensors[ctc_output_index_].GetTensorData<float>();
+                const size_t classes = static_cast<size_t>(ctc_shape[2]);
+                const float skip_log_prob = std::log(blank_skip_threshold_);
+                blank_frames_.resize(encoded_frames_);
+                for (size_t t = 0; t < encoded_frames_; ++t) {
+                    blank_frames_[t] = ctc_data[t * classes + classes - 1] > skip_log_prob;
+                }
+            }
+        }
+        
         return std::vector<float>(output_data, output_data + output_size);
         
     } catch (const std::exception& e) {
@@ -292,209 +563,119 @@ std::vector<float> ProvenNeMoSTT::runEncoder(const std::vector<float>& features)
 }
 
 std::string ProvenNeMoSTT::runDecoder(const std::vector<float>& encoder_output) {
+    std::vector<int64_t> predicted_tokens;
+    if (!decodeFrames(encoder_output, 0, encoded_frames_, predicted_tokens)) {
+        return "Error: Decoder inference failed";
+    }
+    std::cout << "Predicted " << predicted_tokens.size() << " tokens over " << encoded_frames_ << " frames" << std::endl;
+    if (predicted_tokens.empty()) {
+        return "";  // all blank (silence)
+    }
+    return decodeTokens(predicted_tokens);
+}
+
+bool ProvenNeMoSTT::decodeFrames(const std::vector<float>& encoder_output, size_t first, size_t last,
+                                 std::vector<int64_t>& predicted_tokens) {
     try {
-        // For now, implement a simple greedy decoding approach
-        // This is simplified compared to full beam search but should work for testing
-        
-        // Calculate encoder output shape - decoder expects 3D: [batch, feature_dim, time]
-        // Encoder output = 35328 values, feature_dim = 512, so time = 35328 / 512 = 69
-        // But decoder expects [batch, feature_dim, time] not [batch, time, feature_dim]
-        size_t batch_size = 1;
-        size_t feature_dim = 512;  // FastConformer feature dimension
-        size_t time_steps = encoder_output.size() / feature_dim;
-        
-        std::vector<int64_t> input_shape = {static_cast<int64_t>(batch_size), 
-                                           static_cast<int64_t>(feature_dim),
-                                           static_cast<int64_t>(time_steps)};
-        
-        // Transpose encoder output from [batch, time, feature_dim] to [batch, feature_dim, time]
-        std::vector<float> transposed_encoder_output(encoder_output.size());
-        for (size_t t = 0; t < time_steps; t++) {
-            for (size_t f = 0; f < feature_dim; f++) {
-                // Source: [batch=0, time=t, feature=f] -> Target: [batch=0, feature=f, time=t]
-                transposed_encoder_output[f * time_steps + t] = encoder_output[t * feature_dim + f];
-            }
+        // Frame-synchronous greedy transducer decoding of frames [first, last)
+        // into predicted_tokens. Each decoder_joint call takes one encoder
+        // frame, the last emitted token and the LSTM state:
+        // a blank moves on to the next frame with the state unchanged, so a
+        // frame that wins blank costs exactly one call; a symbol is emitted,
+        // becomes the last token, and its LSTM state is kept, then the same
+        // frame is tried again (up to max_symbols_per_frame_ symbols)
+        const size_t frames = encoded_frames_;
+        if (frames == 0 || encoder_output.size() < frames * encoder_dim_) {
+            std::cerr << "Error: Encoder output does not match " << encoder_dim_ << "-dim frames" << std::endl;
+            return false;
         }
+        last = std::min(last, frames);
         
-        // Create encoder outputs tensor (first input)
-        Ort::Value encoder_outputs_tensor = Ort::Value::CreateTensor<float>(
-            *memory_info_,
-            transposed_encoder_output.data(),
-            transposed_encoder_output.size(),
-            input_shape.data(),
-            input_shape.size()
-        );
-        
-        // For RNN-T decoder, we typically need:
-        // 1. encoder_outputs (what we have)
-        // 2. encoded_lengths 
-        // 3. targets (for training, can be empty for inference)
-        // 4. target_lengths (for training, can be empty for inference)  
-        // 5. Maybe additional parameters
-        
-        // Create encoded_lengths tensor
-        std::vector<int64_t> encoded_lengths_data = {static_cast<int64_t>(time_steps)};
-        std::vector<int64_t> lengths_shape = {static_cast<int64_t>(batch_size)};
-        
-        Ort::Value encoded_lengths_tensor = Ort::Value::CreateTensor<int64_t>(
-            *memory_info_,
-            encoded_lengths_data.data(),
-            encoded_lengths_data.size(),
-            lengths_shape.data(),
-            lengths_shape.size()
-        );
-        
-        // Create decoder inputs based on actual model specification from ONNX analysis
-        
-        // Input 1: targets (int32, [batch, seq_len]) - start with blank token for inference
-        std::vector<int32_t> targets_data = {0};  // Blank token to start inference
-        std::vector<int64_t> targets_shape = {static_cast<int64_t>(batch_size), 1};
-        
-        Ort::Value targets_tensor = Ort::Value::CreateTensor<int32_t>(
-            *memory_info_,
-            targets_data.data(),
-            targets_data.size(),
-            targets_shape.data(),
-            targets_shape.size()
-        );
-        
-        // Input 2: target_length (int32, [batch])
-        std::vector<int32_t> target_length_data = {1};  // Length of targets sequence
-        std::vector<int64_t> target_length_shape = {static_cast<int64_t>(batch_size)};
+        int32_t target_length = 1;
+        const int64_t frame_shape[3] = {1, static_cast<int64_t>(encoder_dim_), 1};
+        const int64_t target_shape[2] = {1, 1};
+        const int64_t length_shape[1] = {1};
+        const int64_t state_shape[3] = {static_cast<int64_t>(state_layers_), 1, static_cast<int64_t>(state_hidden_)};
         
-        Ort::Value target_length_tensor = Ort::Value::CreateTensor<int32_t>(
-            *memory_info_,
-            target_length_data.data(),
-            target_length_data.size(),
-            target_length_shape.data(),
-            target_length_shape.size()
-        );
-        
-        // Input 3: input_states_1 (float32, [1, 1, 640]) - LSTM hidden state for single timestep
-        std::vector<float> input_states_1_data(1 * 1 * 640, 0.0f);
-        std::vector<int64_t> states_1_shape = {1, 1, 640};
-        
-        Ort::Value states_1_tensor = Ort::Value::CreateTensor<float>(
-            *memory_info_,
-            input_states_1_data.data(),
-            input_states_1_data.size(),
-            states_1_shape.data(),
-            states_1_shape.size()
-        );
-        
-        // Input 4: input_states_2 (float32, [1, 1, 640]) - LSTM cell state for single timestep  
-        std::vector<float> input_states_2_data(1 * 1 * 640, 0.0f);
-        std::vector<int64_t> states_2_shape = {1, 1, 640};
-        
-        Ort::Value states_2_tensor = Ort::Value::CreateTensor<float>(
-            *memory_info_,
-            input_states_2_data.data(),
-            input_states_2_data.size(),
-            states_2_shape.data(),
-            states_2_shape.size()
-        );
-        
-        // Prepare all input tensors in correct order: encoder_outputs, targets, target_length, input_states_1, input_states_2
-        std::vector<Ort::Value> input_tensors;
-        input_tensors.push_back(std::move(encoder_outputs_tensor));
-        input_tensors.push_back(std::move(targets_tensor));
-        input_tensors.push_back(std::move(target_length_tensor));
-        input_tensors.push_back(std::move(states_1_tensor));
-        input_tensors.push_back(std::move(states_2_tensor));
-        
-        // Prepare input/output names
         std::vector<const char*> input_names;
         for (const auto& name : decoder_input_names_) {
             input_names.push_back(name.c_str());
         }
-        
-        std::vector<const char*> output_names;
-        for (const auto& name : decoder_output_names_) {
-            output_names.push_back(name.c_str());
-        }
-        
-        std::cout << "Debug: Decoder expects " << decoder_input_names_.size() 
-                  << " inputs, providing " << input_tensors.size() << std::endl;
-        for (size_t i = 0; i < decoder_input_names_.size(); i++) {
-            std::cout << "Input " << i << ": " << decoder_input_names_[i] << std::endl;
-        }
-        
-        // Run decoder inference with all inputs
-        auto output_tensors = decoder_session_->Run(
-            Ort::RunOptions{nullptr},
-            input_names.data(),
-            input_tensors.data(),
-            std::min(input_tensors.size(), decoder_input_names_.size()),
-            output_names.data(),
-            output_names.size()
-        );
-        
-        if (output_tensors.empty()) {
-            std::cerr << "Error: No decoder output" << std::endl;
-            return "Error: Decoder failed";
-        }
-        
-        // Analyze decoder output first
-        auto output_shape = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
-        std::cout << "Decoder output shape: [";
-        for (size_t i = 0; i < output_shape.size(); i++) {
-            std::cout << output_shape[i];
-            if (i < output_shape.size() - 1) std::cout << ", ";
-        }
-        std::cout << "]" << std::endl;
-        
-        // From ONNX analysis: outputs shape ['dim_outputs_dynamic_axes_1', 'dim_outputs_dynamic_axes_2', 'dim_outputs_dynamic_axes_3', 1025]
-        // This is likely [batch, time, vocab_size+1] where last dim is logits over vocabulary
-        
-        const float* output_data = output_tensors[0].GetTensorData<float>();
-        size_t total_elements = 1;
-        for (auto dim : output_shape) {
-            total_elements *= dim;
-        }
-        
-        std::cout << "Decoder output total elements: " << total_elements << std::endl;
-        
-        // The output is logits, not token IDs - need to find argmax
-        // Shape is [batch, time, 1, vocab_size] = [1, 69, 1, 1025]
-        if (output_shape.size() == 4) {
-            size_t batch_size = output_shape[0];
-            size_t time_steps = output_shape[1]; 
-            size_t middle_dim = output_shape[2];
-            size_t vocab_size = output_shape[3];
-            
-            std::cout << "Interpreting as: batch=" << batch_size << ", time=" << time_steps << ", middle=" << middle_dim << ", vocab=" << vocab_size << std::endl;
-            
-            std::vector<int64_t> predicted_tokens;
+        // outputs (logits), then output_states_1/2; prednet_lengths is not needed
+        const char* output_names[3] = {
+            decoder_output_names_[0].c_str(), decoder_output_names_[2].c_str(), decoder_output_names_[3].c_str()};
+        
+        auto decode_start = std::chrono::steady_clock::now();
+        for (size_t t = first; t < last; ++t) {
+            if (!blank_frames_.empty() && blank_frames_[t]) {
+                ++frames_skipped_;
+                continue;
+            }
+            for (size_t d = 0; d < encoder_dim_; ++d) {
+                frame_[d] = encoder_channel_major_ ? encoder_output[d * frames + t]
+                                                   : encoder_output[t * encoder_dim_ + d];
+            }
             
-            // For each time step, find the token with highest probability
-            for (size_t t = 0; t < time_steps; t++) {
-                float max_prob = -1e9f;
-                int64_t best_token = 0;
+            for (int symbol = 0; symbol < max_symbols_per_frame_; ++symbol) {
+                Ort::Value inputs[5] = {
+                    Ort::Value::CreateTensor<float>(*memory_info_, frame_.data(), frame_.size(), frame_shape, 3),
+                    Ort::Value::CreateTensor<int32_t>(*memory_info_, &last_token_, 1, target_shape, 2),
+                    Ort::Value::CreateTensor<int32_t>(*memory_info_, &target_length, 1, length_shape, 1),
+                    Ort::Value::CreateTensor<float>(*memory_info_, state_1_.data(), state_1_.size(), state_shape, 3),
+                    Ort::Value::CreateTensor<float>(*memory_info_, state_2_.data(), state_2_.size(), state_shape, 3)};
+                auto outputs = decoder_session_->Run(
+                    Ort::RunOptions{nullptr}, input_names.data(), inputs, 5, output_names, 3);
+                ++decoder_calls_;
                 
-                for (size_t v = 0; v < vocab_size && v < 1024; v++) { // Limit to our vocab size
-                    // Index calculation for [batch, time, 1, vocab]
-                    size_t idx = t * middle_dim * vocab_size + 0 * vocab_size + v;
-                    if (idx < total_elements) {
-                        float prob = output_data[idx];
-                        if (prob > max_prob) {
-                            max_prob = prob;
-                            best_token = static_cast<int64_t>(v);
-                        }
-                    }
+                // Logits [1, 1, 1, vocab + 1]; blank is the last class
+                const float* logits = outputs[0].GetTensorData<float>();
+                size_t classes = outputs[0].GetTensorTypeAndShapeInfo().GetElementCount();
+                int32_t best = static_cast<int32_t>(std::max_element(logits, logits + classes) - logits);
+                if (best == blank_id_) {
+                    break;
                 }
                 
-                predicted_tokens.push_back(best_token);
+                predicted_tokens.push_back(best);
+                last_token_ = best;
+                const float* new_state_1 = outputs[1].GetTensorData<float>();
+                const float* new_state_2 = outputs[2].GetTensorData<float>();
+                std::copy(new_state_1, new_state_1 + state_1_.size(), state_1_.begin());
+                std::copy(new_state_2, new_state_2 + state_2_.size(), state_2_.begin());
             }
-            
-            std::cout << "Predicted " << predicted_tokens.size() << " tokens via argmax" << std::endl;
-            return decodeTokens(predicted_tokens);
-        } else {
-            return "Error: Unexpected decoder output dimensions";
         }
         
+        frames_decoded_ += last > first ? last - first : 0;
+        decode_us_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - decode_start).count());
+        return true;
+        
     } catch (const std::exception& e) {
         std::cerr << "Error in decoder inference: " << e.what() << std::endl;
-        return "Error: Decoder inference failed";
+        return false;
+    }
+}
+
+std::map<std::string, double> ProvenNeMoSTT::getStats() const {
+    std::map<std::string, double> stats;
+    stats["frames_decoded"] = static_cast<double>(frames_decoded_);
+    stats["frames_blank_skipped"] = static_cast<double>(frames_skipped_);
+    stats["decoder_calls"] = static_cast<double>(decoder_calls_);
+    stats["decode_us"] = static_cast<double>(decode_us_);
+    stats["long_form_segments"] = static_cast<double>(segments_encoded_);
+    stats["long_form_silence_cuts"] = static_cast<double>(silence_cuts_);
+    stats["long_form_max_segment_frames"] = static_cast<double>(max_segment_frames_);
+    return stats;
+}
+
+void ProvenNeMoSTT::resetDecoderState() {
+    last_token_ = blank_id_;
+    text_emitted_ = false;
+    state_1_.assign(state_layers_ * state_hidden_, 0.0f);
+    state_2_.assign(state_layers_ * state_hidden_, 0.0f);
+    frame_.assign(encoder_dim_, 0.0f);
+    // New utterance, so the dither sequence starts over as well
+    if (feature_extractor_) {
+        feature_extractor_->reset();
     }
 }
 
@@ -543,43 +724,34 @@ std::vector<float> ProvenNeMoSTT::loadAudioFile(const std::string& file_path, in
 }
 
 std::string ProvenNeMoSTT::decodeTokens(const std::vector<int64_t>& tokens) {
-    std::stringstream result;
+    std::string text;
     
-    std::cout << "Debug: Decoding " << tokens.size() << " tokens" << std::endl;
-    
-    for (size_t i = 0; i < tokens.size() && i < 20; i++) {
-        int64_t token = tokens[i];
-        std::cout << "Token " << i << ": " << token;
-        
+    for (int64_t token : tokens) {
         if (token == 0) {
-            std::cout << " (<unk>/blank)" << std::endl;
-            continue; // Skip blank/unknown tokens
+            continue; // Skip <unk>
         }
         
         auto it = token_to_text_.find(token);
         if (it != token_to_text_.end()) {
-            std::string token_text = it->second;
-            std::cout << " -> '" << token_text << "'" << std::endl;
+            const std::string& token_text = it->second;
             
             // Handle SentencePiece format: ▁ indicates word boundary
             if (token_text.length() >= 3 && token_text.substr(0, 3) == "▁") {
-                // Remove ▁ and add space before word
-                if (!result.str().empty()) {
-                    result << " ";
-                }
-                result << token_text.substr(3);
+                text += " " + token_text.substr(3);
             } else {
                 // Regular subword token, append directly
-                result << token_text;
+                text += token_text;
             }
-        } else {
-            std::cout << " (not found in vocab)" << std::endl;
         }
     }
     
-    std::string text = result.str();
-    
-    std::cout << "Final decoded text: '" << text << "'" << std::endl;
-    
-    return text.empty() ? "Error: Could not decode tokens" : text;
+    // Only the utterance's first word loses its leading space, so the texts
+    // of consecutive transcribeChunk() calls concatenate into the transcript
+    if (!text_emitted_ && !text.empty() && text[0] == ' ') {
+        text.erase(0, 1);
+    }
+    if (!text.empty()) {
+        text_emitted_ = true;
+    }
+    return text;
 }
\ No newline at end of file
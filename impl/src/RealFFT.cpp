@@ -0,0 +1,139 @@
+#include "RealFFT.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace onnx_stt {
+
+RealFFT::RealFFT(int n_fft) : n_fft_(n_fft), half_(n_fft / 2) {
+    if (n_fft < 4 || (n_fft & (n_fft - 1)) != 0) {
+        throw std::invalid_argument("RealFFT size must be a power of two >= 4, got " +
+                                    std::to_string(n_fft));
+    }
+
+    // Bit-reversal permutation for the half-size complex FFT
+    int bits = 0;
+    while ((1 << bits) < half_) {
+        ++bits;
+    }
+    bit_reverse_.resize(half_);
+    for (int i = 0; i < half_; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) {
+                reversed |= 1 << (bits - 1 - b);
+            }
+        }
+        bit_reverse_[i] = reversed;
+    }
+
+    // Twiddles computed in double precision to keep float rounding error flat across sizes
+    twiddles_.resize(half_ / 2);
+    for (int j = 0; j < half_ / 2; ++j) {
+        double angle = -2.0 * M_PI * j / half_;
+        twiddles_[j] = std::complex<float>(static_cast<float>(std::cos(angle)),
+                                           static_cast<float>(std::sin(angle)));
+    }
+
+    split_.resize(half_ + 1);
+    for (int k = 0; k <= half_; ++k) {
+        double angle = -2.0 * M_PI * k / n_fft_;
+        split_[k] = std::complex<float>(static_cast<float>(std::cos(angle)),
+                                        static_cast<float>(std::sin(angle)));
+    }
+}
+
+std::shared_ptr<const RealFFT> RealFFT::get(int n_fft) {
+    static std::mutex mutex;
+    static std::map<int, std::shared_ptr<const RealFFT>> plans;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = plans.find(n_fft);
+    if (it != plans.end()) {
+        return it->second;
+    }
+
+    auto plan = std::make_shared<const RealFFT>(n_fft);
+    plans[n_fft] = plan;
+    return plan;
+}
+
+void RealFFT::complexFFT(std::complex<float>* data) const {
+    for (int i = 0; i < half_; ++i) {
+        int j = bit_reverse_[i];
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+
+    for (int len = 2; len <= half_; len <<= 1) {
+        int span = len / 2;
+        int stride = half_ / len;
+        for (int start = 0; start < half_; start += len) {
+            for (int j = 0; j < span; ++j) {
+                const std::complex<float>& w = twiddles_[j * stride];
+                std::complex<float>& a = data[start + j];
+                std::complex<float>& b = data[start + j + span];
+
+                // Explicit complex multiply avoids the NaN/Inf checks of operator*
+                float br = b.real() * w.real() - b.imag() * w.imag();
+                float bi = b.real() * w.imag() + b.imag() * w.real();
+                b = std::complex<float>(a.real() - br, a.imag() - bi);
+                a = std::complex<float>(a.real() + br, a.imag() + bi);
+            }
+        }
+    }
+}
+
+void RealFFT::powerSpectrum(const float* frame, float* power, float* work) const {
+    // Pack even/odd samples as real/imaginary parts of n/2 complex points
+    std::copy(frame, frame + n_fft_, work);
+    auto* z = reinterpret_cast<std::complex<float>*>(work);
+    complexFFT(z);
+
+    // DC and Nyquist bins come straight out of Z[0]
+    float dc = z[0].real() + z[0].imag();
+    float nyquist = z[0].real() - z[0].imag();
+    power[0] = dc * dc;
+    power[half_] = nyquist * nyquist;
+
+    // Split the half-size transform into the real-input spectrum:
+    // X[k] = E[k] + W^k * O[k], E = (Z[k] + conj(Z[m-k])) / 2, O = -i * (Z[k] - conj(Z[m-k])) / 2
+    for (int k = 1; k < half_; ++k) {
+        const std::complex<float> zk = z[k];
+        const std::complex<float> zm = z[half_ - k];
+
+        float er = 0.5f * (zk.real() + zm.real());
+        float ei = 0.5f * (zk.imag() - zm.imag());
+        float or_ = 0.5f * (zk.imag() + zm.imag());
+        float oi = -0.5f * (zk.real() - zm.real());
+
+        const std::complex<float>& w = split_[k];
+        float xr = er + w.real() * or_ - w.imag() * oi;
+        float xi = ei + w.real() * oi + w.imag() * or_;
+        power[k] = xr * xr + xi * xi;
+    }
+}
+
+void RealFFT::powerSpectrum(const float* frame, float* power) const {
+    thread_local std::vector<float> scratch;
+    if (scratch.size() < static_cast<size_t>(n_fft_)) {
+        scratch.resize(n_fft_);
+    }
+    powerSpectrum(frame, power, scratch.data());
+}
+
+std::vector<float> RealFFT::powerSpectrum(const std::vector<float>& frame) const {
+    if (frame.size() != static_cast<size_t>(n_fft_)) {
+        throw std::invalid_argument("RealFFT expects frames of exactly " +
+                                    std::to_string(n_fft_) + " samples");
+    }
+    std::vector<float> power(numBins());
+    powerSpectrum(frame.data(), power.data());
+    return power;
+}
+
+} // namespace onnx_stt
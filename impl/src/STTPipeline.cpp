@@ -5,34 +5,59 @@
 #include "NeMoCacheAwareConformer.hpp"
 #include <iostream>
 #include <chrono>
+#include <exception>
+#include <future>
 #include <numeric>
 
 namespace onnx_stt {
 
 STTPipeline::STTPipeline(const Config& config) 
-    : config_(config), last_speech_time_ms_(0), in_speech_segment_(false) {}
+    : config_(config), last_speech_time_ms_(0), in_speech_segment_(false),
+      first_audio_timestamp_ms_(0), audio_started_(false) {}
 
 bool STTPipeline::initialize() {
     try {
-        // Initialize VAD if enabled
-        if (config_.enable_vad && !initializeVAD()) {
+        auto start = std::chrono::steady_clock::now();
+        
+        // Load the VAD session on its own thread while the ASR model loads here;
+        // the model's own sessions load in parallel inside createModel()
+        auto vad_ready = std::async(std::launch::async, [this] {
+            return initializeVAD();
+        });
+        
+        // Initialize feature extractor
+        bool extractor_ok = initializeFeatureExtractor();
+        
+        // Initialize ASR model
+        bool model_ok = false;
+        std::exception_ptr model_error;
+        try {
+            model_ok = initializeModel();
+        } catch (...) {
+            model_error = std::current_exception();
+        }
+        
+        // Always join the VAD load before reporting, so nothing is left running
+        bool vad_ok = vad_ready.get();
+        if (model_error) {
+            std::rethrow_exception(model_error);
+        }
+        
+        if (config_.enable_vad && !vad_ok) {
             std::cerr << "Failed to initialize VAD" << std::endl;
             return false;
         }
-        
-        // Initialize feature extractor
-        if (!initializeFeatureExtractor()) {
+        if (!extractor_ok) {
             std::cerr << "Failed to initialize feature extractor" << std::endl;
             return false;
         }
-        
-        // Initialize ASR model
-        if (!initializeModel()) {
+        if (!model_ok) {
             std::cerr << "Failed to initialize ASR model" << std::endl;
             return false;
         }
         
-        std::cout << "STTPipeline initialized successfully" << std::endl;
+        double init_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "STTPipeline initialized successfully (" << init_ms << " ms)" << std::endl;
         std::cout << "  VAD: " << (config_.enable_vad ? "enabled" : "disabled") << std::endl;
         std::cout << "  Feature extractor: " << (config_.feature_type == Config::KALDIFEAT ? "kaldifeat" : "simple_fbank") << std::endl;
         std::cout << "  Model: " << config_.model_config.model_type << std::endl;
@@ -45,9 +70,23 @@ bool STTPipeline::initialize() {
     }
 }
 
+std::unique_ptr<STTPipeline> STTPipeline::createStream() const {
+    std::unique_ptr<STTPipeline> stream(new STTPipeline(config_));
+    if (model_) {
+        stream->model_ = model_->createStream();
+        if (!stream->model_) {
+            std::cout << "Model does not support shared streams; loading a separate copy" << std::endl;
+        }
+    }
+    if (!stream->initialize()) {
+        return nullptr;
+    }
+    return stream;
+}
+
 STTPipeline::Result STTPipeline::processAudio(const int16_t* samples, size_t num_samples, uint64_t timestamp_ms) {
-    auto audio_float = convertInt16ToFloat(samples, num_samples);
-    return processAudio(audio_float, timestamp_ms);
+    preprocessor_.process(samples, num_samples, audio_float_);
+    return processAudio(audio_float_, timestamp_ms);
 }
 
 STTPipeline::Result STTPipeline::processAudio(const std::vector<float>& audio, uint64_t timestamp_ms) {
@@ -62,6 +101,12 @@ STTPipeline::Result STTPipeline::processAudioInternal(const std::vector<float>&
     result.is_final = false;
     result.confidence = 0.0;
     
+    if (!audio_started_) {
+        audio_started_ = true;
+        first_audio_time_ = start_time;
+        first_audio_timestamp_ms_ = timestamp_ms;
+    }
+    
     // Step 1: Voice Activity Detection
     auto vad_start = std::chrono::steady_clock::now();
     
@@ -79,11 +124,18 @@ STTPipeline::Result STTPipeline::processAudioInternal(const std::vector<float>&
             last_speech_time_ms_ = timestamp_ms;
             in_speech_segment_ = true;
         } else {
-            // Check if we've been in silence long enough to finalize
+            // Check if we've been in silence long enough to finalize; the
+            // segment's last frames still buffered in the model end it
             if (in_speech_segment_ && 
                 timestamp_ms - last_speech_time_ms_ > config_.silence_threshold_sec * 1000) {
                 result.is_final = true;
                 in_speech_segment_ = false;
+                auto flushed = model_->flush(timestamp_ms);
+                result.text = flushed.text;
+                result.confidence = flushed.confidence;
+                result.model_latency_ms = flushed.latency_ms;
+                noteFirstToken(result.text, std::chrono::steady_clock::now(),
+                               static_cast<double>(timestamp_ms));
             }
         }
         
@@ -111,7 +163,7 @@ STTPipeline::Result STTPipeline::processAudioInternal(const std::vector<float>&
     // Step 2: Feature Extraction
     auto feature_start = std::chrono::steady_clock::now();
     
-    auto features = feature_extractor_->computeFeatures(audio);
+    feature_extractor_->computeFeatures(audio.data(), audio.size(), features_);
     
     auto feature_end = std::chrono::steady_clock::now();
     result.feature_latency_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -120,7 +172,7 @@ STTPipeline::Result STTPipeline::processAudioInternal(const std::vector<float>&
     // Step 3: ASR Model Processing
     auto model_start = std::chrono::steady_clock::now();
     
-    auto model_result = model_->processChunk(features, timestamp_ms);
+    auto model_result = model_->processChunk(features_.view(), timestamp_ms);
     
     auto model_end = std::chrono::steady_clock::now();
     result.model_latency_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -130,6 +182,9 @@ STTPipeline::Result STTPipeline::processAudioInternal(const std::vector<float>&
     result.text = model_result.text;
     result.confidence = model_result.confidence;
     
+    noteFirstToken(result.text, model_end,
+                   static_cast<double>(timestamp_ms) + audio.size() * 1000.0 / config_.sample_rate);
+    
     // Override finality if model says it's final or if VAD detected end of speech
     if (model_result.is_final) {
         result.is_final = true;
@@ -147,17 +202,52 @@ STTPipeline::Result STTPipeline::processAudioInternal(const std::vector<float>&
     return result;
 }
 
+STTPipeline::Result STTPipeline::flush(uint64_t timestamp_ms) {
+    auto start_time = std::chrono::steady_clock::now();
+    
+    Result result;
+    result.timestamp_ms = timestamp_ms;
+    result.is_final = true;
+    result.confidence = 0.0;
+    
+    if (model_) {
+        auto model_result = model_->flush(timestamp_ms);
+        result.text = model_result.text;
+        result.confidence = model_result.confidence;
+        noteFirstToken(result.text, std::chrono::steady_clock::now(), static_cast<double>(timestamp_ms));
+    }
+    in_speech_segment_ = false;
+    
+    auto end_time = std::chrono::steady_clock::now();
+    result.latency_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        end_time - start_time).count();
+    result.model_latency_ms = result.latency_ms;
+    return result;
+}
+
+void STTPipeline::noteFirstToken(const std::string& text, std::chrono::steady_clock::time_point at,
+                                 double audio_end_ms) {
+    if (stats_.time_to_first_token_ms >= 0 || text.empty() || !audio_started_) {
+        return;
+    }
+    stats_.time_to_first_token_ms = std::chrono::duration<double, std::milli>(at - first_audio_time_).count();
+    stats_.first_token_audio_ms = audio_end_ms - static_cast<double>(first_audio_timestamp_ms_);
+}
+
 void STTPipeline::reset() {
     if (vad_) {
         vad_->reset();
     }
     if (model_) {
+        model_->flush(0);
         model_->reset();
     }
     
     audio_buffer_.clear();
+    preprocessor_.reset();
     last_speech_time_ms_ = 0;
     in_speech_segment_ = false;
+    audio_started_ = false;
     
     // Reset statistics
     stats_ = Stats();
@@ -220,6 +310,10 @@ bool STTPipeline::initializeFeatureExtractor() {
 }
 
 bool STTPipeline::initializeModel() {
+    // Already set for streams created from another pipeline's model
+    if (model_) {
+        return true;
+    }
     model_ = createModel(config_.model_config);
     return model_ != nullptr;
 }
@@ -234,14 +328,6 @@ void STTPipeline::updateStats(const Result& result) {
     stats_.avg_total_latency_ms = (stats_.avg_total_latency_ms * (n - 1) + result.latency_ms) / n;
 }
 
-std::vector<float> STTPipeline::convertInt16ToFloat(const int16_t* samples, size_t num_samples) {
-    std::vector<float> result(num_samples);
-    for (size_t i = 0; i < num_samples; ++i) {
-        result[i] = static_cast<float>(samples[i]) / 32768.0f;
-    }
-    return result;
-}
-
 // Factory functions
 std::unique_ptr<STTPipeline> createZipformerPipeline(const std::string& model_dir, bool enable_vad) {
     STTPipeline::Config config;
@@ -315,6 +401,8 @@ std::unique_ptr<STTPipeline> createNeMoPipeline(const std::string& model_path, b
     config.model_config.encoder_path = model_path;  // NeMo uses single model file
     config.model_config.model_type = ModelInterface::ModelConfig::NVIDIA_NEMO;
     config.model_config.chunk_frames = 160;  // 160 frames = 1.6 seconds, divisible by 4
+    config.model_config.first_chunk_frames = 32;  // first text after ~0.3 s of audio instead of 1.5 s
+    config.model_config.chunk_ramp = 3;           // then 56, 88, 112 new frames before full chunks
     config.model_config.feature_dim = 80;
     config.model_config.num_threads = 4;
     
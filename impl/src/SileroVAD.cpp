@@ -1,4 +1,5 @@
 #include "SileroVAD.hpp"
+#include "AudioPreprocessor.hpp"
 #include <algorithm>
 #include <cmath>
 #include <iostream>
@@ -18,12 +19,6 @@ bool SileroVAD::initialize(const Config& config) {
     frame_shift_samples_ = (config_.frame_shift_ms * config_.sample_rate) / 1000;
     
     try {
-        // Initialize ONNX Runtime
-        env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "SileroVAD");
-        session_options_ = std::make_unique<Ort::SessionOptions>();
-        session_options_->SetIntraOpNumThreads(1);
-        session_options_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
-        
         // Try to load Silero VAD model
         std::string model_path = "../models/silero_vad.onnx";
         if (!loadModel(model_path)) {
@@ -46,8 +41,8 @@ bool SileroVAD::initialize(const Config& config) {
 
 bool SileroVAD::loadModel(const std::string& model_path) {
     try {
-        // Try to create session
-        session_ = std::make_unique<Ort::Session>(*env_, model_path.c_str(), *session_options_);
+        // Try to get the (possibly already loaded) session
+        session_ = OrtRuntime::instance().getSession(model_path, OrtRuntime::SessionConfig());
         
         // Get input/output metadata
         Ort::AllocatorWithDefaultOptions allocator;
@@ -194,9 +189,7 @@ void SileroVAD::reset() {
 void SileroVAD::convertInt16ToFloat(const int16_t* samples, size_t num_samples, 
                                    std::vector<float>& output) {
     output.resize(num_samples);
-    for (size_t i = 0; i < num_samples; ++i) {
-        output[i] = static_cast<float>(samples[i]) / 32768.0f;
-    }
+    AudioPreprocessor::convertInt16ToFloat(samples, num_samples, output.data());
 }
 
 // Energy VAD Implementation (fallback)
@@ -215,11 +208,8 @@ bool EnergyVAD::initialize(const Config& config) {
 VADInterface::VADResult EnergyVAD::processChunk(const int16_t* samples, 
                                                size_t num_samples, 
                                                uint64_t timestamp_ms) {
-    std::vector<float> audio_float;
-    audio_float.resize(num_samples);
-    for (size_t i = 0; i < num_samples; ++i) {
-        audio_float[i] = static_cast<float>(samples[i]) / 32768.0f;
-    }
+    std::vector<float> audio_float(num_samples);
+    AudioPreprocessor::convertInt16ToFloat(samples, num_samples, audio_float.data());
     return processChunk(audio_float, timestamp_ms);
 }
 
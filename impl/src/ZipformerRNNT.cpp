@@ -2,46 +2,146 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <numeric>
 #include <functional>
 #include <thread>
+#include <cmath>
+#include <iterator>
 
 namespace onnx_stt {
 
+namespace {
+
+// Models loaded in this process, keyed by file paths
+std::mutex g_models_mutex;
+std::map<std::string, std::weak_ptr<const ZipformerRNNT::SharedModel>> g_models;
+
+// Size of one axis of a tensor (-1 if symbolic or out of range)
+int64_t tensorDim(const Ort::TypeInfo& info, size_t axis) {
+    auto shape = info.GetTensorTypeAndShapeInfo().GetShape();
+    return axis < shape.size() ? shape[axis] : -1;
+}
+
+// FNV-1a step over one token id, for decoder cache keys
+uint64_t hashToken(uint64_t hash, int token) {
+    return (hash ^ static_cast<uint32_t>(token)) * 0x100000001B3ull;
+}
+
+} // namespace
+
 ZipformerRNNT::ZipformerRNNT(const Config& config)
+    : ZipformerRNNT(config, nullptr) {
+}
+
+ZipformerRNNT::ZipformerRNNT(const Config& config, std::shared_ptr<const SharedModel> model)
     : config_(config)
-    , env_(ORT_LOGGING_LEVEL_WARNING, "ZipformerRNNT")
+    , model_(std::move(model))
     , memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {
 }
 
 ZipformerRNNT::~ZipformerRNNT() = default;
 
-bool ZipformerRNNT::initialize() {
+std::shared_ptr<const ZipformerRNNT::SharedModel> ZipformerRNNT::loadSharedModel(const Config& config) {
+    const std::string encoder_path = OrtRuntime::selectModel(config.encoder_path, config.quantized_encoder);
+    std::string key = encoder_path + "|" + config.decoder_path + "|" + config.joiner_path +
+                      "|" + config.tokens_path;
+    if (config.fixed_shape_encoder) {
+        key += "|fixed" + std::to_string(config.chunk_size);
+    }
+    
+    // Held across the load so concurrent callers wait for one copy
+    std::lock_guard<std::mutex> lock(g_models_mutex);
+    auto existing = g_models[key].lock();
+    if (existing) {
+        std::cout << "Reusing loaded Zipformer model for " << encoder_path << std::endl;
+        return existing;
+    }
+    
     try {
-        // Configure session options
-        session_options_.SetIntraOpNumThreads(config_.num_threads);
-        session_options_.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        auto model = std::make_shared<SharedModel>();
+        // Sessions run on the process-wide thread pools
+        OrtRuntime::SessionConfig session_config;
+        session_config.optimization_level = GraphOptimizationLevel::ORT_ENABLE_ALL;
+        session_config.intra_op_threads = config.num_threads;
+        session_config.cache_optimized_model = config.cache_optimized_model;
+        session_config.memory_map = config.memory_map_model;
         
-        // Load encoder
-        std::cout << "Loading encoder from: " << config_.encoder_path << std::endl;
-        encoder_ = std::make_unique<Ort::Session>(env_, config_.encoder_path.c_str(), session_options_);
+        // Load tokens first; a bad tokens file fails before the expensive loads
+        if (!loadTokens(config.tokens_path, *model)) {
+            return nullptr;
+        }
         
-        // Load decoder
-        std::cout << "Loading decoder from: " << config_.decoder_path << std::endl;
-        decoder_ = std::make_unique<Ort::Session>(env_, config_.decoder_path.c_str(), session_options_);
+        // Encoder, decoder and joiner load in parallel
+        std::cout << "Loading encoder, decoder and joiner from: " << encoder_path << ", "
+                  << config.decoder_path << ", " << config.joiner_path << std::endl;
+        auto sessions = OrtRuntime::instance().loadSessions({
+            {encoder_path, session_config},
+            {config.decoder_path, session_config},
+            {config.joiner_path, session_config}});
+        model->encoder = sessions[0];
+        model->decoder = sessions[1];
+        model->joiner = sessions[2];
+        model->encoder_path = encoder_path;
         
-        // Load joiner
-        std::cout << "Loading joiner from: " << config_.joiner_path << std::endl;
-        joiner_ = std::make_unique<Ort::Session>(env_, config_.joiner_path.c_str(), session_options_);
+        // Prediction network shapes; batch and context come from the export
+        // when fixed there, otherwise from the config
+        int64_t joiner_dim = tensorDim(model->joiner->GetInputTypeInfo(0), 1);
+        int64_t decoder_out_dim = tensorDim(model->decoder->GetOutputTypeInfo(0), 1);
+        int64_t context_size = tensorDim(model->decoder->GetInputTypeInfo(0), 1);
+        int64_t vocab_size = tensorDim(model->joiner->GetOutputTypeInfo(0), 1);
+        model->joiner_dim = joiner_dim > 0 ? joiner_dim : 512;
+        model->decoder_out_dim = decoder_out_dim > 0 ? decoder_out_dim : config.decoder_dim;
+        model->context_size = context_size > 0 ? context_size : config.context_size;
+        model->vocab_size = vocab_size > 0 ? vocab_size : static_cast<int64_t>(model->tokens.size());
+        model->decoder_max_batch = std::max<int64_t>(0, tensorDim(model->decoder->GetInputTypeInfo(0), 0));
+        model->joiner_max_batch = std::max<int64_t>(0, tensorDim(model->joiner->GetInputTypeInfo(0), 0));
+        if (model->blank_id >= model->vocab_size) {
+            std::cerr << "Blank id " << model->blank_id << " outside joiner vocabulary of "
+                      << model->vocab_size << std::endl;
+            return nullptr;
+        }
         
-        // Load tokens
-        if (!loadTokens(config_.tokens_path)) {
-            return false;
+        // Fixed-shape mode: chunks are always padded to chunk_size frames, so
+        // reload the encoder with the free dimensions of "x" pinned to that shape
+        if (config.fixed_shape_encoder) {
+            OrtRuntime::SessionConfig fixed_config = session_config;
+            fixed_config.free_dimension_overrides = OrtRuntime::fixedShapeOverrides(
+                *model->encoder, 0, {1, config.chunk_size, config.feature_dim});
+            if (fixed_config.free_dimension_overrides.empty()) {
+                std::cout << "Encoder has no named free dimensions; keeping the dynamic-shape session" << std::endl;
+            } else {
+                model->encoder = OrtRuntime::instance().getSession(encoder_path, fixed_config);
+                model->fixed_shape = true;
+                std::cout << "Encoder specialized to " << config.chunk_size << "-frame chunks" << std::endl;
+            }
+        }
+        
+        g_models[key] = model;
+        return model;
+        
+    } catch (const Ort::Exception& e) {
+        std::cerr << "ONNX Runtime error: " << e.what() << std::endl;
+        return nullptr;
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading Zipformer model: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+bool ZipformerRNNT::initialize() {
+    try {
+        if (!model_) {
+            model_ = loadSharedModel(config_);
+            if (!model_) {
+                return false;
+            }
         }
         
-        // Initialize cache state
+        // Initialize cache state and the encoder I/O that views it
         cache_state_.initialize(config_);
+        initializeEncoderIO();
         
         // Initialize with empty hypothesis
         reset();
@@ -52,6 +152,74 @@ bool ZipformerRNNT::initialize() {
     } catch (const Ort::Exception& e) {
         std::cerr << "ONNX Runtime error: " << e.what() << std::endl;
         return false;
+    } catch (const std::exception& e) {
+        std::cerr << "Error initializing ZipformerRNNT: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool ZipformerRNNT::warmUp(int num_chunks) {
+    if (!model_ || num_chunks <= 0) {
+        return false;
+    }
+    
+    try {
+        std::vector<float> silence(config_.chunk_size * config_.feature_dim, 0.0f);
+        for (int i = 0; i < num_chunks; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            beamSearchStep(runEncoder(silence));
+            if (i == 0) {
+                double first_run_ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+                OrtRuntime::instance().recordFirstRun(model_->encoder_path, first_run_ms);
+            }
+        }
+        reset();
+        std::cout << "ZipformerRNNT warm-up done (" << num_chunks << " chunks)" << std::endl;
+        return true;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "ZipformerRNNT warm-up failed: " << e.what() << std::endl;
+        reset();
+        return false;
+    }
+}
+
+std::unique_ptr<ZipformerRNNT> ZipformerRNNT::createStream() const {
+    if (!model_) {
+        return nullptr;
+    }
+    std::unique_ptr<ZipformerRNNT> stream(new ZipformerRNNT(config_, model_));
+    if (!stream->initialize()) {
+        return nullptr;
+    }
+    return stream;
+}
+
+void ZipformerRNNT::initializeEncoderIO() {
+    // Persistent feature buffer followed by the cache views, so a chunk only
+    // copies its features in before Run()
+    encoder_features_.assign(config_.chunk_size * config_.feature_dim, 0.0f);
+    const int64_t feature_shape[3] = {1, config_.chunk_size, config_.feature_dim};
+    
+    encoder_inputs_.clear();
+    encoder_inputs_.push_back(Ort::Value::CreateTensor<float>(
+        memory_info_, encoder_features_.data(), encoder_features_.size(), feature_shape, 3));
+    cache_state_.caches->appendInputViews(encoder_inputs_);
+    
+    // Input names (must match model exactly): "x" then the caches;
+    // outputs: "encoder_out" then the same names with a "new_" prefix
+    const auto& cache_names = cache_state_.caches->getCacheNames();
+    encoder_output_name_storage_.clear();
+    for (const auto& name : cache_names) {
+        encoder_output_name_storage_.push_back("new_" + name);
+    }
+    
+    encoder_input_names_ = {"x"};
+    encoder_output_names_ = {"encoder_out"};
+    for (size_t i = 0; i < cache_names.size(); ++i) {
+        encoder_input_names_.push_back(cache_names[i].c_str());
+        encoder_output_names_.push_back(encoder_output_name_storage_[i].c_str());
     }
 }
 
@@ -82,62 +250,16 @@ ZipformerRNNT::Result ZipformerRNNT::processChunk(const std::vector<float>& feat
 }
 
 std::vector<float> ZipformerRNNT::runEncoder(const std::vector<float>& features) {
-    // Prepare inputs
-    std::vector<Ort::Value> inputs;
-    
-    // Add audio features
-    std::vector<int64_t> feature_shape = {1, config_.chunk_size, config_.feature_dim};
-    inputs.push_back(Ort::Value::CreateTensor<float>(
-        memory_info_,
-        const_cast<float*>(features.data()),
-        features.size(),
-        feature_shape.data(),
-        feature_shape.size()
-    ));
-    
-    // Add all cache tensors
-    auto cache_tensors = cache_state_.toOnnxValues(memory_info_);
-    for (auto& tensor : cache_tensors) {
-        inputs.push_back(std::move(tensor));
-    }
-    
-    // Input names (must match model exactly)
-    std::vector<const char*> input_names = {
-        "x",
-        // Length caches
-        "cached_len_0", "cached_len_1", "cached_len_2", "cached_len_3", "cached_len_4",
-        // Average caches
-        "cached_avg_0", "cached_avg_1", "cached_avg_2", "cached_avg_3", "cached_avg_4",
-        // Key caches
-        "cached_key_0", "cached_key_1", "cached_key_2", "cached_key_3", "cached_key_4",
-        // Value caches
-        "cached_val_0", "cached_val_1", "cached_val_2", "cached_val_3", "cached_val_4",
-        // Value2 caches
-        "cached_val2_0", "cached_val2_1", "cached_val2_2", "cached_val2_3", "cached_val2_4",
-        // Conv1 caches
-        "cached_conv1_0", "cached_conv1_1", "cached_conv1_2", "cached_conv1_3", "cached_conv1_4",
-        // Conv2 caches
-        "cached_conv2_0", "cached_conv2_1", "cached_conv2_2", "cached_conv2_3", "cached_conv2_4"
-    };
-    
-    // Output names
-    std::vector<const char*> output_names = {
-        "encoder_out",
-        // New cache values (same names with "new_" prefix)
-        "new_cached_len_0", "new_cached_len_1", "new_cached_len_2", "new_cached_len_3", "new_cached_len_4",
-        "new_cached_avg_0", "new_cached_avg_1", "new_cached_avg_2", "new_cached_avg_3", "new_cached_avg_4",
-        "new_cached_key_0", "new_cached_key_1", "new_cached_key_2", "new_cached_key_3", "new_cached_key_4",
-        "new_cached_val_0", "new_cached_val_1", "new_cached_val_2", "new_cached_val_3", "new_cached_val_4",
-        "new_cached_val2_0", "new_cached_val2_1", "new_cached_val2_2", "new_cached_val2_3", "new_cached_val2_4",
-        "new_cached_conv1_0", "new_cached_conv1_1", "new_cached_conv1_2", "new_cached_conv1_3", "new_cached_conv1_4",
-        "new_cached_conv2_0", "new_cached_conv2_1", "new_cached_conv2_2", "new_cached_conv2_3", "new_cached_conv2_4"
-    };
+    // Copy the chunk into the bound feature buffer (zero-padded if short)
+    size_t count = std::min(features.size(), encoder_features_.size());
+    std::copy(features.begin(), features.begin() + count, encoder_features_.begin());
+    std::fill(encoder_features_.begin() + count, encoder_features_.end(), 0.0f);
     
     // Run encoder
-    auto outputs = encoder_->Run(
+    auto outputs = model_->encoder->Run(
         Ort::RunOptions{nullptr},
-        input_names.data(), inputs.data(), inputs.size(),
-        output_names.data(), output_names.size()
+        encoder_input_names_.data(), encoder_inputs_.data(), encoder_inputs_.size(),
+        encoder_output_names_.data(), encoder_output_names_.size()
     );
     
     // Extract encoder output
@@ -153,172 +275,267 @@ std::vector<float> ZipformerRNNT::runEncoder(const std::vector<float>& features)
     return encoder_out;
 }
 
-std::vector<float> ZipformerRNNT::runDecoder(const std::vector<int>& tokens,
-                                            const std::vector<float>& /* state */) {
-    // Decoder expects shape [batch, 2] where second dimension is:
-    // [0] = current token
-    // [1] = context (usually 0 for RNN-T)
-    std::vector<int64_t> decoder_input(2);
-    decoder_input[0] = tokens.empty() ? 0 : tokens.back();  // Current token
-    decoder_input[1] = 0;  // Context
-    
-    std::vector<int64_t> token_shape = {1, 2};
-    auto token_tensor = Ort::Value::CreateTensor<int64_t>(
-        memory_info_,
-        decoder_input.data(),
-        decoder_input.size(),
-        token_shape.data(),
-        token_shape.size()
-    );
+void ZipformerRNNT::computeDecoderOutputs() {
+    const size_t num_hyps = hypotheses_.size();
+    const size_t dim = static_cast<size_t>(model_->decoder_out_dim);
+    const size_t context = static_cast<size_t>(model_->context_size);
+    decoder_out_batch_.resize(num_hyps * dim);
+    miss_keys_.clear();
+    miss_rows_.clear();
+    decoder_input_batch_.clear();
+    
+    // The decoder is stateless: its output depends only on the last
+    // context_size tokens, so look each context up in the LRU cache first
+    for (size_t i = 0; i < num_hyps; ++i) {
+        const auto& tokens = hypotheses_[i].tokens;
+        uint64_t key = 0xCBF29CE484222325ull;
+        size_t first = decoder_input_batch_.size();
+        for (size_t c = 0; c < context; ++c) {
+            // Left-padded with blank before the first context_size tokens
+            size_t back = context - c;
+            int token = tokens.size() >= back ? tokens[tokens.size() - back] : model_->blank_id;
+            key = hashToken(key, token);
+            decoder_input_batch_.push_back(token);
+        }
+        
+        auto cached = decoder_cache_index_.find(key);
+        if (cached != decoder_cache_index_.end()) {
+            decoder_cache_.splice(decoder_cache_.begin(), decoder_cache_, cached->second);
+            std::copy(cached->second->output.begin(), cached->second->output.end(),
+                      decoder_out_batch_.begin() + i * dim);
+            decoder_input_batch_.resize(first);
+            ++decoder_cache_hits_;
+            continue;
+        }
+        
+        // Miss: hypotheses sharing a context share one decoder row
+        auto pending = std::find(miss_keys_.begin(), miss_keys_.end(), key);
+        if (pending != miss_keys_.end()) {
+            miss_rows_.push_back({i, static_cast<size_t>(pending - miss_keys_.begin())});
+            decoder_input_batch_.resize(first);
+            ++decoder_cache_hits_;
+            continue;
+        }
+        miss_rows_.push_back({i, miss_keys_.size()});
+        miss_keys_.push_back(key);
+        ++decoder_cache_misses_;
+    }
+    
+    if (miss_keys_.empty()) {
+        return;
+    }
+    
+    // One decoder call over every missing context (in slices of the exported
+    // batch size if the model has a fixed one; padding rows repeat the last)
+    const size_t num_misses = miss_keys_.size();
+    const size_t batch = model_->decoder_max_batch > 0 ?
+        static_cast<size_t>(model_->decoder_max_batch) : num_misses;
+    const size_t padded = (num_misses + batch - 1) / batch * batch;
+    for (size_t row = num_misses; row < padded; ++row) {
+        decoder_input_batch_.insert(decoder_input_batch_.end(),
+                                    decoder_input_batch_.end() - context, decoder_input_batch_.end());
+    }
+    decoder_miss_out_.resize(padded * dim);
     
-    // Run decoder
     const char* input_names[] = {"y"};
     const char* output_names[] = {"decoder_out"};
+    for (size_t offset = 0; offset < padded; offset += batch) {
+        const int64_t input_shape[2] = {static_cast<int64_t>(batch), static_cast<int64_t>(context)};
+        const int64_t output_shape[2] = {static_cast<int64_t>(batch), static_cast<int64_t>(dim)};
+        auto input = Ort::Value::CreateTensor<int64_t>(
+            memory_info_, decoder_input_batch_.data() + offset * context, batch * context, input_shape, 2);
+        auto output = Ort::Value::CreateTensor<float>(
+            memory_info_, decoder_miss_out_.data() + offset * dim, batch * dim, output_shape, 2);
+        model_->decoder->Run(Ort::RunOptions{nullptr}, input_names, &input, 1, output_names, &output, 1);
+        ++decoder_runs_;
+    }
     
-    auto outputs = decoder_->Run(
-        Ort::RunOptions{nullptr},
-        input_names, &token_tensor, 1,
-        output_names, 1
-    );
-    
-    // Extract decoder output
-    float* decoder_data = outputs[0].GetTensorMutableData<float>();
-    auto shape = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
-    size_t decoder_size = shape[shape.size()-1];  // Last dimension is decoder output size
+    for (const auto& row : miss_rows_) {
+        const float* out = decoder_miss_out_.data() + row.second * dim;
+        std::copy(out, out + dim, decoder_out_batch_.begin() + row.first * dim);
+    }
     
-    return std::vector<float>(decoder_data, decoder_data + decoder_size);
+    if (config_.decoder_cache_size <= 0) {
+        return;
+    }
+    for (size_t m = 0; m < num_misses; ++m) {
+        const float* out = decoder_miss_out_.data() + m * dim;
+        if (decoder_cache_.size() >= static_cast<size_t>(config_.decoder_cache_size)) {
+            // Reuse the least recently used entry's storage
+            decoder_cache_index_.erase(decoder_cache_.back().key);
+            decoder_cache_.splice(decoder_cache_.begin(), decoder_cache_, std::prev(decoder_cache_.end()));
+        } else {
+            decoder_cache_.emplace_front();
+        }
+        auto& entry = decoder_cache_.front();
+        entry.key = miss_keys_[m];
+        entry.output.assign(out, out + dim);
+        decoder_cache_index_[entry.key] = decoder_cache_.begin();
+    }
 }
 
-std::vector<float> ZipformerRNNT::runJoiner(const std::vector<float>& encoder_out,
-                                           const std::vector<float>& decoder_out) {
-    // Joiner expects [batch, 512] for both inputs
-    std::vector<int64_t> shape = {1, 512};
-    
-    std::vector<Ort::Value> inputs;
-    inputs.push_back(Ort::Value::CreateTensor<float>(
-        memory_info_,
-        const_cast<float*>(encoder_out.data()),
-        encoder_out.size(),
-        shape.data(),
-        shape.size()
-    ));
-    
-    inputs.push_back(Ort::Value::CreateTensor<float>(
-        memory_info_,
-        const_cast<float*>(decoder_out.data()),
-        decoder_out.size(),
-        shape.data(),
-        shape.size()
-    ));
-    
-    // Run joiner
+void ZipformerRNNT::runJoiner(const float* encoder_frame, size_t num_hyps) {
+    const size_t joiner_dim = static_cast<size_t>(model_->joiner_dim);
+    const size_t decoder_dim = static_cast<size_t>(model_->decoder_out_dim);
+    const size_t vocab_size = static_cast<size_t>(model_->vocab_size);
+    const size_t batch = model_->joiner_max_batch > 0 ?
+        static_cast<size_t>(model_->joiner_max_batch) : num_hyps;
+    const size_t padded = (num_hyps + batch - 1) / batch * batch;
+    
+    // Every hypothesis is joined with the same encoder frame
+    joiner_encoder_batch_.resize(padded * joiner_dim);
+    for (size_t row = 0; row < padded; ++row) {
+        std::copy(encoder_frame, encoder_frame + joiner_dim, joiner_encoder_batch_.begin() + row * joiner_dim);
+    }
+    decoder_out_batch_.resize(padded * decoder_dim);
+    logits_batch_.resize(padded * vocab_size);
+    
     const char* input_names[] = {"encoder_out", "decoder_out"};
     const char* output_names[] = {"logit"};
-    
-    auto outputs = joiner_->Run(
-        Ort::RunOptions{nullptr},
-        input_names, inputs.data(), inputs.size(),
-        output_names, 1
-    );
-    
-    // Extract logits
-    float* logits = outputs[0].GetTensorMutableData<float>();
-    auto output_shape = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
-    size_t vocab_size = output_shape[output_shape.size()-1];
-    
-    return std::vector<float>(logits, logits + vocab_size);
+    for (size_t offset = 0; offset < padded; offset += batch) {
+        const int64_t encoder_shape[2] = {static_cast<int64_t>(batch), static_cast<int64_t>(joiner_dim)};
+        const int64_t decoder_shape[2] = {static_cast<int64_t>(batch), static_cast<int64_t>(decoder_dim)};
+        const int64_t logit_shape[2] = {static_cast<int64_t>(batch), static_cast<int64_t>(vocab_size)};
+        Ort::Value inputs[2] = {
+            Ort::Value::CreateTensor<float>(memory_info_, joiner_encoder_batch_.data() + offset * joiner_dim,
+                                            batch * joiner_dim, encoder_shape, 2),
+            Ort::Value::CreateTensor<float>(memory_info_, decoder_out_batch_.data() + offset * decoder_dim,
+                                            batch * decoder_dim, decoder_shape, 2)};
+        auto logits = Ort::Value::CreateTensor<float>(
+            memory_info_, logits_batch_.data() + offset * vocab_size, batch * vocab_size, logit_shape, 2);
+        model_->joiner->Run(Ort::RunOptions{nullptr}, input_names, inputs, 2, output_names, &logits, 1);
+        ++joiner_runs_;
+    }
 }
 
 void ZipformerRNNT::beamSearchStep(const std::vector<float>& encoder_out) {
-    // Temporary storage for new hypotheses
-    std::priority_queue<Hypothesis> candidates;
-    
-    // The encoder output is [batch, time, 512]
-    // For joiner, we need to process each time step
-    // For now, let's process the last frame (most recent)
-    size_t encoder_dim = 512;
-    size_t num_frames = encoder_out.size() / encoder_dim;
-    
-    // Extract last frame
-    std::vector<float> last_encoder_frame(encoder_dim);
-    if (num_frames > 0) {
-        size_t offset = (num_frames - 1) * encoder_dim;
-        std::copy(encoder_out.begin() + offset, 
-                  encoder_out.begin() + offset + encoder_dim,
-                  last_encoder_frame.begin());
+    // The encoder output is [1, frames, joiner_dim]; search every frame in order
+    const size_t joiner_dim = static_cast<size_t>(model_->joiner_dim);
+    const size_t num_frames = encoder_out.size() / joiner_dim;
+    const bool greedy = config_.decoding_method == "greedy_search";
+    for (size_t t = 0; t < num_frames; ++t) {
+        if (greedy) {
+            greedyFrame(encoder_out.data() + t * joiner_dim);
+        } else {
+            searchFrame(encoder_out.data() + t * joiner_dim);
+        }
+        ++frames_decoded_;
+    }
+}
+
+void ZipformerRNNT::greedyFrame(const float* encoder_frame) {
+    if (hypotheses_.size() > 1) {
+        hypotheses_.resize(1);
     }
+    Hypothesis& hyp = hypotheses_[0];
+    const size_t vocab_size = static_cast<size_t>(model_->vocab_size);
     
-    // Process each current hypothesis
-    for (const auto& hyp : hypotheses_) {
-        // Run decoder with current hypothesis
-        auto decoder_out = runDecoder(hyp.tokens, hyp.decoder_state);
-        
-        // Run joiner to get next token probabilities
-        auto logits = runJoiner(last_encoder_frame, decoder_out);
+    for (int symbol = 0; symbol < std::max(1, config_.max_symbols_per_frame); ++symbol) {
+        computeDecoderOutputs();
+        runJoiner(encoder_frame, 1);
         
-        // Apply softmax to get probabilities
-        float max_logit = *std::max_element(logits.begin(), logits.end());
+        float* row = logits_batch_.data();
+        row[model_->blank_id] -= config_.blank_penalty;
+        const int best = static_cast<int>(std::max_element(row, row + vocab_size) - row);
         float sum_exp = 0.0f;
-        for (auto& logit : logits) {
-            logit = std::exp(logit - max_logit);
-            sum_exp += logit;
-        }
-        for (auto& logit : logits) {
-            logit = std::log(logit / sum_exp);  // Log probabilities
+        for (size_t v = 0; v < vocab_size; ++v) {
+            sum_exp += std::exp(row[v] - row[best]);
         }
+        hyp.score -= std::log(sum_exp);  // log-probability of the argmax
         
-        // Consider top-k tokens
-        std::vector<std::pair<float, int>> token_scores;
-        int vocab_size = std::min(static_cast<int>(tokens_.size()), static_cast<int>(logits.size()));
-        for (int i = 0; i < vocab_size; ++i) {
-            token_scores.push_back({logits[i], i});
+        if (best == model_->blank_id) {
+            break;
         }
+        hyp.tokens.push_back(best);
+    }
+}
+
+void ZipformerRNNT::searchFrame(const float* encoder_frame) {
+    // Modified beam search: at most one symbol per hypothesis per frame
+    const size_t num_hyps = hypotheses_.size();
+    const size_t vocab_size = static_cast<size_t>(model_->vocab_size);
+    const size_t beam = static_cast<size_t>(std::max(1, config_.beam_size));
+    const size_t top_k = std::min(beam, vocab_size);
+    
+    computeDecoderOutputs();
+    runJoiner(encoder_frame, num_hyps);
+    
+    // Per hypothesis: log-softmax, then only its top beam tokens can survive
+    candidates_.clear();
+    token_order_.resize(vocab_size);
+    for (size_t h = 0; h < num_hyps; ++h) {
+        float* row = logits_batch_.data() + h * vocab_size;
+        row[model_->blank_id] -= config_.blank_penalty;
+        float max_logit = *std::max_element(row, row + vocab_size);
+        float sum_exp = 0.0f;
+        for (size_t v = 0; v < vocab_size; ++v) {
+            sum_exp += std::exp(row[v] - max_logit);
+        }
+        const float log_norm = max_logit + std::log(sum_exp);
         
-        std::sort(token_scores.begin(), token_scores.end(),
-                 [](const auto& a, const auto& b) { return a.first > b.first; });
-        
-        // Take only top-k tokens
-        int k = std::min(10, static_cast<int>(token_scores.size()));
-        token_scores.resize(k);
-        
-        // Create new hypotheses
-        for (const auto& score_token : token_scores) {
-            float score = score_token.first;
-            int token_id = score_token.second;
-            Hypothesis new_hyp = hyp;
-            
-            if (token_id != blank_id_) {
-                // Non-blank token: add to sequence
-                new_hyp.tokens.push_back(token_id);
-            }
-            
-            new_hyp.score = hyp.score + score;
-            new_hyp.decoder_state = decoder_out;  // Update decoder state
-            
-            candidates.push(new_hyp);
-            if (candidates.size() > static_cast<size_t>(config_.beam_size * 2)) {
-                candidates.pop();  // Keep only top candidates
-            }
+        std::iota(token_order_.begin(), token_order_.end(), 0);
+        std::nth_element(token_order_.begin(), token_order_.begin() + (top_k - 1), token_order_.end(),
+                         [row](int a, int b) { return row[a] > row[b]; });
+        for (size_t k = 0; k < top_k; ++k) {
+            int token = token_order_[k];
+            candidates_.push_back({hypotheses_[h].score + row[token] - log_norm,
+                                   static_cast<int>(h), token});
         }
     }
     
-    // Select top beam_size hypotheses
-    hypotheses_.clear();
-    while (!candidates.empty() && hypotheses_.size() < static_cast<size_t>(config_.beam_size)) {
-        hypotheses_.push_back(candidates.top());
-        candidates.pop();
+    // Global top beam over the num_hyps * top_k candidates
+    auto better = [](const Candidate& a, const Candidate& b) { return a.score > b.score; };
+    if (candidates_.size() > beam) {
+        std::nth_element(candidates_.begin(), candidates_.begin() + (beam - 1), candidates_.end(), better);
+        candidates_.resize(beam);
     }
-    
-    // Reverse to have best hypothesis first
-    std::reverse(hypotheses_.begin(), hypotheses_.end());
+    std::sort(candidates_.begin(), candidates_.end(), better);
+    
+    // Expand; a hypothesis reached along two paths (blank after "a b" and
+    // "b" after "a") keeps one entry with the summed probability
+    next_hypotheses_.clear();
+    for (const auto& candidate : candidates_) {
+        Hypothesis hyp;
+        hyp.tokens = hypotheses_[candidate.hyp].tokens;
+        if (candidate.token != model_->blank_id) {
+            hyp.tokens.push_back(candidate.token);
+        }
+        hyp.score = candidate.score;
+        
+        auto same = std::find_if(next_hypotheses_.begin(), next_hypotheses_.end(),
+                                 [&hyp](const Hypothesis& other) { return other.tokens == hyp.tokens; });
+        if (same == next_hypotheses_.end()) {
+            next_hypotheses_.push_back(std::move(hyp));
+        } else {
+            float high = std::max(same->score, hyp.score);
+            float low = std::min(same->score, hyp.score);
+            same->score = high + std::log1p(std::exp(low - high));
+        }
+    }
+    std::sort(next_hypotheses_.begin(), next_hypotheses_.end(),
+              [](const Hypothesis& a, const Hypothesis& b) { return a.score > b.score; });
+    hypotheses_.swap(next_hypotheses_);
+}
+
+std::map<std::string, double> ZipformerRNNT::getStats() const {
+    std::map<std::string, double> stats;
+    stats["frames_decoded"] = static_cast<double>(frames_decoded_);
+    stats["decoder_runs"] = static_cast<double>(decoder_runs_);
+    stats["joiner_runs"] = static_cast<double>(joiner_runs_);
+    stats["decoder_cache_hits"] = static_cast<double>(decoder_cache_hits_);
+    stats["decoder_cache_misses"] = static_cast<double>(decoder_cache_misses_);
+    uint64_t lookups = decoder_cache_hits_ + decoder_cache_misses_;
+    stats["decoder_cache_hit_rate"] = lookups > 0 ?
+        static_cast<double>(decoder_cache_hits_) / lookups : 0.0;
+    return stats;
 }
 
 std::string ZipformerRNNT::tokensToText(const std::vector<int>& tokens) {
     std::string text;
     
     for (int token_id : tokens) {
-        if (token_id >= 0 && token_id < static_cast<int>(tokens_.size())) {
-            const std::string& token = tokens_[token_id];
+        if (token_id >= 0 && token_id < static_cast<int>(model_->tokens.size())) {
+            const std::string& token = model_->tokens[token_id];
             
             // Handle BPE tokens (e.g., "▁" for word boundaries)
             if (token.find("▁") == 0) {
@@ -335,35 +552,35 @@ std::string ZipformerRNNT::tokensToText(const std::vector<int>& tokens) {
     return text;
 }
 
-bool ZipformerRNNT::loadTokens(const std::string& path) {
+bool ZipformerRNNT::loadTokens(const std::string& path, SharedModel& model) {
     std::ifstream file(path);
     if (!file.is_open()) {
         std::cerr << "Failed to open tokens file: " << path << std::endl;
         return false;
     }
     
-    tokens_.clear();
+    model.tokens.clear();
     std::string line;
     
     while (std::getline(file, line)) {
         // Format: "token id" or just "token"
         size_t space_pos = line.find_last_of(' ');
         if (space_pos != std::string::npos) {
-            tokens_.push_back(line.substr(0, space_pos));
+            model.tokens.push_back(line.substr(0, space_pos));
         } else {
-            tokens_.push_back(line);
+            model.tokens.push_back(line);
         }
     }
     
     // Find blank token (usually "<blk>" or similar)
-    for (size_t i = 0; i < tokens_.size(); ++i) {
-        if (tokens_[i] == "<blk>" || tokens_[i] == "<blank>") {
-            blank_id_ = i;
+    for (size_t i = 0; i < model.tokens.size(); ++i) {
+        if (model.tokens[i] == "<blk>" || model.tokens[i] == "<blank>") {
+            model.blank_id = i;
             break;
         }
     }
     
-    std::cout << "Loaded " << tokens_.size() << " tokens, blank_id=" << blank_id_ << std::endl;
+    std::cout << "Loaded " << model.tokens.size() << " tokens, blank_id=" << model.blank_id << std::endl;
     return true;
 }
 
@@ -382,15 +599,14 @@ ZipformerRNNT::Result ZipformerRNNT::finalize() {
 }
 
 void ZipformerRNNT::reset() {
-    // Reset cache state
-    cache_state_.initialize(config_);
+    // Reset cache state (zeroes the arena; views stay valid)
+    cache_state_.reset();
     
     // Reset hypotheses with empty sequence
     hypotheses_.clear();
     Hypothesis empty_hyp;
     empty_hyp.tokens.clear();
     empty_hyp.score = 0.0f;
-    empty_hyp.decoder_state.resize(config_.decoder_dim, 0.0f);
     hypotheses_.push_back(empty_hyp);
 }
 
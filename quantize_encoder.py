@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""
+Create the INT8 encoder variant loaded by the quantizedEncoder option.
+
+Writes <model>.int8.onnx next to the FP32 model, with dynamically quantized
+INT8 weights. Only MatMul/Gemm are quantized by default: ORT's CPU ConvInteger
+kernel is slower than FP32 Conv, while the MatMuls (attention and feed-forward)
+are where FastConformer spends its time and map onto VNNI instructions.
+
+Usage:
+    python quantize_encoder.py models/proven_onnx_export/encoder-proven_fastconformer.onnx
+    python quantize_encoder.py models/fastconformer_ctc_export/model.onnx --per-channel
+"""
+import argparse
+import os
+import sys
+
+from onnxruntime.quantization import QuantType, quantize_dynamic
+
+
+def quantized_path(model_path):
+    base = model_path[:-5] if model_path.endswith(".onnx") else model_path
+    return base + ".int8.onnx"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Quantize an ONNX encoder to INT8 (dynamic)")
+    parser.add_argument("model", help="FP32 ONNX model")
+    parser.add_argument("--output", help="output path (default: <model>.int8.onnx)")
+    parser.add_argument("--per-channel", action="store_true",
+                        help="per-channel weight scales (better accuracy, slightly slower)")
+    parser.add_argument("--include-conv", action="store_true",
+                        help="also quantize Conv (usually slower on CPU)")
+    parser.add_argument("--external-data", action="store_true",
+                        help="store weights in an external data file (models over 2 GB)")
+    args = parser.parse_args()
+
+    if not os.path.exists(args.model):
+        print(f"❌ Model not found: {args.model}")
+        return 1
+
+    output = args.output or quantized_path(args.model)
+    op_types = ["MatMul", "Gemm"] + (["Conv"] if args.include_conv else [])
+
+    print(f"Quantizing {args.model} -> {output}")
+    print(f"  Ops: {', '.join(op_types)}, per-channel: {args.per_channel}")
+
+    quantize_dynamic(
+        model_input=args.model,
+        model_output=output,
+        op_types_to_quantize=op_types,
+        per_channel=args.per_channel,
+        weight_type=QuantType.QInt8,
+        use_external_data_format=args.external_data,
+    )
+
+    fp32_mb = os.path.getsize(args.model) / (1024 * 1024)
+    int8_mb = os.path.getsize(output) / (1024 * 1024)
+    print(f"✅ Wrote {output} ({fp32_mb:.1f} MiB -> {int8_mb:.1f} MiB)")
+    print("Compare against FP32 with: make benchmark-int8")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
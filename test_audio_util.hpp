@@ -0,0 +1,37 @@
+#ifndef TEST_AUDIO_UTIL_HPP
+#define TEST_AUDIO_UTIL_HPP
+
+#include <sndfile.h>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Shared by the root benchmark programs: read a 16 kHz file into mono floats
+// (channels averaged); other rates are skipped with a note
+inline bool loadMono16k(const std::string& path, std::vector<float>& audio) {
+    SF_INFO info;
+    std::memset(&info, 0, sizeof(info));
+    SNDFILE* file = sf_open(path.c_str(), SFM_READ, &info);
+    if (!file) {
+        return false;
+    }
+    if (info.samplerate != 16000) {
+        std::cout << "  skipping " << path << " (" << info.samplerate << " Hz)" << std::endl;
+        sf_close(file);
+        return false;
+    }
+    std::vector<float> frames(static_cast<size_t>(info.frames) * info.channels);
+    sf_readf_float(file, frames.data(), info.frames);
+    sf_close(file);
+
+    audio.assign(static_cast<size_t>(info.frames), 0.0f);
+    for (sf_count_t i = 0; i < info.frames; ++i) {
+        for (int ch = 0; ch < info.channels; ++ch) {
+            audio[i] += frames[i * info.channels + ch] / info.channels;
+        }
+    }
+    return true;
+}
+
+#endif // TEST_AUDIO_UTIL_HPP
@@ -0,0 +1,336 @@
+#include "impl/include/BatchScheduler.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// BatchScheduler against a CPU stand-in for the encoder: no model files or
+// ONNX Runtime session. The fake model gathers every stream's cache along a
+// batch axis, adds one to it and scatters it back, so each result carries the
+// number of chunks its stream has seen (i.e. whether caches stayed per stream).
+
+using namespace onnx_stt;
+using Clock = std::chrono::steady_clock;
+
+// Cache [2, 1, 3] batched along axis 1, like the encoder's channel cache
+static const std::vector<int64_t> kCacheShape = {2, 1, 3};
+static const int kCacheAxis = 1;
+
+class FakeModel : public BatchModel {
+public:
+    bool processBatch(std::vector<BatchEntry>& entries) override {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ++calls_;
+            cv_.notify_all();
+            cv_.wait(lock, [this] { return !held_; });
+            batch_sizes_.push_back(entries.size());
+            std::set<const StreamCache*> streams;
+            for (const auto& entry : entries) {
+                streams.insert(entry.cache);
+            }
+            duplicate_streams_ |= streams.size() != entries.size();
+        }
+
+        std::vector<const float*> in;
+        std::vector<float*> out;
+        for (auto& entry : entries) {
+            in.push_back(entry.cache->cache_last_channel.data());
+            out.push_back(entry.cache->cache_last_channel.data());
+        }
+        std::vector<int64_t> shape = withBatch(kCacheShape, kCacheAxis, static_cast<int64_t>(entries.size()));
+        std::vector<float> batched(elementCount(shape));
+        gatherBatch(in, shape, kCacheAxis, batched.data());
+        for (float& value : batched) {
+            value += 1.0f;
+        }
+        scatterBatch(batched.data(), shape, kCacheAxis, out);
+
+        for (auto& entry : entries) {
+            entry.result->text = std::to_string(static_cast<int>(entry.cache->cache_last_channel[0]));
+            entry.result->is_final = true;
+        }
+        return true;
+    }
+
+    StreamCache createStreamCache() const override {
+        StreamCache cache;
+        cache.cache_last_channel.assign(elementCount(kCacheShape), 0.0f);
+        return cache;
+    }
+
+    void resetStreamCache(StreamCache& cache) const override {
+        std::fill(cache.cache_last_channel.begin(), cache.cache_last_channel.end(), 0.0f);
+    }
+
+    int getMaxBatchSize() const override { return 4; }
+
+    // Block processBatch() until release(); waitForCall() returns once a call is blocked
+    void hold() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_ = true;
+    }
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_ = false;
+        cv_.notify_all();
+    }
+    bool waitForCall(int calls) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, std::chrono::seconds(5), [this, calls] { return calls_ >= calls; });
+    }
+
+    std::vector<size_t> batchSizes() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return batch_sizes_;
+    }
+    bool duplicateStreams() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return duplicate_streams_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool held_ = false;
+    int calls_ = 0;
+    std::vector<size_t> batch_sizes_;
+    bool duplicate_streams_ = false;
+};
+
+// Results collected from the worker thread
+struct Results {
+    struct Item {
+        int stream;
+        uint64_t timestamp_ms;
+        std::string text;
+        Clock::time_point at;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Item> items;
+
+    BatchScheduler::Callback callback(int stream) {
+        return [this, stream](const ModelInterface::TranscriptionResult& result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            items.push_back({stream, result.timestamp_ms, result.text, Clock::now()});
+            cv.notify_all();
+        };
+    }
+
+    bool waitFor(size_t count, int timeout_ms = 5000) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this, count] { return items.size() >= count; });
+    }
+};
+
+static bool check(bool condition, const std::string& what) {
+    std::cout << (condition ? "✅ " : "❌ ") << what << std::endl;
+    return condition;
+}
+
+static std::vector<float> kFrame(80, 0.0f);
+static FeatureView frame() { return FeatureView(kFrame.data(), 1, kFrame.size()); }
+
+static bool testGatherScatter() {
+    const size_t batch = 3;
+    std::vector<std::vector<float>> streams(batch, std::vector<float>(elementCount(kCacheShape)));
+    std::vector<const float*> in;
+    std::vector<float*> out;
+    std::vector<std::vector<float>> copies(batch, std::vector<float>(elementCount(kCacheShape), -1.0f));
+    for (size_t b = 0; b < batch; ++b) {
+        for (size_t i = 0; i < streams[b].size(); ++i) {
+            streams[b][i] = static_cast<float>(100 * b + i);
+        }
+        in.push_back(streams[b].data());
+        out.push_back(copies[b].data());
+    }
+    std::vector<int64_t> shape = withBatch(kCacheShape, kCacheAxis, batch);
+    std::vector<float> batched(elementCount(shape));
+    gatherBatch(in, shape, kCacheAxis, batched.data());
+
+    // [2, batch, 3]: outer index o, stream b, inner index k
+    bool layout_ok = true;
+    for (size_t o = 0; o < 2; ++o) {
+        for (size_t b = 0; b < batch; ++b) {
+            for (size_t k = 0; k < 3; ++k) {
+                layout_ok &= batched[(o * batch + b) * 3 + k] == streams[b][o * 3 + k];
+            }
+        }
+    }
+    scatterBatch(batched.data(), shape, kCacheAxis, out);
+    return check(layout_ok, "gatherBatch interleaves streams along the batch axis") &
+           check(copies == streams, "scatterBatch restores every stream's tensor");
+}
+
+static bool testOrdering() {
+    auto model = std::make_shared<FakeModel>();
+    BatchScheduler::Config config;
+    config.max_wait_ms = 5;
+    config.max_pending_per_stream = 8;
+    BatchScheduler scheduler(model, config);
+    scheduler.start();
+
+    const int streams = 6;
+    const int chunks = 5;
+    Results results;
+    std::vector<int> ids;
+    for (int s = 0; s < streams; ++s) {
+        ids.push_back(scheduler.openStream());
+    }
+    for (int c = 0; c < chunks; ++c) {
+        for (int s = 0; s < streams; ++s) {
+            scheduler.submit(ids[s], frame(), static_cast<uint64_t>(c), results.callback(s));
+        }
+    }
+    bool all = results.waitFor(streams * chunks);
+    scheduler.stop();
+
+    // Per stream: timestamps in submit order and chunk counts 1, 2, 3, ... from its own cache
+    std::vector<int> seen(streams, 0);
+    bool in_order = all;
+    for (const auto& item : results.items) {
+        in_order &= item.timestamp_ms == static_cast<uint64_t>(seen[item.stream]) &&
+                    item.text == std::to_string(seen[item.stream] + 1);
+        ++seen[item.stream];
+    }
+    size_t largest = 0;
+    for (size_t size : model->batchSizes()) {
+        largest = std::max(largest, size);
+    }
+    return check(all, "all chunks delivered") &
+           check(in_order, "each stream's chunks run in order on its own cache") &
+           check(!model->duplicateStreams(), "at most one chunk per stream in a batch") &
+           check(largest > 1 && largest <= 4, "batches hold several streams, up to the model's limit (" +
+                                                  std::to_string(largest) + ")");
+}
+
+static bool testDeadline() {
+    auto model = std::make_shared<FakeModel>();
+    BatchScheduler::Config config;
+    config.max_wait_ms = 200;
+    BatchScheduler scheduler(model, config);
+    scheduler.start();
+    std::vector<int> ids;
+    for (int s = 0; s < 4; ++s) {
+        ids.push_back(scheduler.openStream());
+    }
+
+    // A lone chunk waits for the deadline to fill the batch
+    Results lone;
+    auto submitted = Clock::now();
+    scheduler.submit(ids[0], frame(), 0, lone.callback(0));
+    bool lone_done = lone.waitFor(1);
+    double lone_ms = lone_done ? std::chrono::duration<double, std::milli>(lone.items[0].at - submitted).count() : -1.0;
+
+    // A full batch runs without waiting for it
+    Results full;
+    submitted = Clock::now();
+    for (int s = 0; s < 4; ++s) {
+        scheduler.submit(ids[s], frame(), 1, full.callback(s));
+    }
+    bool full_done = full.waitFor(4);
+    double full_ms = full_done ? std::chrono::duration<double, std::milli>(full.items.back().at - submitted).count() : -1.0;
+    scheduler.stop();
+
+    return check(lone_done && lone_ms >= 190.0 && lone_ms < 2000.0,
+                 "partial batch runs at the max_wait_ms deadline (" + std::to_string(lone_ms) + " ms)") &
+           check(full_done && full_ms < 150.0,
+                 "full batch runs before the deadline (" + std::to_string(full_ms) + " ms)");
+}
+
+static bool testAdmission() {
+    auto model = std::make_shared<FakeModel>();
+    BatchScheduler::Config config;
+    config.max_wait_ms = 0;
+    config.max_streams = 2;
+    config.max_pending_per_stream = 2;
+    config.max_pending_total = 3;
+    BatchScheduler scheduler(model, config);
+    bool ok = check(!scheduler.submit(0, frame(), 0, nullptr), "submit before start() is rejected");
+    scheduler.start();
+
+    int a = scheduler.openStream();
+    int b = scheduler.openStream();
+    ok &= check(a >= 0 && b >= 0 && scheduler.openStream() == -1, "openStream() stops at max_streams");
+
+    // Keep stream a's first chunk in the model so later ones stay queued
+    Results results;
+    model->hold();
+    scheduler.submit(a, frame(), 0, results.callback(a));
+    model->waitForCall(1);
+    bool queued = scheduler.submit(a, frame(), 1, results.callback(a)) &&
+                  scheduler.submit(a, frame(), 2, results.callback(a));
+    bool per_stream = !scheduler.submit(a, frame(), 3, results.callback(a));
+    bool b_first = scheduler.submit(b, frame(), 0, results.callback(b));
+    bool total = !scheduler.submit(b, frame(), 1, results.callback(b));
+    ok &= check(queued && per_stream, "max_pending_per_stream rejects the third queued chunk");
+    ok &= check(b_first && total, "max_pending_total rejects past three queued chunks");
+    ok &= check(scheduler.getStreamStats(a).chunks_rejected == 1 && scheduler.getStreamStats(b).chunks_rejected == 1,
+                "rejections counted per stream");
+    ok &= check(!scheduler.submit(99, frame(), 0, nullptr), "unknown stream is rejected");
+
+    model->release();
+    ok &= check(results.waitFor(4), "admitted chunks all delivered");
+    // Callbacks run before the batch is retired, so a stream closed in flight
+    // gives its slot back a moment later
+    scheduler.closeStream(a);
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (scheduler.getStats()["open_streams"] > 1.0 && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ok &= check(scheduler.openStream() >= 0, "closing a stream frees its slot");
+    scheduler.stop();
+    return ok;
+}
+
+static bool testResetInFlight() {
+    auto model = std::make_shared<FakeModel>();
+    BatchScheduler::Config config;
+    config.max_wait_ms = 0;
+    BatchScheduler scheduler(model, config);
+    scheduler.start();
+    int id = scheduler.openStream();
+
+    Results results;
+    scheduler.submit(id, frame(), 0, results.callback(id));
+    results.waitFor(1);
+
+    // Reset while the stream's second chunk is in the model and two more are queued
+    model->hold();
+    scheduler.submit(id, frame(), 1, results.callback(id));
+    model->waitForCall(2);
+    scheduler.submit(id, frame(), 2, results.callback(id));
+    scheduler.submit(id, frame(), 3, results.callback(id));
+    scheduler.resetStream(id);
+    bool dropped = scheduler.getStats()["pending_chunks"] == 0.0;
+    model->release();
+    results.waitFor(2);
+
+    // The next chunk starts from a zeroed cache, applied after the in-flight batch
+    scheduler.submit(id, frame(), 4, results.callback(id));
+    bool done = results.waitFor(3);
+    scheduler.stop();
+
+    bool ok = check(dropped, "resetStream() drops the stream's queued chunks");
+    ok &= check(done && results.items.size() == 3 && results.items[1].text == "2" &&
+                results.items[2].timestamp_ms == 4 && results.items[2].text == "1",
+                "reset of an in-flight stream is applied after its batch");
+    return ok;
+}
+
+int main() {
+    std::cout << "=== BatchScheduler test (CPU, no model) ===" << std::endl;
+    bool ok = testGatherScatter();
+    ok &= testOrdering();
+    ok &= testDeadline();
+    ok &= testAdmission();
+    ok &= testResetInFlight();
+    std::cout << (ok ? "✅ All batch scheduler tests passed" : "❌ Batch scheduler tests failed") << std::endl;
+    return ok ? 0 : 1;
+}
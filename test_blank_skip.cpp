@@ -0,0 +1,108 @@
+#include "impl/include/ProvenNeMoSTT.hpp"
+#include "test_audio_util.hpp"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Decoder CPU with and without blank-frame skipping on the test_data/audio
+// clips: frames skipped, decoder_joint calls and decode time per clip, and
+// whether the transcript changed.
+//
+// Skipping needs an encoder exported with its CTC head as an extra output
+// (hybrid FastConformer); with a plain encoder every frame is decoded and the
+// two runs should match.
+
+struct Run {
+    std::string transcript;
+    double frames = 0.0;
+    double skipped = 0.0;
+    double calls = 0.0;
+    double decode_ms = 0.0;
+};
+
+// Counters are cumulative, so report the difference across one transcription
+static Run measure(ProvenNeMoSTT& stt, const std::vector<float>& audio) {
+    auto before = stt.getStats();
+    Run run;
+    run.transcript = stt.transcribe(audio, 16000);
+    auto after = stt.getStats();
+    run.frames = after["frames_decoded"] - before["frames_decoded"];
+    run.skipped = after["frames_blank_skipped"] - before["frames_blank_skipped"];
+    run.calls = after["decoder_calls"] - before["decoder_calls"];
+    run.decode_ms = (after["decode_us"] - before["decode_us"]) / 1000.0;
+    return run;
+}
+
+int main(int argc, char* argv[]) {
+    const std::string model_dir = argc > 1 ? argv[1] : "models/proven_onnx_export";
+    const float threshold = argc > 2 ? static_cast<float>(std::atof(argv[2])) : 0.95f;
+    const std::string encoder_path = model_dir + "/encoder-proven_fastconformer.onnx";
+    const std::string decoder_path = model_dir + "/decoder_joint-proven_fastconformer.onnx";
+    const std::string vocab_path = model_dir + "/vocabulary.txt";
+    const std::vector<std::string> clips = {
+        "test_data/audio/librispeech-1995-1837-0001.wav",
+        "test_data/audio/test_16k.wav",
+        "test_data/audio/11-ibm-culture-2min.wav",
+    };
+
+    std::cout << "=== Blank-skip benchmark (threshold " << threshold << ") ===" << std::endl;
+
+    ProvenNeMoSTT full;
+    ProvenNeMoSTT skipping;
+    skipping.setBlankSkipThreshold(threshold);
+    if (!full.initialize(encoder_path, decoder_path, vocab_path) ||
+        !skipping.initialize(encoder_path, decoder_path, vocab_path)) {
+        std::cerr << "❌ Failed to initialize models from " << model_dir << std::endl;
+        return 1;
+    }
+    if (!skipping.hasCtcHead()) {
+        std::cout << "⚠️ Encoder has no CTC output; no frames will be skipped" << std::endl;
+    }
+    full.warmUp(1000);
+    skipping.warmUp(1000);
+
+    double full_ms = 0.0, skip_ms = 0.0, frames = 0.0, skipped = 0.0;
+    size_t clips_run = 0, changed = 0;
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (const auto& clip : clips) {
+        std::vector<float> audio;
+        if (!loadMono16k(clip, audio)) {
+            continue;
+        }
+        Run a = measure(full, audio);
+        Run b = measure(skipping, audio);
+        full_ms += a.decode_ms;
+        skip_ms += b.decode_ms;
+        frames += b.frames;
+        skipped += b.skipped;
+        ++clips_run;
+        if (a.transcript != b.transcript) {
+            ++changed;
+        }
+
+        std::cout << clip << std::endl;
+        std::cout << "  frames=" << b.frames << " skipped=" << b.skipped
+                  << " (" << (b.frames > 0 ? 100.0 * b.skipped / b.frames : 0.0) << "%)" << std::endl;
+        std::cout << "  decoder calls " << a.calls << " -> " << b.calls
+                  << ", decode " << a.decode_ms << " ms -> " << b.decode_ms << " ms" << std::endl;
+        std::cout << "  transcript " << (a.transcript == b.transcript ? "unchanged" : "CHANGED") << std::endl;
+    }
+
+    if (clips_run == 0) {
+        std::cerr << "❌ No 16 kHz clips found under test_data/audio" << std::endl;
+        return 1;
+    }
+
+    std::cout << "\n=== SUMMARY ===" << std::endl;
+    std::cout << "Frames skipped: " << skipped << " of " << frames
+              << " (" << (frames > 0 ? 100.0 * skipped / frames : 0.0) << "%)" << std::endl;
+    std::cout << "Decoder CPU: " << full_ms << " ms -> " << skip_ms << " ms ("
+              << (full_ms > 0 ? 100.0 * (full_ms - skip_ms) / full_ms : 0.0) << "% saved)" << std::endl;
+    std::cout << "Transcripts changed: " << changed << " of " << clips_run << std::endl;
+
+    std::cout << "✅ Benchmark complete" << std::endl;
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "impl/include/CTCPrefixBeamSearch.hpp"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// CTC prefix beam search: correctness on hand-built posteriors, then decode
+// cost on synthetic FastConformer-shaped output (1024 tokens + blank, 80 ms
+// frames). No model or ONNX Runtime needed.
+
+using onnx_stt::CTCPrefixBeamSearch;
+
+static const int kFramesPerSecond = 1000 / 80;
+
+// Log-probs [frames x vocab] from per-frame probability rows
+static std::vector<float> logRows(const std::vector<std::vector<float>>& rows) {
+    std::vector<float> out;
+    for (const auto& row : rows) {
+        for (float p : row) {
+            out.push_back(std::log(p));
+        }
+    }
+    return out;
+}
+
+static bool check(const char* name, bool ok) {
+    std::cout << (ok ? "✅ " : "❌ ") << name << std::endl;
+    return ok;
+}
+
+// Synthetic posteriors: mostly blank, a token spike every few frames, noise elsewhere
+static std::vector<float> syntheticLogits(size_t frames, size_t vocab, int blank, std::mt19937& rng) {
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::uniform_int_distribution<int> token(1, static_cast<int>(vocab) - 2);
+    std::uniform_real_distribution<float> coin(0.0f, 1.0f);
+    std::vector<float> logits(frames * vocab);
+    for (size_t t = 0; t < frames; ++t) {
+        float* row = logits.data() + t * vocab;
+        for (size_t v = 0; v < vocab; ++v) {
+            row[v] = noise(rng);
+        }
+        if (coin(rng) < 0.7f) {
+            row[blank] += 12.0f;
+        } else {
+            row[token(rng)] += 10.0f;
+            row[blank] += 8.0f;  // competing blank keeps several prefixes alive
+        }
+    }
+    return logits;
+}
+
+int main() {
+    std::cout << "=== CTC prefix beam search ===" << std::endl;
+    bool ok = true;
+
+    CTCPrefixBeamSearch::Config config;
+    config.blank_id = 0;
+    config.beam_size = 8;
+
+    // Two frames of P(blank)=0.6, P(a)=0.4: greedy says "", but "a" has 0.64
+    {
+        CTCPrefixBeamSearch search(config);
+        auto scores = logRows({{0.6f, 0.4f}, {0.6f, 0.4f}});
+        search.advance(scores.data(), 2, 2);
+        auto tokens = search.bestTokens();
+        ok &= check("sums paths (beats greedy)", tokens == std::vector<int>{1} &&
+                    std::fabs(std::exp(search.bestScore()) - 0.64f) < 1e-4f);
+    }
+
+    // "a blank a" is two tokens, "a a" collapses to one
+    {
+        CTCPrefixBeamSearch search(config);
+        auto scores = logRows({{0.01f, 0.98f, 0.01f}, {0.98f, 0.01f, 0.01f}, {0.01f, 0.98f, 0.01f}});
+        search.advance(scores.data(), 3, 3);
+        ok &= check("blank separates repeats", search.bestTokens() == std::vector<int>{1, 1});
+
+        CTCPrefixBeamSearch collapse(config);
+        auto repeated = logRows({{0.01f, 0.98f, 0.01f}, {0.01f, 0.98f, 0.01f}});
+        collapse.advance(repeated.data(), 2, 3);
+        ok &= check("repeats collapse", collapse.bestTokens() == std::vector<int>{1});
+    }
+
+    // Streaming: frames fed in pieces give the same result as all at once
+    const size_t vocab = 1025;
+    std::mt19937 rng(7);
+    auto logits = syntheticLogits(200, vocab, 0, rng);
+    CTCPrefixBeamSearch::Config raw = config;
+    raw.inputs_are_log_probs = false;
+    {
+        CTCPrefixBeamSearch whole(raw);
+        whole.advance(logits.data(), 200, vocab);
+        CTCPrefixBeamSearch pieces(raw);
+        for (size_t t = 0; t < 200; t += 7) {
+            pieces.advance(logits.data() + t * vocab, std::min<size_t>(7, 200 - t), vocab);
+        }
+        ok &= check("chunked input matches", whole.bestTokens() == pieces.bestTokens());
+
+        // Stable deltas per chunk plus the final remainder rebuild the best path
+        CTCPrefixBeamSearch streaming(raw);
+        std::vector<int> emitted;
+        for (size_t t = 0; t < 200; t += 25) {
+            streaming.advance(logits.data() + t * vocab, 25, vocab);
+            auto delta = streaming.stableTokens(emitted.size());
+            emitted.insert(emitted.end(), delta.begin(), delta.end());
+        }
+        const size_t stable = emitted.size();
+        auto best = streaming.bestTokens();
+        emitted.insert(emitted.end(), best.begin() + std::min(stable, best.size()), best.end());
+        ok &= check("stable deltas rebuild best path", stable > 0 && emitted == whole.bestTokens());
+
+        // Blank skipping above 0.5 keeps the best path on confident frames
+        CTCPrefixBeamSearch::Config skipping = raw;
+        skipping.blank_skip_threshold = 0.999f;
+        CTCPrefixBeamSearch skipped(skipping);
+        skipped.advance(logits.data(), 200, vocab);
+        ok &= check("blank skip keeps best path", skipped.bestTokens() == whole.bestTokens() &&
+                    skipped.framesSkipped() > 0);
+    }
+
+    // Cost per second of audio at beam 8
+    const int seconds = 600;
+    const size_t frames = static_cast<size_t>(seconds) * kFramesPerSecond;
+    auto long_logits = syntheticLogits(frames, vocab, 0, rng);
+    std::cout << std::fixed << std::setprecision(4);
+    for (bool log_probs : {false, true}) {
+        CTCPrefixBeamSearch::Config bench = config;
+        bench.inputs_are_log_probs = log_probs;
+        CTCPrefixBeamSearch search(bench);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < frames; t += kFramesPerSecond) {
+            search.advance(long_logits.data() + t * vocab, kFramesPerSecond, vocab);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        double per_second = ms / seconds;
+        std::cout << (log_probs ? "log-probs in" : "logits in   ") << ": " << per_second
+                  << " ms per second of audio (" << search.bestTokens().size() << " tokens, trie "
+                  << search.trieSize() << " nodes)" << std::endl;
+        ok &= check("beam 8 under 1 ms per second of audio", per_second < 1.0);
+    }
+
+    std::cout << (ok ? "✅ All CTC beam search checks passed" : "❌ CTC beam search checks failed") << std::endl;
+    return ok ? 0 : 1;
+}
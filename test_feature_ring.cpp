@@ -0,0 +1,123 @@
+#include "impl/include/FeatureRing.hpp"
+#include <iostream>
+#include <vector>
+
+// Chunking of the cache-aware encoders' feature ring: windows advance by a
+// subsampling-aligned step, carry the pre-encode context, keep remainders for
+// the next push and pad only at end of stream. Frame f carries the value f in
+// every bin so each window's frames can be traced back to the input.
+
+using onnx_stt::FeatureRing;
+using onnx_stt::FeatureView;
+
+static const size_t kBins = 4;
+static const size_t kContext = 9;   // 8x subsampling + 1
+static const size_t kStep = 144;
+static const size_t kFactor = 8;
+static const float kPad = -1.0f;
+
+static std::vector<float> makeFrames(size_t begin, size_t count) {
+    std::vector<float> frames(count * kBins);
+    for (size_t f = 0; f < count; ++f) {
+        for (size_t b = 0; b < kBins; ++b) {
+            frames[f * kBins + b] = static_cast<float>(begin + f);
+        }
+    }
+    return frames;
+}
+
+// Feed total frames in pushes of the given size; returns the first frame value of every window
+static std::vector<std::vector<float>> stream(size_t total, size_t push_size, size_t& final_padded,
+                                              const std::vector<size_t>& ramp = {}) {
+    FeatureRing ring(kBins, kContext, kStep, kFactor, kPad);
+    ring.setRamp(ramp);
+    std::vector<std::vector<float>> windows;
+    std::vector<float> window(ring.windowFrames() * kBins);
+    for (size_t offset = 0; offset < total; offset += push_size) {
+        size_t count = std::min(push_size, total - offset);
+        std::vector<float> frames = makeFrames(offset, count);
+        ring.push(FeatureView(frames.data(), count, kBins));
+        while (ring.ready()) {
+            size_t n = ring.pop(window.data());
+            std::vector<float> firsts;
+            for (size_t f = 0; f < n; ++f) firsts.push_back(window[f * kBins]);
+            windows.push_back(firsts);
+        }
+    }
+    size_t n = ring.popFinal(window.data());
+    final_padded = ring.paddedFrames();
+    if (n > 0) {
+        std::vector<float> firsts;
+        for (size_t f = 0; f < n; ++f) firsts.push_back(window[f * kBins]);
+        windows.push_back(firsts);
+    }
+    return windows;
+}
+
+int main() {
+    std::cout << "=== Feature ring chunking test ===" << std::endl;
+    bool ok = true;
+
+    const size_t total = 1000;
+    size_t padded = 0;
+    auto reference = stream(total, total, padded);
+
+    // 1000 frames: 6 full steps (864) and a final window of 136 frames
+    bool shape_ok = reference.size() == 7 && padded == 0;
+    for (size_t w = 0; w + 1 < reference.size() && shape_ok; ++w) {
+        const auto& window = reference[w];
+        shape_ok = window.size() == kContext + kStep;
+        for (size_t f = 0; f < window.size() && shape_ok; ++f) {
+            float expected = static_cast<float>(w * kStep + f) - static_cast<float>(kContext);
+            shape_ok = window[f] == (expected < 0 ? kPad : expected);
+        }
+    }
+    std::cout << (shape_ok ? "✅" : "❌") << " full windows advance by " << kStep
+              << " frames after " << kContext << " context frames" << std::endl;
+    ok &= shape_ok;
+
+    // Final window: context + remainder rounded up to the subsampling factor
+    const auto& last = reference.back();
+    bool final_ok = last.size() == kContext + 136 && last[kContext] == 864.0f && last.back() == 999.0f;
+    std::cout << (final_ok ? "✅" : "❌") << " final window holds the remainder ("
+              << last.size() - kContext << " frames)" << std::endl;
+    ok &= final_ok;
+
+    size_t odd_padded = 0;
+    auto odd = stream(1003, 1003, odd_padded);
+    bool pad_ok = odd.back().size() == kContext + 144 && odd_padded == 5 && odd.back().back() == kPad;
+    std::cout << (pad_ok ? "✅" : "❌") << " only the final window is padded (" << odd_padded
+              << " frames to the next multiple of " << kFactor << ")" << std::endl;
+    ok &= pad_ok;
+
+    // Any push size yields the same windows
+    bool sizes_ok = true;
+    for (size_t push_size : {1u, 7u, 80u, 153u, 160u, 512u}) {
+        size_t p = 0;
+        sizes_ok &= stream(total, push_size, p) == reference && p == padded;
+    }
+    std::cout << (sizes_ok ? "✅" : "❌") << " windows independent of push size" << std::endl;
+    ok &= sizes_ok;
+
+    // Ramp: shorter first windows, each still starting with the previous context
+    const std::vector<size_t> ramp = {32, 56, 88, 112};
+    size_t ramp_padded = 0;
+    auto ramped = stream(total, 10, ramp_padded, ramp);
+    bool ramp_ok = ramped.size() >= ramp.size() + 1;
+    size_t next_frame = 0;
+    for (size_t w = 0; w < ramped.size() && ramp_ok; ++w) {
+        size_t step = w < ramp.size() ? ramp[w] : kStep;
+        bool last_window = w + 1 == ramped.size();
+        ramp_ok = last_window ? ramped[w].size() <= kContext + step : ramped[w].size() == kContext + step;
+        ramp_ok = ramp_ok && ramped[w][kContext] == static_cast<float>(next_frame);
+        ramp_ok = ramp_ok && (next_frame == 0 ? ramped[w][kContext - 1] == kPad
+                                              : ramped[w][kContext - 1] == static_cast<float>(next_frame - 1));
+        next_frame += step;
+    }
+    std::cout << (ramp_ok ? "✅" : "❌") << " first window after " << ramp.front()
+              << " frames, ramping to " << kStep << std::endl;
+    ok &= ramp_ok;
+
+    std::cout << (ok ? "✅ All feature ring tests passed" : "❌ Feature ring tests failed") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+#include "impl/include/ProvenNeMoSTT.hpp"
+#include "test_audio_util.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// FP32 vs INT8 encoder on the test_data/audio clips: real-time factor of each,
+// and word error rate against <clip>.txt references where present. INT8 output
+// is also scored against the FP32 transcript, which isolates the quantization
+// error from the model's own errors.
+//
+// Create the INT8 encoder first: python quantize_encoder.py <encoder>.onnx
+
+static std::vector<std::string> splitWords(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream stream(text);
+    std::string word;
+    while (stream >> word) {
+        std::string clean;
+        for (char c : word) {
+            if (std::isalnum(static_cast<unsigned char>(c)) || c == '\'') {
+                clean += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+        }
+        if (!clean.empty()) {
+            words.push_back(clean);
+        }
+    }
+    return words;
+}
+
+// Word-level edit distance over the reference length
+static double wordErrorRate(const std::string& reference, const std::string& hypothesis) {
+    auto ref = splitWords(reference);
+    auto hyp = splitWords(hypothesis);
+    if (ref.empty()) {
+        return hyp.empty() ? 0.0 : 1.0;
+    }
+    std::vector<size_t> prev(hyp.size() + 1), curr(hyp.size() + 1);
+    for (size_t j = 0; j <= hyp.size(); ++j) {
+        prev[j] = j;
+    }
+    for (size_t i = 1; i <= ref.size(); ++i) {
+        curr[0] = i;
+        for (size_t j = 1; j <= hyp.size(); ++j) {
+            size_t substitute = prev[j - 1] + (ref[i - 1] == hyp[j - 1] ? 0 : 1);
+            curr[j] = std::min({substitute, prev[j] + 1, curr[j - 1] + 1});
+        }
+        std::swap(prev, curr);
+    }
+    return static_cast<double>(prev[hyp.size()]) / ref.size();
+}
+
+static std::string readReference(const std::string& wav_path) {
+    std::string path = wav_path.substr(0, wav_path.size() - 4) + ".txt";
+    std::ifstream file(path);
+    std::string text, line;
+    while (std::getline(file, line)) {
+        text += line + " ";
+    }
+    return text;
+}
+
+struct Run {
+    std::string transcript;
+    double seconds = 0.0;
+};
+
+static Run timeTranscribe(ProvenNeMoSTT& stt, const std::vector<float>& audio, int repeats) {
+    Run run;
+    for (int i = 0; i < repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run.transcript = stt.transcribe(audio, 16000);
+        run.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    run.seconds /= repeats;
+    return run;
+}
+
+int main(int argc, char* argv[]) {
+    const std::string model_dir = argc > 1 ? argv[1] : "models/proven_onnx_export";
+    const int repeats = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+    const std::string encoder_path = model_dir + "/encoder-proven_fastconformer.onnx";
+    const std::string decoder_path = model_dir + "/decoder_joint-proven_fastconformer.onnx";
+    const std::string vocab_path = model_dir + "/vocabulary.txt";
+    const std::vector<std::string> clips = {
+        "test_data/audio/librispeech-1995-1837-0001.wav",
+        "test_data/audio/test_16k.wav",
+        "test_data/audio/11-ibm-culture-2min.wav",
+    };
+
+    std::cout << "=== INT8 encoder benchmark (" << repeats << " runs per clip) ===" << std::endl;
+
+    const std::string int8_path = onnx_stt::OrtRuntime::quantizedModelPath(encoder_path);
+    if (!std::ifstream(int8_path).good()) {
+        std::cerr << "❌ INT8 encoder not found: " << int8_path << std::endl;
+        std::cerr << "   Create it with: python quantize_encoder.py " << encoder_path << std::endl;
+        return 1;
+    }
+
+    ProvenNeMoSTT fp32;
+    ProvenNeMoSTT int8;
+    int8.setQuantizedEncoder(true);
+    if (!fp32.initialize(encoder_path, decoder_path, vocab_path) ||
+        !int8.initialize(encoder_path, decoder_path, vocab_path)) {
+        std::cerr << "❌ Failed to initialize models from " << model_dir << std::endl;
+        return 1;
+    }
+    fp32.warmUp(1000);
+    int8.warmUp(1000);
+
+    double audio_total = 0.0, fp32_total = 0.0, int8_total = 0.0;
+    double fp32_errors = 0.0, int8_errors = 0.0, drift_errors = 0.0;
+    size_t scored = 0, compared = 0;
+
+    std::cout << std::fixed << std::setprecision(3);
+    for (const auto& clip : clips) {
+        std::vector<float> audio;
+        if (!loadMono16k(clip, audio)) {
+            continue;
+        }
+        double duration = audio.size() / 16000.0;
+        Run a = timeTranscribe(fp32, audio, repeats);
+        Run b = timeTranscribe(int8, audio, repeats);
+        audio_total += duration;
+        fp32_total += a.seconds;
+        int8_total += b.seconds;
+
+        // INT8 vs FP32 transcript, weighted by length
+        double drift = wordErrorRate(a.transcript, b.transcript);
+        drift_errors += drift * duration;
+        ++compared;
+
+        std::cout << clip << " (" << duration << " s)" << std::endl;
+        std::cout << "  RTF fp32=" << a.seconds / duration << " int8=" << b.seconds / duration
+                  << " speedup=" << a.seconds / b.seconds << "x" << std::endl;
+        std::cout << "  WER int8 vs fp32=" << drift << std::endl;
+
+        std::string reference = readReference(clip);
+        if (!splitWords(reference).empty()) {
+            double wer_a = wordErrorRate(reference, a.transcript);
+            double wer_b = wordErrorRate(reference, b.transcript);
+            size_t words = splitWords(reference).size();
+            fp32_errors += wer_a * words;
+            int8_errors += wer_b * words;
+            scored += words;
+            std::cout << "  WER vs reference fp32=" << wer_a << " int8=" << wer_b
+                      << " delta=" << wer_b - wer_a << std::endl;
+        }
+    }
+
+    if (compared == 0) {
+        std::cerr << "❌ No 16 kHz clips found under test_data/audio" << std::endl;
+        return 1;
+    }
+
+    std::cout << "\n=== SUMMARY ===" << std::endl;
+    std::cout << "Audio: " << audio_total << " s in " << compared << " clips" << std::endl;
+    std::cout << "RTF fp32=" << fp32_total / audio_total << " int8=" << int8_total / audio_total
+              << " speedup=" << fp32_total / int8_total << "x" << std::endl;
+    std::cout << "WER int8 vs fp32=" << drift_errors / audio_total << std::endl;
+    if (scored > 0) {
+        std::cout << "WER vs reference fp32=" << fp32_errors / scored << " int8=" << int8_errors / scored
+                  << " delta=" << (int8_errors - fp32_errors) / scored << " (" << scored << " words)" << std::endl;
+    }
+
+    std::cout << "✅ Benchmark complete" << std::endl;
+    return 0;
+}
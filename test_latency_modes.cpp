@@ -0,0 +1,144 @@
+#include "impl/include/NeMoCacheAwareStreaming.hpp"
+#include "test_audio_util.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Latency and RTF of the cache-aware FastConformer in each latency mode on the
+// test_data/audio clips. Audio is fed one chunk at a time, as a live stream
+// would arrive; the expected latency of a word is the chunk it lands in plus
+// the time to encode that chunk.
+//
+// Needs the per-lookahead exports from export_nemo_cache_aware_onnx.py; modes
+// whose export is missing are skipped.
+
+using onnx_stt::NeMoCacheAwareStreaming;
+
+struct ModeResult {
+    double lookahead_ms = 0.0;
+    double chunk_ms = 0.0;
+    double audio_ms = 0.0;
+    double compute_ms = 0.0;
+    double max_chunk_ms = 0.0;
+    size_t chunks = 0;
+};
+
+// Stream one clip chunk by chunk, timing each call
+static std::string streamClip(NeMoCacheAwareStreaming& model, const std::vector<float>& audio, ModeResult& result) {
+    model.reset();
+    const size_t chunk_samples = static_cast<size_t>(model.getChunkFrames()) * 160;
+    std::string transcript;
+    for (size_t offset = 0; offset < audio.size(); offset += chunk_samples) {
+        const size_t count = std::min(chunk_samples, audio.size() - offset);
+        const bool is_final = offset + count >= audio.size();
+        auto start = std::chrono::steady_clock::now();
+        transcript += model.processAudioChunk(audio.data() + offset, static_cast<int>(count), is_final);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.compute_ms += ms;
+        result.max_chunk_ms = std::max(result.max_chunk_ms, ms);
+        ++result.chunks;
+    }
+    result.audio_ms += audio.size() / 16.0;
+    return transcript;
+}
+
+int main(int argc, char* argv[]) {
+    const std::string model_dir = argc > 1 ? argv[1] : "models/nemo_cache_aware_onnx";
+    const std::vector<std::string> clips = {
+        "test_data/audio/librispeech-1995-1837-0001.wav",
+        "test_data/audio/test_16k.wav",
+        "test_data/audio/11-ibm-culture-2min.wav",
+    };
+    const std::vector<NeMoCacheAwareStreaming::LatencyMode> modes = {
+        NeMoCacheAwareStreaming::LatencyMode::ULTRA_LOW,
+        NeMoCacheAwareStreaming::LatencyMode::VERY_LOW,
+        NeMoCacheAwareStreaming::LatencyMode::LOW,
+        NeMoCacheAwareStreaming::LatencyMode::MEDIUM,
+    };
+
+    std::cout << "=== Cache-aware FastConformer latency modes ===" << std::endl;
+
+    // Every chunk, the first included, must give R + 1 encoder frames
+    for (auto mode : modes) {
+        const int lookahead = NeMoCacheAwareStreaming::lookaheadFrames(mode);
+        const int frames = NeMoCacheAwareStreaming::encoderFramesPerChunk(mode);
+        if (frames != lookahead + 1) {
+            std::cerr << "❌ [70," << lookahead << "] chunks of " << NeMoCacheAwareStreaming::chunkFrames(mode)
+                      << " mel frames give " << frames << " encoder frames, expected " << lookahead + 1 << std::endl;
+            return 1;
+        }
+        std::cout << "✅ [70," << lookahead << "] chunk gives " << frames << " encoder frames" << std::endl;
+    }
+
+    std::vector<std::vector<float>> audio;
+    for (const auto& clip : clips) {
+        std::vector<float> samples;
+        if (loadMono16k(clip, samples)) {
+            audio.push_back(std::move(samples));
+        }
+    }
+    if (audio.empty()) {
+        std::cerr << "❌ No 16 kHz clips found under test_data/audio" << std::endl;
+        return 1;
+    }
+
+    // One instance for all modes: setLatencyMode switches exports in place
+    NeMoCacheAwareStreaming model(model_dir, modes.front());
+    onnx_stt::ModelInterface::ModelConfig config;
+    config.vocab_path = model_dir + "/vocab.txt";
+    if (!model.initialize(config)) {
+        std::cerr << "❌ Failed to initialize from " << model_dir << std::endl;
+        return 1;
+    }
+
+    std::vector<ModeResult> results;
+    for (auto mode : modes) {
+        if (!model.setLatencyMode(mode)) {
+            std::cout << "⚠️ No export for " << NeMoCacheAwareStreaming::encoderFileName(mode) << ", skipping" << std::endl;
+            continue;
+        }
+        ModeResult warm_up;
+        streamClip(model, audio.front(), warm_up);  // first-run kernel setup, not counted
+
+        ModeResult result;
+        result.lookahead_ms = NeMoCacheAwareStreaming::lookaheadFrames(mode) * 80.0;
+        result.chunk_ms = model.getChunkFrames() * 10.0;
+        for (size_t i = 0; i < audio.size(); ++i) {
+            std::string transcript = streamClip(model, audio[i], result);
+            std::cout << "[" << result.lookahead_ms << " ms] " << clips[i] << ": " << transcript << std::endl;
+        }
+        results.push_back(result);
+    }
+
+    // Switch mode on every chunk of one clip: the shared caches must carry over
+    {
+        model.reset();
+        std::string transcript;
+        size_t offset = 0;
+        for (size_t i = 0; offset < audio.front().size(); ++i) {
+            model.setLatencyMode(modes[i % modes.size()]);
+            const size_t count = std::min(static_cast<size_t>(model.getChunkFrames()) * 160, audio.front().size() - offset);
+            transcript += model.processAudioChunk(audio.front().data() + offset, static_cast<int>(count),
+                                                  offset + count >= audio.front().size());
+            offset += count;
+        }
+        std::cout << "[switching] " << clips.front() << ": " << transcript << std::endl;
+    }
+
+    std::cout << "\n=== SUMMARY ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "lookahead ms | chunk ms | mean chunk compute ms | max ms | expected latency ms | RTF" << std::endl;
+    for (const auto& r : results) {
+        double mean = r.chunks > 0 ? r.compute_ms / r.chunks : 0.0;
+        std::cout << std::setw(12) << r.lookahead_ms << " | " << std::setw(8) << r.chunk_ms << " | "
+                  << std::setw(21) << mean << " | " << std::setw(6) << r.max_chunk_ms << " | "
+                  << std::setw(19) << r.chunk_ms + mean << " | " << std::setprecision(3)
+                  << (r.audio_ms > 0 ? r.compute_ms / r.audio_ms : 0.0) << std::setprecision(1) << std::endl;
+    }
+
+    std::cout << (results.empty() ? "❌ No latency mode could be run" : "✅ Benchmark complete") << std::endl;
+    return results.empty() ? 1 : 0;
+}
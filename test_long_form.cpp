@@ -0,0 +1,161 @@
+#include "impl/include/ProvenNeMoSTT.hpp"
+#include "test_audio_util.hpp"
+#include <sndfile.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Peak RSS and RTF against file length, single encoder pass vs long-form
+// segments. Files of 2 to max_minutes minutes are built by repeating the
+// 2-minute test_data/audio clip and transcribed from disk, so the long-form
+// run never holds more than one segment of audio.
+//
+// The peak is reset between runs through /proc/self/clear_refs (Linux 4.0+);
+// where that fails each figure is the process peak so far.
+
+// Write the clip repeated until the file is minutes long
+static bool writeTiled(const std::string& path, const std::vector<float>& clip, int minutes) {
+    SF_INFO info;
+    std::memset(&info, 0, sizeof(info));
+    info.samplerate = 16000;
+    info.channels = 1;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+    SNDFILE* file = sf_open(path.c_str(), SFM_WRITE, &info);
+    if (!file) {
+        return false;
+    }
+    size_t remaining = static_cast<size_t>(minutes) * 60 * 16000;
+    while (remaining > 0) {
+        size_t count = std::min(remaining, clip.size());
+        sf_writef_float(file, clip.data(), static_cast<sf_count_t>(count));
+        remaining -= count;
+    }
+    sf_close(file);
+    return true;
+}
+
+static bool resetPeakRss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    return static_cast<bool>(clear_refs);
+}
+
+// VmHWM from /proc/self/status, in MB
+static double peakRssMb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            std::istringstream fields(line.substr(6));
+            double kb = 0.0;
+            fields >> kb;
+            return kb / 1024.0;
+        }
+    }
+    return 0.0;
+}
+
+static size_t countWords(const std::string& text) {
+    std::istringstream words(text);
+    std::string word;
+    size_t count = 0;
+    while (words >> word) {
+        ++count;
+    }
+    return count;
+}
+
+struct Run {
+    std::string transcript;
+    double peak_mb = 0.0;
+    double rtf = 0.0;
+    double segments = 0.0;
+};
+
+static Run measure(ProvenNeMoSTT& stt, const std::string& path, int minutes) {
+    auto before = stt.getStats();
+    resetPeakRss();
+    auto start = std::chrono::steady_clock::now();
+    Run run;
+    run.transcript = stt.transcribe(path);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run.peak_mb = peakRssMb();
+    run.rtf = seconds / (minutes * 60.0);
+    run.segments = stt.getStats()["long_form_segments"] - before["long_form_segments"];
+    return run;
+}
+
+int main(int argc, char* argv[]) {
+    const std::string model_dir = argc > 1 ? argv[1] : "models/proven_onnx_export";
+    const int max_minutes = argc > 2 ? std::atoi(argv[2]) : 60;
+    const int single_pass_minutes = argc > 3 ? std::atoi(argv[3]) : 10;
+    const int segment_ms = 30000;
+    const int overlap_ms = 4000;
+    const std::string encoder_path = model_dir + "/encoder-proven_fastconformer.onnx";
+    const std::string decoder_path = model_dir + "/decoder_joint-proven_fastconformer.onnx";
+    const std::string vocab_path = model_dir + "/vocabulary.txt";
+
+    std::cout << "=== Long-form benchmark (" << segment_ms / 1000 << " s segments, "
+              << overlap_ms / 1000 << " s overlap) ===" << std::endl;
+
+    std::vector<float> clip;
+    if (!loadMono16k("test_data/audio/11-ibm-culture-2min.wav", clip)) {
+        std::cerr << "❌ test_data/audio/11-ibm-culture-2min.wav not found" << std::endl;
+        return 1;
+    }
+
+    ProvenNeMoSTT single;
+    ProvenNeMoSTT segmented;
+    segmented.setLongForm(segment_ms, overlap_ms);
+    if (!single.initialize(encoder_path, decoder_path, vocab_path) ||
+        !segmented.initialize(encoder_path, decoder_path, vocab_path)) {
+        std::cerr << "❌ Failed to initialize models from " << model_dir << std::endl;
+        return 1;
+    }
+    single.warmUp(1000);
+    segmented.warmUp(1000);
+    if (!resetPeakRss()) {
+        std::cout << "⚠️ Cannot reset peak RSS; figures are cumulative" << std::endl;
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "minutes | mode        | peak RSS MB | RTF   | segments | words" << std::endl;
+    bool ok = true;
+    for (int minutes : {2, 10, 30, 60, 120}) {
+        if (minutes > max_minutes) {
+            break;
+        }
+        const std::string path = "long_form_" + std::to_string(minutes) + "min.wav";
+        if (!writeTiled(path, clip, minutes)) {
+            std::cerr << "❌ Cannot write " << path << std::endl;
+            return 1;
+        }
+
+        Run long_form = measure(segmented, path, minutes);
+        std::cout << std::setw(7) << minutes << " | long-form   | " << std::setw(11) << long_form.peak_mb
+                  << " | " << long_form.rtf << " | " << std::setw(8) << long_form.segments << " | "
+                  << countWords(long_form.transcript) << std::endl;
+        ok &= long_form.transcript.compare(0, 6, "Error:") != 0;
+
+        if (minutes <= single_pass_minutes) {
+            Run one_pass = measure(single, path, minutes);
+            std::cout << std::setw(7) << minutes << " | single pass | " << std::setw(11) << one_pass.peak_mb
+                      << " | " << one_pass.rtf << " | " << std::setw(8) << 1 << " | "
+                      << countWords(one_pass.transcript) << std::endl;
+            std::cout << "        transcripts "
+                      << (one_pass.transcript == long_form.transcript ? "identical" : "differ") << std::endl;
+        }
+        std::remove(path.c_str());
+    }
+
+    std::cout << (ok ? "✅ Benchmark complete" : "❌ Long-form transcription failed") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include "impl/include/RealFFT.hpp"
+
+// Parity and throughput test for the shared RealFFT used by the feature extractors.
+// Build with: make test-real-fft
+
+std::vector<float> loadBinaryFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+
+    file.seekg(0, std::ios::end);
+    size_t file_size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    std::vector<float> data(file_size / sizeof(float));
+    file.read(reinterpret_cast<char*>(data.data()), data.size() * sizeof(float));
+    return data;
+}
+
+// Minimal .npy reader for 2-D little-endian float32/float64 arrays.
+// Returns data in row-major [rows][cols] regardless of fortran_order.
+std::vector<double> loadNpy(const std::string& filename, int& rows, int& cols) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+
+    char magic[8];
+    file.read(magic, 8);
+    uint16_t header_len = 0;
+    file.read(reinterpret_cast<char*>(&header_len), 2);
+    std::string header(header_len, ' ');
+    file.read(&header[0], header_len);
+
+    bool is_f8 = header.find("'<f8'") != std::string::npos;
+    bool is_f4 = header.find("'<f4'") != std::string::npos;
+    bool fortran = header.find("'fortran_order': True") != std::string::npos;
+    if (!is_f8 && !is_f4) {
+        throw std::runtime_error("Unsupported dtype in " + filename);
+    }
+
+    size_t shape_pos = header.find('(');
+    if (sscanf(header.c_str() + shape_pos, "(%d, %d)", &rows, &cols) != 2) {
+        throw std::runtime_error("Unsupported shape in " + filename);
+    }
+
+    size_t count = static_cast<size_t>(rows) * cols;
+    std::vector<double> raw(count);
+    if (is_f8) {
+        file.read(reinterpret_cast<char*>(raw.data()), count * sizeof(double));
+    } else {
+        std::vector<float> tmp(count);
+        file.read(reinterpret_cast<char*>(tmp.data()), count * sizeof(float));
+        std::copy(tmp.begin(), tmp.end(), raw.begin());
+    }
+
+    if (!fortran) {
+        return raw;
+    }
+    std::vector<double> data(count);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            data[static_cast<size_t>(r) * cols + c] = raw[static_cast<size_t>(c) * rows + r];
+        }
+    }
+    return data;
+}
+
+// The DFT the extractors used before RealFFT (kept here as the baseline)
+std::vector<float> naiveDFT(const std::vector<float>& frame) {
+    int n_fft = frame.size();
+    std::vector<float> power_spectrum(n_fft / 2 + 1);
+    for (int k = 0; k <= n_fft / 2; k++) {
+        float real = 0.0f, imag = 0.0f;
+        for (int n = 0; n < n_fft; n++) {
+            float angle = -2.0f * M_PI * k * n / n_fft;
+            real += frame[n] * cos(angle);
+            imag += frame[n] * sin(angle);
+        }
+        power_spectrum[k] = real * real + imag * imag;
+    }
+    return power_spectrum;
+}
+
+// Double precision reference DFT
+std::vector<double> referenceDFT(const std::vector<float>& frame) {
+    int n_fft = frame.size();
+    std::vector<double> power_spectrum(n_fft / 2 + 1);
+    for (int k = 0; k <= n_fft / 2; k++) {
+        double real = 0.0, imag = 0.0;
+        for (int n = 0; n < n_fft; n++) {
+            double angle = -2.0 * M_PI * (static_cast<long>(k) * n % n_fft) / n_fft;
+            real += frame[n] * std::cos(angle);
+            imag += frame[n] * std::sin(angle);
+        }
+        power_spectrum[k] = real * real + imag * imag;
+    }
+    return power_spectrum;
+}
+
+// Max error relative to the frame's peak bin
+double relativeError(const std::vector<float>& got, const std::vector<double>& ref) {
+    double peak = 0.0, err = 0.0;
+    for (size_t i = 0; i < ref.size(); i++) {
+        peak = std::max(peak, std::abs(ref[i]));
+        err = std::max(err, std::abs(got[i] - ref[i]));
+    }
+    return peak > 0.0 ? err / peak : err;
+}
+
+// Centered (librosa center=True, pad_mode='constant') STFT power spectrum using RealFFT
+std::vector<std::vector<float>> stftPower(const std::vector<float>& audio,
+                                          const std::vector<float>& window,
+                                          int n_fft, int hop) {
+    int pad = n_fft / 2;
+    std::vector<float> padded(audio.size() + 2 * pad, 0.0f);
+    std::copy(audio.begin(), audio.end(), padded.begin() + pad);
+
+    auto fft = onnx_stt::RealFFT::get(n_fft);
+    int win_length = window.size();
+    int offset = (n_fft - win_length) / 2;
+    int num_frames = 1 + (static_cast<int>(padded.size()) - n_fft) / hop;
+
+    std::vector<std::vector<float>> result(num_frames, std::vector<float>(fft->numBins()));
+    std::vector<float> frame(n_fft);
+    for (int t = 0; t < num_frames; t++) {
+        std::fill(frame.begin(), frame.end(), 0.0f);
+        for (int i = 0; i < win_length; i++) {
+            frame[offset + i] = padded[t * hop + offset + i] * window[i];
+        }
+        fft->powerSpectrum(frame.data(), result[t].data());
+    }
+    return result;
+}
+
+double compareSTFT(const std::vector<std::vector<float>>& ours,
+                   const std::vector<double>& ref, int bins, int frames) {
+    double peak = 0.0, err = 0.0;
+    int num_frames = std::min(frames, static_cast<int>(ours.size()));
+    for (int t = 0; t < num_frames; t++) {
+        for (int k = 0; k < bins; k++) {
+            double r = ref[static_cast<size_t>(k) * frames + t];
+            peak = std::max(peak, std::abs(r));
+            err = std::max(err, std::abs(ours[t][k] - r));
+        }
+    }
+    return err / peak;
+}
+
+int main() {
+    std::cout << "=== RealFFT Parity and Throughput Test ===" << std::endl;
+    bool ok = true;
+
+    // 1. Exactness against a double precision DFT on random frames of several sizes
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (int n_fft : {8, 64, 256, 512, 1024}) {
+        double worst = 0.0;
+        for (int trial = 0; trial < 20; trial++) {
+            std::vector<float> frame(n_fft);
+            for (float& v : frame) v = dist(gen);
+            auto got = onnx_stt::RealFFT::get(n_fft)->powerSpectrum(frame);
+            worst = std::max(worst, relativeError(got, referenceDFT(frame)));
+        }
+        bool pass = worst < 1e-5;
+        ok = ok && pass;
+        std::cout << (pass ? "✅" : "❌") << " n_fft=" << n_fft
+                  << " max relative error vs double DFT: " << worst << std::endl;
+    }
+
+    // 2. Single frame reference (test_signal.bin -> test_power_spectrum.bin)
+    try {
+        auto signal = loadBinaryFile("reference_data/test_signal.bin");
+        auto expected = loadBinaryFile("reference_data/test_power_spectrum.bin");
+        auto got = onnx_stt::RealFFT::get(signal.size())->powerSpectrum(signal);
+        std::vector<double> ref(expected.begin(), expected.end());
+        double err = relativeError(got, ref);
+        bool pass = err < 1e-4;
+        ok = ok && pass;
+        std::cout << (pass ? "✅" : "❌") << " test_signal.bin max relative error: " << err << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "⚠️  Skipping single frame reference: " << e.what() << std::endl;
+    }
+
+    // 3. Full STFT parity against librosa's power spectrum of audio_raw.bin.
+    // librosa uses a periodic Hann window (fftbins=True); hann_window_400.bin holds the
+    // symmetric variant, so the window is generated here instead of loaded.
+    try {
+        auto audio = loadBinaryFile("reference_data/audio_raw.bin");
+        const int win_length = 400;
+        std::vector<float> window(win_length);
+        for (int i = 0; i < win_length; i++) {
+            window[i] = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / win_length);
+        }
+        auto ours = stftPower(audio, window, 512, 160);
+
+        for (const char* reference : {"reference_data/power_spectrum.npy", "librosa_power_spectrum.npy"}) {
+            int bins = 0, frames = 0;
+            auto ref = loadNpy(reference, bins, frames);
+            double err = compareSTFT(ours, ref, bins, frames);
+            bool pass = err < 1e-4;
+            ok = ok && pass;
+            std::cout << (pass ? "✅" : "❌") << " " << reference << " [" << bins << " x " << frames
+                      << "] max error relative to peak: " << err << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "⚠️  Skipping librosa reference: " << e.what() << std::endl;
+    }
+
+    // 4. Throughput: old per-extractor DFT vs shared RealFFT plan
+    const int n_fft = 512;
+    std::vector<float> frame(n_fft);
+    for (float& v : frame) v = dist(gen);
+    auto fft = onnx_stt::RealFFT::get(n_fft);
+    std::vector<float> power(fft->numBins());
+    volatile float sink = 0.0f;
+
+    const int dft_frames = 200;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < dft_frames; i++) {
+        sink = sink + naiveDFT(frame)[1];
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    const int fft_frames = 200000;
+    for (int i = 0; i < fft_frames; i++) {
+        fft->powerSpectrum(frame.data(), power.data());
+        sink = sink + power[1];
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    double dft_fps = dft_frames / std::chrono::duration<double>(t1 - t0).count();
+    double fft_fps = fft_frames / std::chrono::duration<double>(t2 - t1).count();
+    std::cout << "Naive DFT: " << static_cast<long>(dft_fps) << " frames/sec" << std::endl;
+    std::cout << "RealFFT:   " << static_cast<long>(fft_fps) << " frames/sec ("
+              << static_cast<long>(fft_fps / dft_fps) << "x)" << std::endl;
+
+    std::cout << (ok ? "✅ All RealFFT checks passed" : "❌ RealFFT checks failed") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+#include "impl/include/OrtRuntime.hpp"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Thread count and RSS of a process hosting 8 instances of the same model, as
+// 8 fused operators in one PE would. Run once per mode:
+//   private - each instance creates its own Env/session with its own pools (old behaviour)
+//   shared  - instances get their session from the OrtRuntime registry
+//   mapped  - as shared, with the model memory-mapped (pass an .ort model); run
+//             several copies at once and compare rss_anon, the private part
+
+using onnx_stt::OrtRuntime;
+
+static void printStats(const std::string& label) {
+    auto stats = OrtRuntime::getProcessStats();
+    std::cout << label << ": threads=" << stats["process_threads"]
+              << " rss=" << stats["process_rss_mb"] << " MiB"
+              << " peak_rss=" << stats["process_peak_rss_mb"] << " MiB"
+              << " rss_anon=" << stats["process_rss_anon_mb"] << " MiB"
+              << " rss_file=" << stats["process_rss_file_mb"] << " MiB" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const std::string mode = argc > 1 ? argv[1] : "shared";
+    const std::string model_path = argc > 2 ? argv[2] : "models/fastconformer_ctc_export/model.onnx";
+    const int instances = 8;
+    const int intra_op_threads = 4;
+
+    std::cout << "=== Shared session test (" << mode << ", " << instances << " instances) ===" << std::endl;
+    printStats("Before loading");
+
+    std::vector<std::unique_ptr<Ort::Env>> envs;
+    std::vector<std::shared_ptr<Ort::Session>> sessions;
+
+    try {
+        for (int i = 0; i < instances; ++i) {
+            if (mode == "private") {
+                envs.push_back(std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "private"));
+                Ort::SessionOptions options;
+                options.SetIntraOpNumThreads(intra_op_threads);
+                options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+                sessions.push_back(std::make_shared<Ort::Session>(*envs.back(), model_path.c_str(), options));
+            } else {
+                OrtRuntime::SessionConfig config;
+                config.intra_op_threads = intra_op_threads;
+                config.memory_map = (mode == "mapped");
+                sessions.push_back(OrtRuntime::instance().getSession(model_path, config));
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Failed to load model " << model_path << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    printStats("After loading");
+
+    if (mode != "private") {
+        auto stats = OrtRuntime::instance().getStats();
+        std::cout << "Sessions created: " << stats["sessions_created"]
+                  << ", reused: " << stats["sessions_reused"]
+                  << ", memory-mapped: " << stats["memory_mapped_mb"] << " MiB" << std::endl;
+        if (stats["sessions_created"] != 1) {
+            std::cerr << "❌ Expected one session for " << instances << " instances" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "✅ Loaded " << sessions.size() << " instances" << std::endl;
+    return 0;
+}